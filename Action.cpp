@@ -0,0 +1,234 @@
+#pragma once
+#include "Game.cpp"
+#include <cstdint>
+
+/*
+ * Seat-addressed actions.
+ * Hosts that don't hold Player pointers (servers, bots, replays) describe a move
+ * as an action id plus actor and target seat numbers, and run it through perform().
+ */
+
+enum class ActionType : uint8_t {
+    None = 0,
+    Gather,
+    Tax,
+    Bribe,
+    Arrest,
+    Sanction,
+    Coup,
+    BlockTax,
+    ViewCoins,
+    Invest,
+    Protect,
+    BlockBribe,
+    Bonus,
+    NextTurn,
+    Count
+};
+
+const uint8_t NO_TARGET = 0xFF;
+
+struct Action {
+    ActionType type;
+    uint8_t actor;
+    uint8_t target;
+};
+
+// An action on a table of any size: seats are indexes rather than a byte, and a target
+// of player_count() or more means none
+struct SeatAction {
+    ActionType type;
+    size_t actor;
+    size_t target;
+};
+
+const char* action_name(ActionType type) {
+    switch (type) {
+        case ActionType::Gather: return "gather";
+        case ActionType::Tax: return "tax";
+        case ActionType::Bribe: return "bribe";
+        case ActionType::Arrest: return "arrest";
+        case ActionType::Sanction: return "sanction";
+        case ActionType::Coup: return "coup";
+        case ActionType::BlockTax: return "block_tax";
+        case ActionType::ViewCoins: return "view_coins";
+        case ActionType::Invest: return "invest";
+        case ActionType::Protect: return "protect";
+        case ActionType::BlockBribe: return "block_bribe";
+        case ActionType::Bonus: return "bonus";
+        case ActionType::NextTurn: return "next";
+        default: return "none";
+    }
+}
+
+ActionType action_from_name(const std::string& name) {
+    for (uint8_t i = 1; i < static_cast<uint8_t>(ActionType::Count); i++) {
+        ActionType type = static_cast<ActionType>(i);
+        if (name == action_name(type)) {
+            return type;
+        }
+    }
+    return ActionType::None;
+}
+
+// True for actions that need a target seat
+bool action_has_target(ActionType type) {
+    switch (type) {
+        case ActionType::Arrest:
+        case ActionType::Sanction:
+        case ActionType::Coup:
+        case ActionType::BlockTax:
+        case ActionType::ViewCoins:
+        case ActionType::Protect:
+        case ActionType::BlockBribe:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Casts the actor to the role class required by a special ability
+template <typename Role>
+Role& require_role(Player& actor, const char* role) {
+    Role* player = dynamic_cast<Role*>(&actor);
+    if (!player) {
+        throw InvalidActionException(actor.get_name() + " is not a " + role);
+    }
+    return *player;
+}
+
+// Runs an action straight on the players, without checking whose turn it is or the
+// target, as scripted scenarios do; target may only be null for actions that take none.
+// Returns the coin count seen by view_coins, 0 for every other action.
+int apply_action(Game& game, ActionType type, Player& actor, Player* target) {
+    if (action_has_target(type) && !target) {
+        throw InvalidActionException("Invalid target player");
+    }
+    switch (type) {
+        case ActionType::Gather: actor.gather(); break;
+        case ActionType::Tax: actor.tax(); break;
+        case ActionType::Bribe: actor.bribe(); break;
+        case ActionType::Arrest: actor.arrest(*target); break;
+        case ActionType::Sanction: actor.sanction(*target); break;
+        case ActionType::Coup: actor.coup(*target); break;
+        case ActionType::BlockTax: require_role<Governor>(actor, "Governor").block_tax(*target); break;
+        case ActionType::ViewCoins: return require_role<Spy>(actor, "Spy").view_coins(*target);
+        case ActionType::Invest: require_role<Baron>(actor, "Baron").invest(); break;
+        case ActionType::Protect: require_role<General>(actor, "General").protect(*target); break;
+        case ActionType::BlockBribe: require_role<Judge>(actor, "Judge").block_bribe(*target); break;
+        case ActionType::Bonus: require_role<Merchant>(actor, "Merchant").bonus(); break;
+        case ActionType::NextTurn: game.next_turn(); break;
+        default:
+            throw InvalidActionException("Unknown action");
+    }
+    return 0;
+}
+
+// Runs an action for players given directly rather than by seat, as hosts of tables
+// too large for seat numbers do; target is ignored by actions that take none.
+// Returns the coin count seen by view_coins, 0 for every other action.
+int perform(Game& game, ActionType type, Player& actor, Player* target) {
+    if (game.is_game_over()) {
+        throw GameOverException("Game is already over");
+    }
+    if (&actor != game.get_current_player()) {
+        throw NotPlayerTurnException("It is not this player's turn");
+    }
+    if (action_has_target(type)) {
+        if (!target || target == &actor) {
+            throw InvalidActionException("Invalid target player");
+        }
+        if (target->is_eliminated()) {
+            throw InvalidActionException("Target player is eliminated");
+        }
+    }
+    return apply_action(game, type, actor, target);
+}
+
+// Runs an action on behalf of the current player.
+// Returns the coin count seen by view_coins, 0 for every other action.
+int perform(Game& game, const Action& action) {
+    if (game.is_game_over()) {
+        throw GameOverException("Game is already over");
+    }
+    if (action.actor != game.get_current_index()) {
+        throw NotPlayerTurnException("It is not this player's turn");
+    }
+    Player* target = action.target < game.player_count() ? game.get_player(action.target) : nullptr;
+    return perform(game, action.type, *game.get_player(action.actor), target);
+}
+
+// Role ids are indexes into ROLE_NAMES; the standard table seats them in this order
+const char* const ROLE_NAMES[] = {"Governor", "Spy", "Baron", "General", "Judge", "Merchant"};
+const char* const STANDARD_NAMES[] = {"Alice", "Bob", "Charlie", "Diana", "Ethan", "Fiona"};
+const uint8_t ROLE_COUNT = 6;
+const uint8_t NO_ROLE = 0xFF;
+
+uint8_t role_id(const std::string& role) {
+    for (uint8_t i = 0; i < ROLE_COUNT; i++) {
+        if (role == ROLE_NAMES[i]) {
+            return i;
+        }
+    }
+    return NO_ROLE;
+}
+
+// The special ability a role offers, or None
+ActionType special_action(const std::string& role) {
+    if (role == "Governor") return ActionType::BlockTax;
+    if (role == "Spy") return ActionType::ViewCoins;
+    if (role == "Baron") return ActionType::Invest;
+    if (role == "General") return ActionType::Protect;
+    if (role == "Judge") return ActionType::BlockBribe;
+    if (role == "Merchant") return ActionType::Bonus;
+    return ActionType::None;
+}
+
+// Seat of the named player, or NO_TARGET
+uint8_t seat_of(const Game& game, const std::string& name) {
+    for (size_t i = 0; i < game.player_count(); i++) {
+        if (game.get_player(i)->get_name() == name) {
+            return static_cast<uint8_t>(i);
+        }
+    }
+    return NO_TARGET;
+}
+
+// Name given to a seat at a standard table
+std::string standard_name(size_t seat) {
+    return seat < 6 ? STANDARD_NAMES[seat] : "Player" + std::to_string(seat + 1);
+}
+
+// Seats the six standard roles used by the demo and the GUIs
+void seat_standard_players(Game& game) {
+    for (uint8_t i = 0; i < ROLE_COUNT; i++) {
+        game.add_player(make_role_player(ROLE_NAMES[i], standard_name(i), &game));
+    }
+}
+
+// Scripted player used by benchmarks and simulations. Coups the next live opponent
+// once it has 7+ coins, otherwise gathers (even roll) or taxes (odd roll); end_turn
+// asks it to pass the turn instead.
+SeatAction bot_move(const Game& game, bool end_turn, uint32_t roll = 0) {
+    size_t seat = game.get_current_index();
+    size_t none = game.player_count();
+    if (end_turn) {
+        return SeatAction{ActionType::NextTurn, seat, none};
+    }
+    if (game.get_player(seat)->get_coins() >= STANDARD_RULES.coup_cost) {
+        for (size_t i = 1; i < game.player_count(); i++) {
+            size_t target = (seat + i) % game.player_count();
+            if (!game.get_player(target)->is_eliminated()) {
+                return SeatAction{ActionType::Coup, seat, target};
+            }
+        }
+    }
+    return SeatAction{roll % 2 ? ActionType::Tax : ActionType::Gather, seat, none};
+}
+
+// bot_move() for tables whose seats fit a byte
+Action bot_action(const Game& game, bool end_turn, uint32_t roll = 0) {
+    SeatAction move = bot_move(game, end_turn, roll);
+    return Action{move.type, static_cast<uint8_t>(move.actor),
+                  move.target < game.player_count() ? static_cast<uint8_t>(move.target) : NO_TARGET};
+}
@@ -0,0 +1,235 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+/*
+ * Actor runtime.
+ * An actor owns its state and receives messages through a lock-free MPSC mailbox.
+ * The Scheduler runs actors on a fixed pool of core-pinned worker threads; an actor
+ * is queued on its home worker at most once, so exactly one thread touches its state
+ * at a time. Each run handles at most a small batch of messages before the actor goes
+ * back to the end of the run queue, which keeps scheduling fair across many actors.
+ */
+
+// Vyukov-style unbounded multi-producer single-consumer queue.
+// push() is wait-free; pop() and empty() may only be called by the single consumer.
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+    };
+
+    std::atomic<Node*> head; // last pushed node, shared by producers
+    Node* tail;              // stub node owned by the consumer
+
+public:
+    MpscQueue() : head(new Node{{nullptr}, T()}), tail(head.load()) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        while (tail) {
+            Node* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    void push(T value) {
+        Node* node = new Node{{nullptr}, std::move(value)};
+        Node* prev = head.exchange(node, std::memory_order_seq_cst);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Returns false when empty, or when a concurrent push has not finished linking yet
+    bool pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    // True only when no push has started since the last pop
+    bool empty() const {
+        return head.load(std::memory_order_seq_cst) == tail;
+    }
+};
+
+class Scheduler;
+
+class ActorBase {
+private:
+    friend class Scheduler;
+    std::atomic<bool> scheduled;
+    size_t home;
+
+protected:
+    Scheduler& scheduler;
+
+    // Handles up to budget messages; returns true if more are already waiting
+    virtual bool run_batch(size_t budget) = 0;
+    virtual bool has_pending() const = 0;
+
+    // Queues the actor on its home worker unless it is already queued or running
+    void wake();
+
+public:
+    ActorBase(Scheduler& scheduler, size_t home) : scheduled(false), home(home), scheduler(scheduler) {}
+    ActorBase(const ActorBase&) = delete;
+    ActorBase& operator=(const ActorBase&) = delete;
+    virtual ~ActorBase() {}
+};
+
+template <typename Message>
+class Actor : public ActorBase {
+private:
+    MpscQueue<Message> mailbox;
+
+    bool run_batch(size_t budget) override {
+        Message message;
+        for (size_t i = 0; i < budget && mailbox.pop(message); i++) {
+            receive(message);
+        }
+        return !mailbox.empty();
+    }
+
+    bool has_pending() const override { return !mailbox.empty(); }
+
+protected:
+    virtual void receive(Message& message) = 0;
+
+public:
+    Actor(Scheduler& scheduler, size_t home) : ActorBase(scheduler, home) {}
+
+    // Safe to call from any thread
+    void post(Message message) {
+        mailbox.push(std::move(message));
+        wake();
+    }
+};
+
+class Scheduler {
+private:
+    struct Worker {
+        MpscQueue<ActorBase*> run_queue;
+        std::mutex lock;
+        std::condition_variable ready;
+        std::atomic<bool> sleeping{false};
+        std::thread thread;
+    };
+
+    static const size_t BATCH_BUDGET = 64;
+    static const int IDLE_SPINS = 256;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running;
+
+    void enqueue(ActorBase& actor) {
+        Worker& worker = *workers[actor.home % workers.size()];
+        worker.run_queue.push(&actor);
+        if (worker.sleeping.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> guard(worker.lock);
+            worker.ready.notify_one();
+        }
+    }
+
+    void work(Worker& worker) {
+        int idle = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            ActorBase* actor = nullptr;
+            if (worker.run_queue.pop(actor)) {
+                idle = 0;
+                if (!actor->run_batch(BATCH_BUDGET)) {
+                    actor->scheduled.store(false, std::memory_order_seq_cst);
+                    // A producer may have posted after the batch but before the flag was cleared
+                    if (!actor->has_pending() || actor->scheduled.exchange(true, std::memory_order_seq_cst)) {
+                        continue;
+                    }
+                }
+                worker.run_queue.push(actor);
+                continue;
+            }
+            if (++idle < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+            worker.sleeping.store(true, std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> guard(worker.lock);
+                worker.ready.wait(guard, [&] {
+                    return !worker.run_queue.empty() || !running.load(std::memory_order_relaxed);
+                });
+            }
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            idle = 0;
+        }
+    }
+
+    static void pin_to_core(std::thread& thread, size_t index) {
+        unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cores, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+    }
+
+public:
+    explicit Scheduler(size_t threads, bool pin = true) : running(true) {
+        for (size_t i = 0; i < std::max<size_t>(1, threads); i++) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < workers.size(); i++) {
+            Worker* worker = workers[i].get();
+            worker->thread = std::thread([this, worker] { work(*worker); });
+            if (pin) {
+                pin_to_core(worker->thread, i);
+            }
+        }
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    ~Scheduler() {
+        stop();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // Stops the workers; messages still queued are dropped
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        for (auto& worker : workers) {
+            {
+                std::lock_guard<std::mutex> guard(worker->lock);
+                worker->ready.notify_one();
+            }
+            worker->thread.join();
+        }
+    }
+
+    void schedule(ActorBase& actor) {
+        if (!actor.scheduled.exchange(true, std::memory_order_seq_cst)) {
+            enqueue(actor);
+        }
+    }
+};
+
+void ActorBase::wake() {
+    scheduler.schedule(*this);
+}
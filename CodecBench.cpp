@@ -0,0 +1,101 @@
+#include "Replay.cpp"
+#include <iostream>
+#include <random>
+
+/*
+ * Event codec size and decode-speed benchmark.
+ * Records bot games and reports the bytes each turn takes as raw 10-byte Events (raw
+ * replays), as 16-byte journal records and coded with EventCodec.cpp (packed replays),
+ * then times decoding every game's events with the scalar and the SSE2 block decoders.
+ * Usage: ./codecbench [--games N] [--turns N] [--rounds N]
+ */
+
+int main(int argc, char* argv[]) {
+    size_t games = 20000;
+    size_t turns = 300;
+    size_t rounds = 5;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--games") {
+            games = std::stoul(value);
+        } else if (flag == "--turns") {
+            turns = std::stoul(value);
+        } else if (flag == "--rounds") {
+            rounds = std::stoul(value);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Game::next_turn() announces players who must coup; keep that off the results
+    std::ostream report(std::cout.rdbuf());
+    std::cout.setstate(std::ios_base::badbit);
+
+    std::mt19937 rng(42);
+    std::vector<std::vector<Event>> recorded(games);
+    uint64_t events = 0;
+    uint64_t played = 0;
+    for (auto& game_events : recorded) {
+        Game game;
+        seat_standard_players(game);
+        game_events.push_back(game_started_event(game));
+        for (size_t turn = 0; turn < turns && !game.is_game_over(); turn++, played++) {
+            try {
+                game_events.push_back(perform_event(game, bot_action(game, false, rng())));
+            } catch (const std::exception&) {
+                // Not allowed (e.g. sanctioned); the bot passes instead
+            }
+            if (!game.is_game_over()) {
+                game_events.push_back(perform_event(game, bot_action(game, true)));
+            }
+        }
+        events += game_events.size();
+    }
+
+    std::vector<std::vector<uint8_t>> coded(games);
+    uint64_t coded_bytes = 0;
+    for (size_t i = 0; i < games; i++) {
+        coded_bytes += encode_events(recorded[i].data(), recorded[i].size(), coded[i]);
+    }
+    double per_turn = static_cast<double>(played);
+    report << games << " games, " << played << " turns, " << events << " events" << std::endl;
+    report << "raw events:      " << static_cast<double>(events * sizeof(Event)) / per_turn << " bytes/turn"
+           << std::endl;
+    report << "journal records: " << static_cast<double>(events * JOURNAL_RECORD_SIZE) / per_turn << " bytes/turn"
+           << std::endl;
+    report << "coded events:    " << static_cast<double>(coded_bytes) / per_turn << " bytes/turn ("
+           << static_cast<double>(coded_bytes) / static_cast<double>(events) << " bytes/event)" << std::endl;
+
+    size_t mismatches = 0;
+    std::vector<Event> decoded;
+    for (bool simd : {false, true}) {
+        double best = 0;
+        for (size_t round = 0; round < rounds; round++) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < games; i++) {
+                decoded.resize(recorded[i].size());
+                decode_events(coded[i].data(), coded[i].size(), decoded.data(), decoded.size(), simd);
+                if (round == 0) {
+                    mismatches += decoded != recorded[i];
+                }
+            }
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = round == 0 ? elapsed : std::min(best, elapsed);
+        }
+        report << (simd ? "sse2 decode:   " : "scalar decode: ") << static_cast<double>(events) / best / 1e6
+               << "M events/s, " << static_cast<double>(coded_bytes) / best / (1024 * 1024) << " MiB/s coded"
+               << std::endl;
+    }
+
+    if (mismatches > 0) {
+        report << "DECODED EVENTS DISAGREE in " << mismatches << " games" << std::endl;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
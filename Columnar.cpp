@@ -0,0 +1,508 @@
+#pragma once
+#include "Protocol.cpp"
+#include "Journal.cpp"
+#include "EventCodec.cpp"
+#include <algorithm>
+#include <sys/mman.h>
+
+/*
+ * Columnar export format for analysing large simulation runs.
+ * A file holds one or more tables of int32 columns. Rows are written in groups of up
+ * to 64k, and each column of a group is stored as one chunk in whichever of three
+ * encodings is smallest for it:
+ *   plain:       zigzag varint per value (varints as in EventCodec.cpp)
+ *   run-length:  (zigzag varint value, varint run length) pairs
+ *   dictionary:  varint size, zigzag varint values, bit width u8, then one bit-packed
+ *                dictionary index per row
+ * Every chunk starts with its encoding u8 and ends with 8 zero bytes, so unpacking can
+ * always load a whole 64-bit word.
+ *   header:  magic "CPC1" | version u16 | reserved u16
+ *   chunks
+ *   footer:  varint-encoded tables: name, column names, then per group its row count
+ *            and each column chunk's offset and size
+ *   trailer: footer offset u64 | crc32 u32 of the footer | magic "CPC1"
+ * Producers fill a ColumnBatch each and hand it to ColumnarWriter::flush(), which
+ * encodes on the calling thread and only locks to append the chunks, so any number of
+ * workers can stream into one file holding at most one group each in memory. Groups
+ * from different workers interleave, so rows are not in any global order.
+ * ColumnarFile maps a file read-only and decodes one column a group at a time.
+ */
+
+const char COLUMNAR_MAGIC[4] = {'C', 'P', 'C', '1'};
+const uint16_t COLUMNAR_VERSION = 1;
+const size_t COLUMNAR_HEADER_SIZE = 8;
+const size_t COLUMNAR_TRAILER_SIZE = 16;
+const size_t COLUMNAR_GROUP_ROWS = 65536;
+const size_t COLUMNAR_MAX_DICTIONARY = 4096;
+const size_t COLUMNAR_PADDING = 8;
+
+enum class ColumnEncoding : uint8_t {
+    Plain = 0,
+    RunLength,
+    Dictionary
+};
+
+class ColumnarException : public std::runtime_error {
+public:
+    ColumnarException(const std::string& message) : std::runtime_error(message) {}
+};
+
+inline int32_t get_value(const uint8_t*& in, const uint8_t* end) {
+    return static_cast<int32_t>(unzigzag(get_varint(in, end)));
+}
+
+void encode_plain(const int32_t* values, size_t count, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < count; i++) {
+        put_varint(out, zigzag(values[i]));
+    }
+}
+
+void encode_run_length(const int32_t* values, size_t count, std::vector<uint8_t>& out) {
+    for (size_t i = 0; i < count;) {
+        size_t run = 1;
+        while (i + run < count && values[i + run] == values[i]) {
+            run++;
+        }
+        put_varint(out, zigzag(values[i]));
+        put_varint(out, run);
+        i += run;
+    }
+}
+
+// Returns false, leaving out untouched, if the values need too large a dictionary
+bool encode_dictionary(const int32_t* values, size_t count, std::vector<uint8_t>& out) {
+    // Open-addressing map from value to dictionary index; a slot index of 0 is empty
+    const size_t SLOT_BITS = 13;
+    const size_t SLOTS = static_cast<size_t>(1) << SLOT_BITS;
+    static_assert(SLOTS >= COLUMNAR_MAX_DICTIONARY * 2, "Dictionary map must stay at most half full");
+    static thread_local std::vector<std::pair<int32_t, uint32_t>> slots(SLOTS);
+    static thread_local std::vector<uint32_t> indices;
+    std::fill(slots.begin(), slots.end(), std::pair<int32_t, uint32_t>(0, 0));
+    indices.resize(count);
+    std::vector<int32_t> dictionary;
+    for (size_t i = 0; i < count; i++) {
+        size_t slot = (static_cast<uint32_t>(values[i]) * 2654435761u) >> (32 - SLOT_BITS);
+        while (slots[slot].second != 0 && slots[slot].first != values[i]) {
+            slot = (slot + 1) & (SLOTS - 1);
+        }
+        if (slots[slot].second == 0) {
+            if (dictionary.size() == COLUMNAR_MAX_DICTIONARY) {
+                return false;
+            }
+            dictionary.push_back(values[i]);
+            slots[slot] = {values[i], static_cast<uint32_t>(dictionary.size())};
+        }
+        indices[i] = slots[slot].second - 1;
+    }
+
+    uint8_t width = 0;
+    while ((static_cast<size_t>(1) << width) < dictionary.size()) {
+        width++;
+    }
+    put_varint(out, dictionary.size());
+    for (int32_t value : dictionary) {
+        put_varint(out, zigzag(value));
+    }
+    out.push_back(width);
+    uint64_t bits = 0;
+    int used = 0;
+    for (size_t i = 0; i < count; i++) {
+        bits |= static_cast<uint64_t>(indices[i]) << used;
+        used += width;
+        while (used >= 8) {
+            out.push_back(static_cast<uint8_t>(bits));
+            bits >>= 8;
+            used -= 8;
+        }
+    }
+    if (used > 0) {
+        out.push_back(static_cast<uint8_t>(bits));
+    }
+    return true;
+}
+
+// Encodes a column chunk in its smallest encoding, padding included
+void encode_chunk(const int32_t* values, size_t count, std::vector<uint8_t>& out) {
+    static thread_local std::vector<uint8_t> candidate;
+    out.assign(1, static_cast<uint8_t>(ColumnEncoding::Plain));
+    encode_plain(values, count, out);
+
+    candidate.assign(1, static_cast<uint8_t>(ColumnEncoding::RunLength));
+    encode_run_length(values, count, candidate);
+    if (candidate.size() < out.size()) {
+        out.swap(candidate);
+    }
+    candidate.assign(1, static_cast<uint8_t>(ColumnEncoding::Dictionary));
+    if (encode_dictionary(values, count, candidate) && candidate.size() < out.size()) {
+        out.swap(candidate);
+    }
+    out.insert(out.end(), COLUMNAR_PADDING, 0);
+}
+
+void decode_chunk_values(const uint8_t* data, size_t size, size_t count, int32_t* out) {
+    if (size < 1 + COLUMNAR_PADDING) {
+        throw ColumnarException("Column chunk is truncated");
+    }
+    const uint8_t* in = data + 1;
+    const uint8_t* end = data + size - COLUMNAR_PADDING;
+    switch (static_cast<ColumnEncoding>(data[0])) {
+        case ColumnEncoding::Plain:
+            for (size_t i = 0; i < count; i++) {
+                out[i] = get_value(in, end);
+            }
+            return;
+        case ColumnEncoding::RunLength:
+            for (size_t i = 0; i < count;) {
+                int32_t value = get_value(in, end);
+                uint64_t run = get_varint(in, end);
+                if (run == 0 || run > count - i) {
+                    throw ColumnarException("Run-length chunk has a bad run");
+                }
+                std::fill(out + i, out + i + run, value);
+                i += run;
+            }
+            return;
+        case ColumnEncoding::Dictionary: {
+            uint64_t entries = get_varint(in, end);
+            if (entries == 0 || entries > COLUMNAR_MAX_DICTIONARY) {
+                throw ColumnarException("Dictionary chunk has a bad dictionary");
+            }
+            int32_t dictionary[COLUMNAR_MAX_DICTIONARY];
+            for (uint64_t i = 0; i < entries; i++) {
+                dictionary[i] = get_value(in, end);
+            }
+            if (in == end || *in > 12 || (static_cast<uint64_t>(1) << *in) < entries) {
+                throw ColumnarException("Dictionary chunk has a bad bit width");
+            }
+            unsigned width = *in++;
+            if (static_cast<size_t>(end - in) < (count * width + 7) / 8) {
+                throw ColumnarException("Dictionary chunk is truncated");
+            }
+            // Indices past the dictionary can only come from corruption; clamp rather than check each row
+            uint64_t mask = (static_cast<uint64_t>(1) << width) - 1;
+            uint64_t last = entries - 1;
+            for (size_t i = 0, bit = 0; i < count; i++, bit += width) {
+                uint64_t word;
+                std::memcpy(&word, in + bit / 8, sizeof(word));
+                out[i] = dictionary[std::min((word >> (bit % 8)) & mask, last)];
+            }
+            return;
+        }
+    }
+    throw ColumnarException("Column chunk has an unknown encoding");
+}
+
+// Decodes a chunk of count rows into out
+void decode_chunk(const uint8_t* data, size_t size, size_t count, int32_t* out) {
+    try {
+        decode_chunk_values(data, size, count, out);
+    } catch (const CodecException& error) {
+        throw ColumnarException(std::string("Column chunk is corrupt: ") + error.what());
+    }
+}
+
+struct ColumnChunk {
+    uint64_t offset;
+    uint32_t size;
+};
+
+struct ColumnTable {
+    std::string name;
+    std::vector<std::string> columns;
+    std::vector<uint32_t> group_rows;
+    std::vector<ColumnChunk> chunks; // group-major: chunks[group * columns.size() + column]
+    uint64_t rows = 0;
+};
+
+// Rows of one table gathered by one producer, flushed to the writer a group at a time
+class ColumnBatch {
+private:
+    size_t table_id;
+    std::vector<std::vector<int32_t>> columns;
+
+    friend class ColumnarWriter;
+
+public:
+    ColumnBatch(size_t table, size_t column_count) : table_id(table), columns(column_count) {
+        for (auto& column : columns) {
+            column.reserve(COLUMNAR_GROUP_ROWS);
+        }
+    }
+
+    size_t table() const { return table_id; }
+    size_t rows() const { return columns.empty() ? 0 : columns[0].size(); }
+};
+
+class ColumnarWriter {
+private:
+    std::string path;
+    int fd;
+    uint64_t offset;
+    std::vector<ColumnTable> tables;
+    std::mutex mutex;
+
+    void write_all(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw ColumnarException("Cannot write " + path);
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    static void put_string(std::vector<uint8_t>& out, const std::string& text) {
+        put_varint(out, text.size());
+        out.insert(out.end(), text.begin(), text.end());
+    }
+
+public:
+    // schema: each table's name and column names
+    ColumnarWriter(const std::string& file, const std::vector<std::pair<std::string, std::vector<std::string>>>& schema)
+        : path(file), fd(-1), offset(COLUMNAR_HEADER_SIZE) {
+        for (const auto& [name, columns] : schema) {
+            ColumnTable table;
+            table.name = name;
+            table.columns = columns;
+            tables.push_back(table);
+        }
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw ColumnarException("Cannot create " + path);
+        }
+        uint8_t header[COLUMNAR_HEADER_SIZE] = {};
+        std::memcpy(header, COLUMNAR_MAGIC, 4);
+        put_u16(header + 4, COLUMNAR_VERSION);
+        write_all(header, sizeof(header));
+    }
+
+    ~ColumnarWriter() {
+        if (fd >= 0) {
+            try {
+                close();
+            } catch (const ColumnarException&) {
+            }
+        }
+    }
+
+    ColumnarWriter(const ColumnarWriter&) = delete;
+    ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+    ColumnBatch batch(size_t table) const {
+        return ColumnBatch(table, tables.at(table).columns.size());
+    }
+
+    // Adds a row, flushing the batch once it holds a full group
+    void append(ColumnBatch& batch, std::initializer_list<int32_t> row) {
+        if (row.size() != batch.columns.size()) {
+            throw std::invalid_argument("Row does not match the table's columns");
+        }
+        const int32_t* value = row.begin();
+        for (auto& column : batch.columns) {
+            column.push_back(*value++);
+        }
+        if (batch.rows() == COLUMNAR_GROUP_ROWS) {
+            flush(batch);
+        }
+    }
+
+    // Encodes the batch as one group and appends it; safe to call from several threads
+    void flush(ColumnBatch& batch) {
+        size_t rows = batch.rows();
+        if (rows == 0) {
+            return;
+        }
+        std::vector<uint8_t> group;
+        std::vector<uint8_t> chunk;
+        std::vector<uint32_t> sizes;
+        for (auto& column : batch.columns) {
+            encode_chunk(column.data(), rows, chunk);
+            sizes.push_back(static_cast<uint32_t>(chunk.size()));
+            group.insert(group.end(), chunk.begin(), chunk.end());
+            column.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0) {
+            throw ColumnarException(path + " is already closed");
+        }
+        write_all(group.data(), group.size());
+        ColumnTable& table = tables[batch.table_id];
+        table.group_rows.push_back(static_cast<uint32_t>(rows));
+        table.rows += rows;
+        for (uint32_t size : sizes) {
+            table.chunks.push_back(ColumnChunk{offset, size});
+            offset += size;
+        }
+    }
+
+    // Writes the footer; batches must be flushed first
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0) {
+            return;
+        }
+        std::vector<uint8_t> footer;
+        put_varint(footer, tables.size());
+        for (const auto& table : tables) {
+            put_string(footer, table.name);
+            put_varint(footer, table.columns.size());
+            for (const auto& column : table.columns) {
+                put_string(footer, column);
+            }
+            put_varint(footer, table.group_rows.size());
+            for (size_t group = 0; group < table.group_rows.size(); group++) {
+                put_varint(footer, table.group_rows[group]);
+                for (size_t column = 0; column < table.columns.size(); column++) {
+                    const ColumnChunk& chunk = table.chunks[group * table.columns.size() + column];
+                    put_varint(footer, chunk.offset);
+                    put_varint(footer, chunk.size);
+                }
+            }
+        }
+        uint8_t trailer[COLUMNAR_TRAILER_SIZE];
+        put_u64(trailer, offset);
+        put_u32(trailer + 8, crc32(footer.data(), footer.size()));
+        std::memcpy(trailer + 12, COLUMNAR_MAGIC, 4);
+        footer.insert(footer.end(), trailer, trailer + sizeof(trailer));
+        bool ok = true;
+        try {
+            write_all(footer.data(), footer.size());
+        } catch (const ColumnarException&) {
+            ok = false;
+        }
+        ::close(fd);
+        fd = -1;
+        if (!ok) {
+            throw ColumnarException("Cannot write " + path);
+        }
+    }
+};
+
+// Read-only memory mapping of a columnar file
+class ColumnarFile {
+private:
+    const uint8_t* mapping;
+    size_t mapping_size;
+    std::vector<ColumnTable> table_list;
+
+    std::string get_string(const uint8_t*& in, const uint8_t* end) {
+        uint64_t size = get_varint(in, end);
+        if (size > static_cast<uint64_t>(end - in)) {
+            throw ColumnarException("Columnar footer is truncated");
+        }
+        std::string text(reinterpret_cast<const char*>(in), size);
+        in += size;
+        return text;
+    }
+
+    void read_footer(const uint8_t* in, const uint8_t* end) {
+        uint64_t count = get_varint(in, end);
+        for (uint64_t t = 0; t < count; t++) {
+            ColumnTable table;
+            table.name = get_string(in, end);
+            uint64_t columns = get_varint(in, end);
+            for (uint64_t c = 0; c < columns && in < end; c++) {
+                table.columns.push_back(get_string(in, end));
+            }
+            uint64_t groups = get_varint(in, end);
+            for (uint64_t g = 0; g < groups && in < end; g++) {
+                uint64_t rows = get_varint(in, end);
+                if (rows > COLUMNAR_GROUP_ROWS) {
+                    throw ColumnarException("Columnar group is too large");
+                }
+                table.group_rows.push_back(static_cast<uint32_t>(rows));
+                table.rows += rows;
+                for (size_t c = 0; c < table.columns.size(); c++) {
+                    uint64_t offset = get_varint(in, end);
+                    uint64_t size = get_varint(in, end);
+                    if (offset > mapping_size || size > mapping_size - offset) {
+                        throw ColumnarException("Column chunk is out of bounds");
+                    }
+                    table.chunks.push_back(ColumnChunk{offset, static_cast<uint32_t>(size)});
+                }
+            }
+            if (table.columns.size() != columns || table.group_rows.size() != groups) {
+                throw ColumnarException("Columnar footer is truncated");
+            }
+            table_list.push_back(table);
+        }
+    }
+
+public:
+    explicit ColumnarFile(const std::string& path) : mapping(nullptr), mapping_size(0) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw ColumnarException("Cannot open " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(COLUMNAR_HEADER_SIZE + COLUMNAR_TRAILER_SIZE)) {
+            close(fd);
+            throw ColumnarException(path + " is not a columnar file");
+        }
+        mapping_size = static_cast<size_t>(info.st_size);
+        void* address = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw ColumnarException("Cannot map " + path);
+        }
+        mapping = static_cast<const uint8_t*>(address);
+
+        const uint8_t* trailer = mapping + mapping_size - COLUMNAR_TRAILER_SIZE;
+        uint64_t footer = get_u64(trailer);
+        try {
+            if (std::memcmp(mapping, COLUMNAR_MAGIC, 4) != 0 || get_u16(mapping + 4) != COLUMNAR_VERSION ||
+                std::memcmp(trailer + 12, COLUMNAR_MAGIC, 4) != 0 || footer < COLUMNAR_HEADER_SIZE ||
+                footer > mapping_size - COLUMNAR_TRAILER_SIZE ||
+                crc32(mapping + footer, mapping_size - COLUMNAR_TRAILER_SIZE - footer) != get_u32(trailer + 8)) {
+                throw ColumnarException(path + " is not a valid columnar file");
+            }
+            read_footer(mapping + footer, trailer);
+        } catch (const CodecException& error) {
+            munmap(const_cast<uint8_t*>(mapping), mapping_size);
+            throw ColumnarException(path + " has a corrupt footer: " + error.what());
+        } catch (...) {
+            munmap(const_cast<uint8_t*>(mapping), mapping_size);
+            throw;
+        }
+    }
+
+    ~ColumnarFile() {
+        munmap(const_cast<uint8_t*>(mapping), mapping_size);
+    }
+
+    ColumnarFile(const ColumnarFile&) = delete;
+    ColumnarFile& operator=(const ColumnarFile&) = delete;
+
+    const std::vector<ColumnTable>& tables() const { return table_list; }
+
+    const ColumnTable& table(const std::string& name) const {
+        for (const auto& table : table_list) {
+            if (table.name == name) {
+                return table;
+            }
+        }
+        throw ColumnarException("No table " + name);
+    }
+
+    // Calls visit(values, count) for each group of the column, in file order
+    template <typename Visit>
+    void scan(const std::string& table_name, const std::string& column_name, Visit visit) const {
+        const ColumnTable& info = table(table_name);
+        auto found = std::find(info.columns.begin(), info.columns.end(), column_name);
+        if (found == info.columns.end()) {
+            throw ColumnarException("No column " + table_name + "." + column_name);
+        }
+        size_t column = static_cast<size_t>(found - info.columns.begin());
+        std::vector<int32_t> values(COLUMNAR_GROUP_ROWS);
+        for (size_t group = 0; group < info.group_rows.size(); group++) {
+            const ColumnChunk& chunk = info.chunks[group * info.columns.size() + column];
+            decode_chunk(mapping + chunk.offset, chunk.size, info.group_rows[group], values.data());
+            visit(static_cast<const int32_t*>(values.data()), static_cast<size_t>(info.group_rows[group]));
+        }
+    }
+};
@@ -0,0 +1,310 @@
+#pragma once
+#include "EventLog.cpp"
+#include "Protocol.cpp"
+#include "Actor.cpp"
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Runs a Game on its own thread for a UI, at any table size.
+ * The UI submits actions through an MPSC mailbox; the worker performs them (and, when
+ * asked, plays bot turns at a set rate) and publishes one EngineUpdate per action into
+ * a bounded SPSC ring: the event plus the players it changed, as PlayerDeltas. The
+ * worker is its game's listener, so it sends only the players an action touched, by
+ * seat index, however many seats the table has. The UI drains the ring once per frame,
+ * applies every update to its copy of the table and only then redraws, so however many
+ * actions ran since the last frame it paints once, from the latest state. When the ring
+ * is full the worker waits rather than drop updates.
+ */
+
+// Bounded lock-free single-producer single-consumer ring.
+// try_push() may only be called by one thread and try_pop() by one other thread.
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+private:
+    T slots[N];
+    alignas(64) std::atomic<uint64_t> head; // next slot to pop, written by the consumer
+    alignas(64) std::atomic<uint64_t> tail; // next slot to push, written by the producer
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool try_push(const T& value) {
+        uint64_t at = tail.load(std::memory_order_relaxed);
+        if (at - head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        slots[at & (N - 1)] = value;
+        tail.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        uint64_t at = head.load(std::memory_order_relaxed);
+        if (at == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[at & (N - 1)];
+        head.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return N; }
+};
+
+// One player's public state after an update, by seat index
+struct PlayerDelta {
+    uint32_t seat;
+    SeatState state;
+};
+
+// An action changes its actor, its target and the players either side of a turn change;
+// any more go out in follow-up updates marked continued
+const uint8_t UPDATE_CHANGES = 4;
+
+// One performed (or rejected) action and the players it changed. The event's seat bytes
+// are NO_TARGET past what a byte numbers; actor, target and current are the full seats.
+struct EngineUpdate {
+    Event event;
+    uint32_t actor;
+    uint32_t target;  // player count when the action has none
+    uint32_t current; // seat whose turn it is afterwards
+    uint8_t error;    // ErrorCode of a rejected action, or 0 when it ran
+    bool continued;   // carries only changes left over from the update before
+    uint8_t count;    // entries used in changed
+    PlayerDelta changed[UPDATE_CHANGES];
+};
+
+// Applies an update to a copy of the table state, for tables of up to MAX_SEATS
+void apply_update(TableState& state, const EngineUpdate& update) {
+    state.current = static_cast<uint8_t>(update.current);
+    for (uint8_t i = 0; i < update.count; i++) {
+        state.seat[update.changed[i].seat] = update.changed[i].state;
+    }
+}
+
+// Applies an update to a copy of the game, including who was arrested last, which the
+// copy needs to refuse the same arrests the engine will
+void apply_update(Game& game, const EngineUpdate& update) {
+    for (uint8_t i = 0; i < update.count; i++) {
+        apply_seat_state(*game.get_player(update.changed[i].seat), update.changed[i].state);
+    }
+    if (!update.continued && !update.error && update.event.action == ActionType::Arrest) {
+        game.set_last_arrested(game.get_player(update.target));
+    }
+    game.set_current_index(update.current);
+}
+
+struct EngineCommand {
+    SeatAction action;
+    bool end_turn; // pass the turn afterwards if the action ran
+};
+
+const size_t ENGINE_QUEUE_SIZE = 4096;
+
+class EngineThread : public GameListener {
+private:
+    Game game;
+    // What the UI has been sent of each seat, and the seats changed since
+    std::vector<SeatState> sent;
+    std::unordered_map<const Player*, uint32_t> seat_of;
+    std::vector<uint32_t> touched;
+    MpscQueue<EngineCommand> commands;
+    SpscQueue<EngineUpdate, ENGINE_QUEUE_SIZE> updates;
+    std::atomic<bool> stopping;
+    // Bot settings, written by the UI and picked up by the worker
+    std::atomic<uint32_t> bot_rate;
+    std::atomic<uint64_t> bot_left;
+    std::atomic<bool> bot_coups;
+    std::atomic<uint64_t> performed;
+    std::thread worker;
+
+    void player_changed(const Player& player) override {
+        touched.push_back(seat_of.at(&player));
+    }
+
+    void turn_changed(size_t, size_t) override {}
+
+    bool push(const EngineUpdate& update) {
+        while (!updates.try_push(update)) {
+            if (stopping.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        performed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void publish(const Event& event, const SeatAction& action, uint8_t error) {
+        EngineUpdate update{};
+        update.event = event;
+        update.actor = static_cast<uint32_t>(action.actor);
+        bool targeted = action_has_target(action.type) && action.target < game.player_count();
+        update.target = static_cast<uint32_t>(targeted ? action.target : game.player_count());
+        update.current = static_cast<uint32_t>(game.get_current_index());
+        update.error = error;
+        for (uint32_t seat : touched) {
+            SeatState now = seat_state(*game.get_player(seat));
+            if (now == sent[seat]) {
+                continue;
+            }
+            sent[seat] = now;
+            if (update.count == UPDATE_CHANGES) {
+                if (!push(update)) {
+                    return;
+                }
+                update.continued = true;
+                update.count = 0;
+            }
+            update.changed[update.count++] = PlayerDelta{seat, now};
+        }
+        touched.clear();
+        push(update);
+    }
+
+    // Performs an action on the players its seats name and publishes it
+    void perform_and_publish(const SeatAction& action) {
+        if (action.actor >= game.player_count()) {
+            throw NotPlayerTurnException("It is not this player's turn");
+        }
+        Player* target = action.target < game.player_count() ? game.get_player(action.target) : nullptr;
+        publish(perform_event(game, action.type, *game.get_player(action.actor), target).event, action, 0);
+    }
+
+    // Performs one action and publishes it; returns false if the engine rejected it
+    bool run_action(const SeatAction& action) {
+        try {
+            perform_and_publish(action);
+            return true;
+        } catch (const std::exception& e) {
+            uint8_t target = action.target < NO_TARGET ? static_cast<uint8_t>(action.target) : NO_TARGET;
+            uint8_t actor = action.actor < NO_TARGET ? static_cast<uint8_t>(action.actor) : NO_TARGET;
+            Event rejected{action.type, actor, target, NO_TARGET, 0, 0, 0};
+            publish(rejected, action, static_cast<uint8_t>(error_code_for(e)));
+            return false;
+        }
+    }
+
+    // One bot turn: an action, then passing the turn. Without coups the bot spends its
+    // coins on bribes, so the game never ends; moves the engine rejects are skipped.
+    void bot_turn(std::mt19937& rng) {
+        SeatAction action = bot_move(game, false, rng());
+        if (action.type == ActionType::Coup && !bot_coups.load(std::memory_order_relaxed)) {
+            action = SeatAction{ActionType::Bribe, action.actor, game.player_count()};
+        }
+        try {
+            perform_and_publish(action);
+        } catch (const std::exception&) {
+            // Anything it changed goes out with the next update
+        }
+        if (!game.is_game_over()) {
+            run_action(bot_move(game, true));
+        }
+    }
+
+    void run() {
+        std::mt19937 rng(42);
+        auto next_bot = std::chrono::steady_clock::now();
+        while (!stopping.load(std::memory_order_acquire)) {
+            bool busy = false;
+            EngineCommand command;
+            while (commands.pop(command)) {
+                busy = true;
+                if (run_action(command.action) && command.end_turn && !game.is_game_over()) {
+                    run_action(bot_move(game, true));
+                }
+            }
+            if (bot_left.load(std::memory_order_relaxed) > 0 && game.is_game_over()) {
+                bot_left.store(0, std::memory_order_relaxed);
+            }
+            if (bot_left.load(std::memory_order_relaxed) > 0) {
+                uint32_t rate = bot_rate.load(std::memory_order_relaxed);
+                auto now = std::chrono::steady_clock::now();
+                if (rate == 0 || now >= next_bot) {
+                    bot_turn(rng);
+                    // Count the turn unless stop_bot() got in first: never below zero
+                    uint64_t left = bot_left.load(std::memory_order_relaxed);
+                    while (left > 0 && !bot_left.compare_exchange_weak(left, left - 1, std::memory_order_relaxed)) {
+                    }
+                    next_bot = rate == 0 ? now : std::max(next_bot, now - std::chrono::milliseconds(100)) +
+                                                     std::chrono::nanoseconds(1000000000 / rate);
+                    busy = true;
+                }
+            }
+            if (!busy) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+public:
+    // Takes a copy of the table; the worker owns it from then on
+    explicit EngineThread(const Game& start)
+        : game(start), stopping(false), bot_rate(0), bot_left(0), bot_coups(true), performed(0) {
+        for (size_t seat = 0; seat < game.player_count(); seat++) {
+            sent.push_back(seat_state(*game.get_player(seat)));
+            seat_of[game.get_player(seat)] = static_cast<uint32_t>(seat);
+        }
+        game.set_listener(this);
+        worker = std::thread([this] { run(); });
+    }
+
+    ~EngineThread() { stop(); }
+
+    EngineThread(const EngineThread&) = delete;
+    EngineThread& operator=(const EngineThread&) = delete;
+
+    // Queues an action; its update arrives through drain()
+    void submit(const SeatAction& action, bool end_turn = false) {
+        commands.push(EngineCommand{action, end_turn});
+    }
+
+    void submit(const Action& action, bool end_turn = false) {
+        submit(SeatAction{action.type, action.actor, action.target == NO_TARGET ? SIZE_MAX : action.target},
+               end_turn);
+    }
+
+    // Plays up to turns bot turns at per_second turns a second (0: as fast as possible);
+    // the bot stops early if the game ends
+    void start_bot(uint64_t turns, uint32_t per_second, bool coups = true) {
+        bot_rate.store(per_second, std::memory_order_relaxed);
+        bot_coups.store(coups, std::memory_order_relaxed);
+        bot_left.store(turns, std::memory_order_relaxed);
+    }
+
+    void stop_bot() { bot_left.store(0, std::memory_order_relaxed); }
+    bool bot_running() const { return bot_left.load(std::memory_order_relaxed) > 0; }
+
+    // Updates published so far
+    uint64_t published() const { return performed.load(std::memory_order_relaxed); }
+
+    // Called from one consumer thread: visit(update) for every update waiting; returns how many
+    template <typename Visit>
+    size_t drain(Visit visit) {
+        size_t count = 0;
+        EngineUpdate update;
+        while (updates.try_pop(update)) {
+            visit(update);
+            count++;
+        }
+        return count;
+    }
+
+    void stop() {
+        stopping.store(true, std::memory_order_release);
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // The worker's game; only safe to read after stop()
+    const Game& stopped_game() const { return game; }
+};
@@ -0,0 +1,277 @@
+#pragma once
+#include "EventLog.cpp"
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+ * Compact variable-length coding of game events.
+ * Most events are a small action between a few seats that moves 1-3 coins, so the
+ * fixed 10-byte Event is mostly zeros. Events are coded in blocks of up to 16:
+ *   n header bytes: action (low nibble) | A | T | V | W (high nibble flags)
+ *   n seat bytes:   actor (low nibble) | target (high nibble; for NextTurn the next seat)
+ *                   with 15 meaning NO_TARGET
+ *   tail, in event order: W: actor u8 | target u8 | next u8 (seats that do not fit a nibble)
+ *                         A: actor_delta, T: target_delta, V: value as zigzag varints
+ * A flag is clear when its field is zero (or W when the seats fit), so a gather is
+ * 3 bytes and a plain turn change 2. A one-event block suits single events, e.g. on
+ * the wire; whole blocks are decoded with SSE2 when it is available: the headers and
+ * seats of all 16 events are unpacked at once, and when the block's varints all fit
+ * in one byte (which the high bits of 16 tail bytes at a time confirm) they are read
+ * without any continuation checks.
+ */
+
+const size_t CODEC_BLOCK = 16;
+const size_t CODEC_MAX_EVENT_SIZE = 14;
+const uint8_t CODEC_ACTOR_DELTA = 0x10;
+const uint8_t CODEC_TARGET_DELTA = 0x20;
+const uint8_t CODEC_VALUE = 0x40;
+const uint8_t CODEC_WIDE = 0x80;
+const uint8_t CODEC_NO_SEAT = 0x0F;
+
+class CodecException : public std::runtime_error {
+public:
+    CodecException(const std::string& message) : std::runtime_error(message) {}
+};
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline uint64_t get_varint(const uint8_t*& in, const uint8_t* end) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in == end) {
+            throw CodecException("Varint runs past the end of its buffer");
+        }
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw CodecException("Varint is too long");
+}
+
+inline int16_t get_coin_varint(const uint8_t*& in, const uint8_t* end) {
+    int64_t value = unzigzag(get_varint(in, end));
+    if (value < INT16_MIN || value > INT16_MAX) {
+        throw CodecException("Coin amount is out of range");
+    }
+    return static_cast<int16_t>(value);
+}
+
+inline uint8_t seat_nibble(uint8_t seat) {
+    return seat == NO_TARGET ? CODEC_NO_SEAT : seat;
+}
+
+inline uint8_t nibble_seat(uint8_t nibble) {
+    return nibble == CODEC_NO_SEAT ? NO_TARGET : nibble;
+}
+
+// Appends the events in blocks of CODEC_BLOCK and returns the number of bytes written
+size_t encode_events(const Event* events, size_t count, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    for (size_t first = 0; first < count; first += CODEC_BLOCK) {
+        size_t n = std::min(CODEC_BLOCK, count - first);
+        size_t headers = out.size();
+        out.resize(headers + 2 * n);
+        for (size_t i = 0; i < n; i++) {
+            const Event& event = events[first + i];
+            uint8_t action = static_cast<uint8_t>(event.action);
+            if (action > 0x0F) {
+                throw std::invalid_argument("Event has an unknown action");
+            }
+            bool turn = event.action == ActionType::NextTurn;
+            uint8_t high = turn ? event.next : event.target;
+            bool narrow = (event.actor < CODEC_NO_SEAT || event.actor == NO_TARGET) &&
+                          (high < CODEC_NO_SEAT || high == NO_TARGET) && (turn ? event.target : event.next) == NO_TARGET;
+            uint8_t flags = static_cast<uint8_t>((event.actor_delta ? CODEC_ACTOR_DELTA : 0) |
+                                                 (event.target_delta ? CODEC_TARGET_DELTA : 0) |
+                                                 (event.value ? CODEC_VALUE : 0) | (narrow ? 0 : CODEC_WIDE));
+            out[headers + i] = static_cast<uint8_t>(action | flags);
+            out[headers + n + i] = narrow ? static_cast<uint8_t>(seat_nibble(event.actor) | seat_nibble(high) << 4) : 0;
+            if (!narrow) {
+                out.push_back(event.actor);
+                out.push_back(event.target);
+                out.push_back(event.next);
+            }
+            if (event.actor_delta) {
+                put_varint(out, zigzag(event.actor_delta));
+            }
+            if (event.target_delta) {
+                put_varint(out, zigzag(event.target_delta));
+            }
+            if (event.value) {
+                put_varint(out, zigzag(event.value));
+            }
+        }
+    }
+    return out.size() - start;
+}
+
+// Decodes one block of n events with plain byte-at-a-time code
+const uint8_t* decode_block_scalar(const uint8_t* in, const uint8_t* end, Event* out, size_t n) {
+    if (static_cast<size_t>(end - in) < 2 * n) {
+        throw CodecException("Event block is truncated");
+    }
+    const uint8_t* headers = in;
+    const uint8_t* seats = in + n;
+    in += 2 * n;
+    for (size_t i = 0; i < n; i++) {
+        Event& event = out[i];
+        uint8_t flags = headers[i] & 0xF0;
+        if ((headers[i] & 0x0F) >= static_cast<uint8_t>(ActionType::Count)) {
+            throw CodecException("Event has an unknown action");
+        }
+        event.action = static_cast<ActionType>(headers[i] & 0x0F);
+        if (flags & CODEC_WIDE) {
+            if (end - in < 3) {
+                throw CodecException("Event block is truncated");
+            }
+            event.actor = in[0];
+            event.target = in[1];
+            event.next = in[2];
+            in += 3;
+        } else {
+            uint8_t high = nibble_seat(seats[i] >> 4);
+            bool turn = event.action == ActionType::NextTurn;
+            event.actor = nibble_seat(seats[i] & 0x0F);
+            event.target = turn ? NO_TARGET : high;
+            event.next = turn ? high : NO_TARGET;
+        }
+        event.actor_delta = flags & CODEC_ACTOR_DELTA ? get_coin_varint(in, end) : 0;
+        event.target_delta = flags & CODEC_TARGET_DELTA ? get_coin_varint(in, end) : 0;
+        event.value = flags & CODEC_VALUE ? get_coin_varint(in, end) : 0;
+    }
+    return in;
+}
+
+#ifdef __SSE2__
+// Decodes a full block of CODEC_BLOCK events; returns nullptr if it needs the scalar path
+const uint8_t* decode_block_sse2(const uint8_t* in, const uint8_t* end, Event* out) {
+    if (end - in < static_cast<ptrdiff_t>(2 * CODEC_BLOCK)) {
+        return nullptr;
+    }
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    __m128i headers = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    __m128i seats = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + CODEC_BLOCK));
+    // Any wide event falls back to the scalar path
+    if (_mm_movemask_epi8(headers) != 0) {
+        return nullptr;
+    }
+    __m128i action = _mm_and_si128(headers, low_nibble);
+    const __m128i last_action = _mm_set1_epi8(static_cast<char>(ActionType::Count) - 1);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(action, last_action)) != 0) {
+        throw CodecException("Event has an unknown action");
+    }
+    __m128i flags = _mm_and_si128(_mm_srli_epi16(headers, 4), low_nibble);
+    __m128i actor = _mm_and_si128(seats, low_nibble);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(seats, 4), low_nibble);
+    actor = _mm_or_si128(actor, _mm_cmpeq_epi8(actor, low_nibble));
+    high = _mm_or_si128(high, _mm_cmpeq_epi8(high, low_nibble));
+    __m128i turn = _mm_cmpeq_epi8(action, _mm_set1_epi8(static_cast<char>(ActionType::NextTurn)));
+    __m128i target = _mm_or_si128(high, turn);
+    __m128i next = _mm_or_si128(high, _mm_andnot_si128(turn, _mm_set1_epi8(-1)));
+
+    // Interleave into the first four bytes of each Event: action | actor | target | next
+    __m128i action_actor_low = _mm_unpacklo_epi8(action, actor);
+    __m128i action_actor_high = _mm_unpackhi_epi8(action, actor);
+    __m128i target_next_low = _mm_unpacklo_epi8(target, next);
+    __m128i target_next_high = _mm_unpackhi_epi8(target, next);
+    alignas(16) uint32_t prefix[CODEC_BLOCK];
+    alignas(16) uint8_t flag[CODEC_BLOCK];
+    _mm_store_si128(reinterpret_cast<__m128i*>(prefix), _mm_unpacklo_epi16(action_actor_low, target_next_low));
+    _mm_store_si128(reinterpret_cast<__m128i*>(prefix + 4), _mm_unpackhi_epi16(action_actor_low, target_next_low));
+    _mm_store_si128(reinterpret_cast<__m128i*>(prefix + 8), _mm_unpacklo_epi16(action_actor_high, target_next_high));
+    _mm_store_si128(reinterpret_cast<__m128i*>(prefix + 12), _mm_unpackhi_epi16(action_actor_high, target_next_high));
+    _mm_store_si128(reinterpret_cast<__m128i*>(flag), flags);
+
+    // The flags count the block's varints; if none has a continuation bit each is one byte
+    static const uint8_t BITS[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+    size_t values = 0;
+    for (size_t i = 0; i < CODEC_BLOCK; i++) {
+        values += BITS[flag[i]];
+    }
+    const uint8_t* tail = in + 2 * CODEC_BLOCK;
+    bool short_values = static_cast<size_t>(end - tail) >= ((values + 15) & ~static_cast<size_t>(15));
+    for (size_t k = 0; short_values && k < values; k += 16) {
+        uint32_t continued = static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tail + k))));
+        if (values - k < 16) {
+            continued &= (1u << (values - k)) - 1;
+        }
+        short_values = continued == 0;
+    }
+
+    static_assert(offsetof(Event, actor_delta) == 4, "Events start with their four one-byte fields");
+    for (size_t i = 0; i < CODEC_BLOCK; i++) {
+        Event& event = out[i];
+        std::memcpy(&event, &prefix[i], 4);
+        event.actor_delta = 0;
+        event.target_delta = 0;
+        event.value = 0;
+    }
+    if (values == 0) {
+        return tail;
+    }
+    if (!short_values) {
+        for (size_t i = 0; i < CODEC_BLOCK; i++) {
+            Event& event = out[i];
+            uint8_t bits = static_cast<uint8_t>(flag[i] << 4);
+            event.actor_delta = bits & CODEC_ACTOR_DELTA ? get_coin_varint(tail, end) : 0;
+            event.target_delta = bits & CODEC_TARGET_DELTA ? get_coin_varint(tail, end) : 0;
+            event.value = bits & CODEC_VALUE ? get_coin_varint(tail, end) : 0;
+        }
+        return tail;
+    }
+    auto small = [](uint8_t byte) { return static_cast<int16_t>((byte >> 1) ^ -(byte & 1)); };
+    for (size_t i = 0; i < CODEC_BLOCK; i++) {
+        Event& event = out[i];
+        if (flag[i] & 0x1) {
+            event.actor_delta = small(*tail++);
+        }
+        if (flag[i] & 0x2) {
+            event.target_delta = small(*tail++);
+        }
+        if (flag[i] & 0x4) {
+            event.value = small(*tail++);
+        }
+    }
+    return tail;
+}
+#endif
+
+// Decodes count events from in (size bytes) and returns the number of bytes they used
+size_t decode_events(const uint8_t* in, size_t size, Event* out, size_t count, bool simd = true) {
+    const uint8_t* start = in;
+    const uint8_t* end = in + size;
+    for (size_t first = 0; first < count; first += CODEC_BLOCK) {
+        size_t n = std::min(CODEC_BLOCK, count - first);
+        const uint8_t* next = nullptr;
+#ifdef __SSE2__
+        if (simd && n == CODEC_BLOCK) {
+            next = decode_block_sse2(in, end, out + first);
+        }
+#else
+        (void)simd;
+#endif
+        in = next ? next : decode_block_scalar(in, end, out + first, n);
+    }
+    return static_cast<size_t>(in - start);
+}
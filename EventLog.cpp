@@ -0,0 +1,209 @@
+#pragma once
+#include "Action.cpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Bounded log of game events.
+ * Each event is a fixed 10-byte record of what an action did (who, to whom, and the
+ * coins it moved), kept in a power-of-two ring buffer: appending is one store and an
+ * increment, and once the ring is full the oldest events are overwritten.
+ * Nothing is formatted when an event is logged; format_event() builds the text for a
+ * row only when a UI actually shows it.
+ */
+
+struct Event {
+    ActionType action;   // ActionType::None marks the start of a game
+    uint8_t actor;       // seat that acted
+    uint8_t target;      // seat acted on, or NO_TARGET
+    uint8_t next;        // seat whose turn it is after a NextTurn, otherwise NO_TARGET
+    int16_t actor_delta; // coins gained (or, if negative, paid) by the actor
+    int16_t target_delta;
+    int16_t value;       // coins seen by ViewCoins; player count for a game start
+
+    bool operator==(const Event&) const = default;
+};
+
+class EventLog {
+private:
+    std::vector<Event> ring;
+    uint64_t mask;
+    uint64_t total;
+
+public:
+    // The capacity is rounded up to a power of two
+    explicit EventLog(size_t capacity = 1024) : mask(0), total(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        ring.resize(size);
+        mask = size - 1;
+    }
+
+    void append(const Event& event) {
+        ring[total & mask] = event;
+        total++;
+    }
+
+    size_t capacity() const { return ring.size(); }
+    size_t size() const { return total < ring.size() ? static_cast<size_t>(total) : ring.size(); }
+    bool empty() const { return total == 0; }
+
+    // Events are numbered from 0 in the order they were logged; [first(), end()) are still held
+    uint64_t first() const { return total - size(); }
+    uint64_t end() const { return total; }
+
+    const Event& at(uint64_t sequence) const {
+        if (sequence < first() || sequence >= total) {
+            throw std::out_of_range("Event is no longer in the log");
+        }
+        return ring[sequence & mask];
+    }
+
+    void clear() { total = 0; }
+};
+
+Event game_started_event(const Game& game) {
+    return Event{ActionType::None, NO_TARGET, NO_TARGET, NO_TARGET, 0, 0, static_cast<int16_t>(game.player_count())};
+}
+
+// Runs an action through perform() and describes what it did
+Event perform_event(Game& game, const Action& action) {
+    Player* actor = action.actor < game.player_count() ? game.get_player(action.actor) : nullptr;
+    Player* target = action_has_target(action.type) && action.target < game.player_count()
+                         ? game.get_player(action.target) : nullptr;
+    int actor_before = actor ? actor->get_coins() : 0;
+    int target_before = target ? target->get_coins() : 0;
+
+    int seen = perform(game, action);
+
+    Event event{action.type, action.actor, target ? action.target : NO_TARGET, NO_TARGET, 0, 0, 0};
+    event.actor_delta = static_cast<int16_t>(actor->get_coins() - actor_before);
+    event.target_delta = static_cast<int16_t>(target ? target->get_coins() - target_before : 0);
+    if (action.type == ActionType::ViewCoins) {
+        event.value = static_cast<int16_t>(seen);
+    }
+    if (action.type == ActionType::NextTurn) {
+        event.next = static_cast<uint8_t>(game.get_current_index());
+    }
+    return event;
+}
+
+// An event from a player-addressed action, with the players it names; on tables too
+// large for seat numbers its line is formatted from these rather than from the seats
+struct PlayerEvent {
+    Event event;
+    const Player* actor;
+    const Player* target; // nullptr for actions without one
+    const Player* next;   // whose turn a NextTurn passed to, otherwise nullptr
+};
+
+// The player's seat if it fits the event's seat byte, otherwise NO_TARGET
+uint8_t event_seat(const Game& game, const Player* player) {
+    size_t seats = std::min<size_t>(game.player_count(), NO_TARGET);
+    for (size_t seat = 0; player && seat < seats; seat++) {
+        if (game.get_player(seat) == player) {
+            return static_cast<uint8_t>(seat);
+        }
+    }
+    return NO_TARGET;
+}
+
+// perform_event() for players given directly, for tables too large for seat numbers.
+// Seats past the seat byte are left as NO_TARGET in the event; the players are kept.
+PlayerEvent perform_event(Game& game, ActionType type, Player& actor, Player* target) {
+    if (!action_has_target(type)) {
+        target = nullptr;
+    }
+    int actor_before = actor.get_coins();
+    int target_before = target ? target->get_coins() : 0;
+
+    int seen = perform(game, type, actor, target);
+
+    PlayerEvent done{Event{type, event_seat(game, &actor), event_seat(game, target), NO_TARGET, 0, 0, 0},
+                     &actor, target, nullptr};
+    Event& event = done.event;
+    event.actor_delta = static_cast<int16_t>(actor.get_coins() - actor_before);
+    event.target_delta = static_cast<int16_t>(target ? target->get_coins() - target_before : 0);
+    if (type == ActionType::ViewCoins) {
+        event.value = static_cast<int16_t>(seen);
+    }
+    if (type == ActionType::NextTurn) {
+        done.next = game.get_current_player();
+        event.next = event_seat(game, done.next);
+    }
+    return done;
+}
+
+// One history line for an event whose players are given directly (nullptr for nobody);
+// next is whose turn a NextTurn passed to
+std::string format_event(const Event& event, const Player* actor_player, const Player* target_player,
+                         const Player* next_player) {
+    auto name = [](const Player* player) {
+        return player ? player->get_name() : std::string("?");
+    };
+    auto coins = [](int amount) {
+        return std::to_string(amount) + (amount == 1 ? " coin" : " coins");
+    };
+    std::string actor = name(actor_player);
+    std::string target = name(target_player);
+
+    switch (event.action) {
+        case ActionType::None:
+            return "Game started with " + std::to_string(event.value) + " players";
+        case ActionType::Gather:
+            return actor + " gathered " + coins(event.actor_delta);
+        case ActionType::Tax:
+            if (actor_player && actor_player->get_role() == "Governor") {
+                return actor + " (Governor) taxed " + coins(event.actor_delta);
+            }
+            return actor + " taxed " + coins(event.actor_delta);
+        case ActionType::Bribe:
+            return actor + " paid " + coins(-event.actor_delta) + " to bribe";
+        case ActionType::Arrest:
+            if (event.target_delta == 0) {
+                // A Merchant pays the bank instead of taking from the target
+                return actor + " arrested " + target + " and paid " + coins(-event.actor_delta) + " to the bank";
+            }
+            return actor + " arrested " + target + " and stole " + coins(-event.target_delta);
+        case ActionType::Sanction:
+            return actor + " sanctioned " + target;
+        case ActionType::Coup:
+            return actor + " performed a coup on " + target + " and eliminated them";
+        case ActionType::BlockTax:
+            return actor + " (Governor) blocked " + target + "'s tax action";
+        case ActionType::ViewCoins:
+            return actor + " (Spy) viewed that " + target + " has " + coins(event.value);
+        case ActionType::Invest:
+            return actor + " (Baron) invested " + coins(STANDARD_RULES.invest_cost) + " to get " +
+                   coins(STANDARD_RULES.invest_return);
+        case ActionType::Protect:
+            return actor + " (General) protected " + target + " from a coup";
+        case ActionType::BlockBribe:
+            return actor + " (Judge) blocked " + target + "'s bribe";
+        case ActionType::Bonus:
+            if (event.actor_delta == 0) {
+                return actor + " (Merchant) got no bonus";
+            }
+            return actor + " (Merchant) received a bonus of " + coins(event.actor_delta);
+        case ActionType::NextTurn:
+            return actor + "'s turn ended. Now " + name(next_player) + "'s turn.";
+        default:
+            return actor + " did something unknown";
+    }
+}
+
+// One history line for a player-addressed event
+std::string format_event(const PlayerEvent& done) {
+    return format_event(done.event, done.actor, done.target, done.next);
+}
+
+// One history line for an event; names are looked up in the game the event came from
+std::string format_event(const Event& event, const Game& game) {
+    auto player = [&](uint8_t seat) -> const Player* {
+        return seat < game.player_count() ? game.get_player(seat) : nullptr;
+    };
+    return format_event(event, player(event.actor), player(event.target), player(event.next));
+}
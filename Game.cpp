@@ -1,9 +1,25 @@
+#pragma once
 #include "PlayerRoles.cpp"
 #include <algorithm>
 
 // Implementation of Game methods
-Game::Game(const Game& other) : current_player_index(other.current_player_index), last_arrested(other.last_arrested) {
-    // Deep copy of players
+
+// Replaces the players with copies of other's, in the same state: coins, sanctions,
+// eliminations and arrests (which are mapped onto the copies)
+void Game::copy_players(const Game& other) {
+    for (auto player : players) {
+        delete player;
+    }
+    players.clear();
+
+    auto seat_in = [&](const Player* player) -> Player* {
+        for (size_t i = 0; i < other.players.size(); i++) {
+            if (other.players[i] == player) {
+                return players[i];
+            }
+        }
+        return nullptr;
+    };
     for (const auto& player : other.players) {
         Player* new_player = nullptr;
         
@@ -21,47 +37,27 @@ Game::Game(const Game& other) : current_player_index(other.current_player_index)
             new_player = new Merchant(player->get_name(), this);
         } else {
             new_player = new Player(*player);
-            new_player->set_game(this);
         }
+        // Copies the base state; the role's own class is kept
+        *new_player = *player;
+        new_player->set_game(this);
         
         players.push_back(new_player);
     }
+    for (size_t i = 0; i < players.size(); i++) {
+        players[i]->set_last_arrested(seat_in(other.players[i]->get_last_arrested()));
+    }
+    current_player_index = other.current_player_index;
+    last_arrested = seat_in(other.last_arrested);
+}
+
+Game::Game(const Game& other) : current_player_index(0), last_arrested(nullptr), listener(nullptr) {
+    copy_players(other);
 }
 
 Game& Game::operator=(const Game& other) {
     if (this != &other) {
-        // Clean up existing players
-        for (auto player : players) {
-            delete player;
-        }
-        players.clear();
-        
-        // Copy other game's players
-        for (const auto& player : other.players) {
-            Player* new_player = nullptr;
-            
-            if (player->get_role() == "Governor") {
-                new_player = new Governor(player->get_name(), this);
-            } else if (player->get_role() == "Spy") {
-                new_player = new Spy(player->get_name(), this);
-            } else if (player->get_role() == "Baron") {
-                new_player = new Baron(player->get_name(), this);
-            } else if (player->get_role() == "General") {
-                new_player = new General(player->get_name(), this);
-            } else if (player->get_role() == "Judge") {
-                new_player = new Judge(player->get_name(), this);
-            } else if (player->get_role() == "Merchant") {
-                new_player = new Merchant(player->get_name(), this);
-            } else {
-                new_player = new Player(*player);
-                new_player->set_game(this);
-            }
-            
-            players.push_back(new_player);
-        }
-        
-        current_player_index = other.current_player_index;
-        last_arrested = other.last_arrested;
+        copy_players(other);
     }
     return *this;
 }
@@ -122,7 +118,7 @@ void Game::next_turn() {
     // Reset sanction status of current player before moving to next
     players[current_player_index]->set_sanctioned(false);
     
-    // Special case: Merchant gets bonus coin at start of turn if they have 3+ coins
+    // Special case: Merchant gets a bonus at the end of the turn if they have enough coins
     if (players[current_player_index]->get_role() == "Merchant") {
         Merchant* merchant = dynamic_cast<Merchant*>(players[current_player_index]);
         if (merchant) {
@@ -140,14 +136,18 @@ void Game::next_turn() {
     }
     
     // Move to next active player
+    size_t previous = current_player_index;
     do {
         current_player_index = (current_player_index + 1) % players.size();
     } while (players[current_player_index]->is_eliminated());
+    if (listener && previous != current_player_index) {
+        listener->turn_changed(previous, current_player_index);
+    }
     
-    // Check if current player has 10+ coins - must perform coup
-    if (players[current_player_index]->get_coins() >= 10) {
+    // Check if current player has enough coins that they must perform a coup
+    if (players[current_player_index]->get_coins() >= STANDARD_RULES.forced_coup) {
         std::cout << players[current_player_index]->get_name() 
-                  << " has 10+ coins and must perform a coup!" << std::endl;
+                  << " has " << STANDARD_RULES.forced_coup << "+ coins and must perform a coup!" << std::endl;
     }
 }
 
@@ -0,0 +1,931 @@
+#pragma once
+#include "Protocol.cpp"
+#include "Actor.cpp"
+#include "Snapshot.cpp"
+#include "Seqlock.cpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+ * Multi-table game server.
+ * Hosts a fixed set of tables in one process and serves them over localhost TCP
+ * and/or a Unix socket, with one non-blocking epoll loop per I/O thread.
+ *
+ * Every table is an actor (Actor.cpp): I/O loops decode frames and post them to the
+ * table's mailbox, the scheduler runs the table on one worker at a time, and the reply
+ * frame is handed back to the originating loop through its own MPSC completion queue.
+ * Game objects are therefore never shared between threads and need no locks.
+ * After every change a table publishes its TableState through a seqlock, so any other
+ * thread (a Peek from an I/O loop, a stats collector) can read a consistent view of it
+ * without locking and without ever stalling the table.
+ *
+ * With a journal configured, every accepted action is appended to it before the reply
+ * is sent; it becomes durable within the journal's durability window. An action the
+ * journal cannot take is undone and refused. With a snapshot
+ * file configured, every table periodically records its state there from its own worker.
+ * On start-up the tables are rebuilt in parallel from the latest snapshot plus the
+ * journal events that came after it.
+ *
+ * Clients speak the binary protocol in Protocol.cpp: every action frame is answered
+ * with a state frame carrying only the seats that changed, or with an error frame.
+ * A table whose game ends is reset to a fresh six-player game and answered with a keyframe.
+ *
+ * Spectators subscribe to a table. The table encodes each state change once into a
+ * reference-counted SharedFrame and hands the same pointer to every I/O loop that has
+ * spectators of it; each loop queues that pointer on its spectators' connections and
+ * writes it straight from the shared buffer. A spectator that falls too far behind has
+ * its queued changes discarded and is sent a fresh keyframe instead.
+ */
+
+class SocketException : public std::runtime_error {
+public:
+    SocketException(const std::string& message)
+        : std::runtime_error(message + ": " + std::strerror(errno)) {}
+};
+
+inline void append_bytes(std::string& out, const uint8_t* data, size_t size) {
+    out.append(reinterpret_cast<const char*>(data), size);
+}
+
+// An encoded frame shared by every connection it is queued on; freed with the last reference
+struct SharedFrame {
+    uint32_t table;
+    bool broadcast; // false for a reply that had to queue behind broadcast frames
+    uint16_t size;
+    uint8_t data[MAX_FRAME_SIZE];
+};
+
+using SharedFramePtr = std::shared_ptr<const SharedFrame>;
+
+SharedFramePtr make_shared_frame(uint32_t table, bool broadcast, const uint8_t* data, size_t size) {
+    auto frame = std::make_shared<SharedFrame>();
+    frame->table = table;
+    frame->broadcast = broadcast;
+    frame->size = static_cast<uint16_t>(size);
+    std::memcpy(frame->data, data, size);
+    return frame;
+}
+
+// Receives reply frames for a connection; implemented by the I/O loop that owns it
+class ReplySink {
+public:
+    virtual ~ReplySink() {}
+    virtual void deliver(uint64_t connection, const uint8_t* frame, size_t size) = 0;
+    // A table's state change, for every spectator of that table on this sink
+    virtual void broadcast(const SharedFramePtr& frame) = 0;
+};
+
+// Gathers one snapshot record from every table, each taken on the table's own worker
+class SnapshotCollector {
+private:
+    std::vector<TableSnapshot> records;
+    uint64_t lsn = 0; // journal position of the newest event the records include
+    size_t remaining;
+    std::mutex lock;
+    std::condition_variable done;
+
+public:
+    explicit SnapshotCollector(size_t tables) : records(tables), remaining(tables) {}
+
+    void add(const TableSnapshot& snapshot, uint64_t last_lsn) {
+        std::lock_guard<std::mutex> guard(lock);
+        records[snapshot.table] = snapshot;
+        lsn = std::max(lsn, last_lsn);
+        if (--remaining == 0) {
+            done.notify_all();
+        }
+    }
+
+    const std::vector<TableSnapshot>& wait() {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [&] { return remaining == 0; });
+        return records;
+    }
+
+    // Valid once wait() has returned
+    uint64_t last_lsn() const { return lsn; }
+};
+
+// A client frame to run, or (when snapshot is set) a request to record the table's state
+struct TableRequest {
+    Frame frame;
+    ReplySink* sink;
+    uint64_t connection;
+    SnapshotCollector* snapshot;
+};
+
+// One hosted game, owned by whichever worker is currently running its actor
+class Table : public Actor<TableRequest> {
+private:
+    uint32_t id;
+    std::unique_ptr<Game> game;
+    Journal* journal;
+    uint32_t seq; // journal sequence number of the last event applied
+    uint64_t lsn; // journal position of the last event this process appended
+    // Sinks with spectators of this table, and how many each has
+    std::vector<std::pair<ReplySink*, uint32_t>> audience;
+    // Copy of the game's public state for readers on other threads
+    Seqlock<TableState> published;
+
+    // Appends an event to the journal. If the append fails, the game goes back to undo,
+    // its state before the event, so the table never holds a change the journal lacks.
+    void log(uint8_t action, uint8_t actor, uint8_t target, const TableSnapshot& undo) {
+        if (!journal) {
+            return;
+        }
+        try {
+            lsn = journal->append(id, action, actor, target, &seq);
+        } catch (const JournalException&) {
+            restore(undo);
+            throw;
+        }
+    }
+
+protected:
+    void receive(TableRequest& request) override {
+        if (request.snapshot) {
+            request.snapshot->add(snapshot(), lsn);
+            return;
+        }
+        if (request.frame.kind == FrameKind::Unsubscribe) {
+            unsubscribe(request.sink);
+            return;
+        }
+        if (request.frame.kind == FrameKind::Subscribe) {
+            subscribe(request.sink);
+        }
+        uint8_t reply[MAX_FRAME_SIZE];
+        size_t size = execute(request.frame, reply);
+        request.sink->deliver(request.connection, reply, size);
+    }
+
+public:
+    Table(Scheduler& scheduler, uint32_t id, Journal* journal = nullptr)
+        : Actor<TableRequest>(scheduler, id), id(id), journal(journal), seq(0), lsn(0) {
+        reset();
+    }
+
+    // Replaces the game with a fresh standard game
+    void reset() {
+        game = std::make_unique<Game>();
+        seat_standard_players(*game);
+        published.publish(capture_state(*game));
+    }
+
+    // Runs one decoded client frame and writes the reply frame; returns its size
+    size_t execute(const Frame& frame, uint8_t* reply) {
+        TableState before = capture_state(*game);
+        if (frame.kind == FrameKind::Sync || frame.kind == FrameKind::Subscribe) {
+            return encode_keyframe(reply, id, before);
+        }
+        if (frame.kind != FrameKind::Action) {
+            return encode_error(reply, id, ErrorCode::Malformed, before.current);
+        }
+        try {
+            TableSnapshot undo{};
+            if (journal) {
+                undo = snapshot();
+            }
+            perform(*game, frame.action);
+            log(static_cast<uint8_t>(frame.action.type), frame.action.actor, frame.action.target, undo);
+            bool ended = game->is_game_over();
+            if (ended) {
+                if (journal) {
+                    undo = snapshot();
+                }
+                reset();
+                log(JOURNAL_RESET, 0, NO_TARGET, undo);
+            }
+            TableState after = capture_state(*game);
+            published.publish(after);
+            size_t size = encode_state(reply, id, before, after, ended);
+            if (!audience.empty()) {
+                // Encoded once; every sink gets the same buffer
+                SharedFramePtr shared = make_shared_frame(id, true, reply, size);
+                for (auto& entry : audience) {
+                    entry.first->broadcast(shared);
+                }
+            }
+            return size;
+        } catch (const std::exception& e) {
+            return encode_error(reply, id, error_code_for(e), before.current);
+        }
+    }
+
+    void subscribe(ReplySink* sink) {
+        for (auto& entry : audience) {
+            if (entry.first == sink) {
+                entry.second++;
+                return;
+            }
+        }
+        audience.emplace_back(sink, 1);
+    }
+
+    void unsubscribe(ReplySink* sink) {
+        for (auto it = audience.begin(); it != audience.end(); ++it) {
+            if (it->first == sink) {
+                if (--it->second == 0) {
+                    audience.erase(it);
+                }
+                return;
+            }
+        }
+    }
+
+    // Re-applies a journalled event during recovery
+    void replay(const JournalRecord& record) {
+        seq = record.seq;
+        if (record.action == JOURNAL_RESET) {
+            reset();
+            return;
+        }
+        perform(*game, Action{static_cast<ActionType>(record.action), record.actor, record.target});
+        published.publish(capture_state(*game));
+    }
+
+    TableSnapshot snapshot() const {
+        return snapshot_game(*game, id, seq);
+    }
+
+    void restore(const TableSnapshot& snapshot) {
+        game = std::make_unique<Game>();
+        restore_game(*game, snapshot);
+        seq = snapshot.seq;
+        published.publish(capture_state(*game));
+    }
+
+    const Game& get_game() const { return *game; }
+    uint32_t get_seq() const { return seq; }
+
+    // Lock-free and safe from any thread: the state after the last completed change
+    TableState view() const { return published.read(); }
+};
+
+class TableRegistry {
+private:
+    std::vector<std::unique_ptr<Table>> tables;
+    Journal* journal;
+
+public:
+    TableRegistry(Scheduler& scheduler, size_t count, Journal* journal = nullptr) : journal(journal) {
+        tables.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            tables.push_back(std::make_unique<Table>(scheduler, static_cast<uint32_t>(i), journal));
+        }
+    }
+
+    // Rebuilds every table from the snapshot (if the file exists) plus the journal events
+    // after it, one table per task on up to threads threads. Either path may be empty.
+    // Returns the number of journal events replayed. The live journal, if any, then
+    // numbers each table's events on from its recovered state.
+    size_t recover(const std::string& snapshot_path, const std::string& journal_path, size_t threads) {
+        std::vector<const TableSnapshot*> snapshot_of(tables.size(), nullptr);
+        std::vector<uint32_t> snapshot_seq(tables.size(), 0);
+        std::vector<TableSnapshot> snapshots;
+        if (!snapshot_path.empty() && access(snapshot_path.c_str(), F_OK) == 0) {
+            snapshots = read_snapshot_file(snapshot_path);
+            for (const auto& snapshot : snapshots) {
+                if (snapshot.table >= tables.size()) {
+                    throw JournalException("Snapshot references unknown table " + std::to_string(snapshot.table));
+                }
+                snapshot_of[snapshot.table] = &snapshot;
+                snapshot_seq[snapshot.table] = snapshot.seq;
+            }
+        }
+
+        std::vector<std::vector<JournalRecord>> tails(tables.size());
+        if (!journal_path.empty()) {
+            tails = journal_tails(journal_path, tables.size(), snapshot_seq);
+        }
+
+        std::atomic<size_t> applied(0);
+        parallel_for(tables.size(), threads, [&](size_t i) {
+            if (snapshot_of[i]) {
+                tables[i]->restore(*snapshot_of[i]);
+            }
+            for (const auto& record : tails[i]) {
+                tables[i]->replay(record);
+            }
+            applied += tails[i].size();
+        });
+        if (journal) {
+            for (size_t i = 0; i < tables.size(); i++) {
+                journal->continue_from(static_cast<uint32_t>(i), tables[i]->get_seq());
+            }
+        }
+        return applied;
+    }
+
+    // Asks every table for its state and writes them all to path. The events the states
+    // include are made durable first: a snapshot must never be ahead of the journal.
+    void snapshot(const std::string& path) {
+        SnapshotCollector collector(tables.size());
+        for (auto& table : tables) {
+            table->post(TableRequest{Frame{}, nullptr, 0, &collector});
+        }
+        const std::vector<TableSnapshot>& records = collector.wait();
+        if (journal) {
+            journal->wait_durable(collector.last_lsn());
+        }
+        write_snapshot_file(path, records);
+    }
+
+    size_t size() const { return tables.size(); }
+
+    Table* find(uint32_t id) const {
+        return id < tables.size() ? tables[id].get() : nullptr;
+    }
+};
+
+// Non-blocking TCP listener on 127.0.0.1; SO_REUSEPORT lets every loop own one
+int listen_tcp(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        throw SocketException("socket");
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        throw SocketException("bind/listen on port " + std::to_string(port));
+    }
+    return fd;
+}
+
+int listen_unix(const std::string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        throw SocketException("socket");
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        close(fd);
+        throw std::invalid_argument("Unix socket path too long");
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        close(fd);
+        throw SocketException("bind/listen on " + path);
+    }
+    return fd;
+}
+
+struct ServerConfig {
+    uint16_t port = 7777;
+    std::string unix_path;
+    size_t threads = 1;
+    size_t workers = 1;
+    size_t tables = 4096;
+    std::string journal_path;
+    std::chrono::microseconds durability_window{2000};
+    std::string snapshot_path;
+    std::chrono::seconds snapshot_interval{0};
+};
+
+// One epoll loop: owns its TCP listener, shares the Unix listener, and all accepted connections.
+// Connections are keyed by a never-reused id so late replies cannot reach a recycled fd.
+class EventLoop : public ReplySink {
+private:
+    struct Connection {
+        int fd;
+        std::string in;
+        std::string out;
+        bool want_write = false;
+        // Shared frames queued behind out, and how much of the first one is already sent
+        std::deque<SharedFramePtr> feed;
+        size_t feed_offset = 0;
+        // Spectated tables; false while waiting for the keyframe that (re)starts the feed
+        std::unordered_map<uint32_t, bool> watching;
+    };
+
+    struct Completion {
+        uint64_t connection;
+        SharedFramePtr shared; // set for a broadcast to every spectator of its table
+        uint8_t size;
+        uint8_t frame[MAX_FRAME_SIZE];
+    };
+
+    static const uint64_t WAKE_ID = 0;
+    static const uint64_t TCP_ID = 1;
+    static const uint64_t UNIX_ID = 2;
+    // Queued frames beyond which a spectator is considered lagging
+    static const size_t SPECTATOR_BACKLOG = 256;
+
+    TableRegistry& registry;
+    int epoll_fd;
+    int wake_fd;
+    int tcp_fd;
+    int unix_fd;
+    uint64_t next_id;
+    std::unordered_map<uint64_t, Connection> connections;
+    std::unordered_map<uint32_t, std::vector<uint64_t>> spectators;
+    MpscQueue<Completion> completions;
+    std::atomic<bool> wake_pending;
+    std::atomic<bool> running;
+
+    void watch(int fd, uint64_t id, uint32_t events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = id;
+        if (epoll_ctl(epoll_fd, op, fd, &ev) < 0) {
+            throw SocketException("epoll_ctl");
+        }
+    }
+
+    void accept_all(int listen_fd) {
+        while (true) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) {
+                return; // EAGAIN, or another loop won the race
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            uint64_t id = next_id++;
+            connections[id].fd = fd;
+            watch(fd, id, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+        }
+    }
+
+    // Sends a table-only request (Sync, Subscribe, Unsubscribe) to a table on behalf of a connection
+    void post_to_table(uint32_t table, FrameKind kind, uint64_t id) {
+        Frame frame{};
+        frame.kind = kind;
+        frame.length = SYNC_FRAME_SIZE;
+        frame.table = table;
+        if (Table* target = registry.find(table)) {
+            target->post(TableRequest{frame, this, id, nullptr});
+        }
+    }
+
+    void unwatch(uint64_t id, uint32_t table) {
+        auto list = spectators.find(table);
+        list->second.erase(std::find(list->second.begin(), list->second.end(), id));
+        if (list->second.empty()) {
+            spectators.erase(list);
+        }
+        post_to_table(table, FrameKind::Unsubscribe, id);
+    }
+
+    // Subscriptions are listed here for fan-out and counted by the table for publishing
+    void spectate(uint64_t id, Connection& conn, const Frame& frame) {
+        auto watched = conn.watching.find(frame.table);
+        if (frame.kind == FrameKind::Unsubscribe) {
+            if (watched != conn.watching.end()) {
+                conn.watching.erase(watched);
+                unwatch(id, frame.table);
+            }
+        } else if (watched != conn.watching.end()) {
+            watched->second = false;
+            post_to_table(frame.table, FrameKind::Sync, id);
+        } else {
+            conn.watching[frame.table] = false;
+            spectators[frame.table].push_back(id);
+            post_to_table(frame.table, FrameKind::Subscribe, id);
+        }
+    }
+
+    // The client is not reading fast enough: discard its queued broadcasts and
+    // resynchronize every table it watches with a keyframe instead
+    void fall_behind(uint64_t id, Connection& conn) {
+        std::deque<SharedFramePtr> kept;
+        for (size_t i = 0; i < conn.feed.size(); i++) {
+            if ((i == 0 && conn.feed_offset > 0) || !conn.feed[i]->broadcast) {
+                kept.push_back(std::move(conn.feed[i]));
+            }
+        }
+        conn.feed.swap(kept);
+        for (auto& watched : conn.watching) {
+            if (watched.second) {
+                watched.second = false;
+                post_to_table(watched.first, FrameKind::Sync, id);
+            }
+        }
+    }
+
+    void drop(uint64_t id) {
+        auto it = connections.find(id);
+        for (const auto& watched : it->second.watching) {
+            unwatch(id, watched.first);
+        }
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        close(it->second.fd);
+        connections.erase(it);
+    }
+
+    // Returns false if the connection was closed
+    bool flush(uint64_t id, Connection& conn) {
+        size_t sent = 0;
+        while (sent < conn.out.size()) {
+            ssize_t n = send(conn.fd, conn.out.data() + sent, conn.out.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                drop(id);
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        conn.out.erase(0, sent);
+        if (conn.out.empty() && !send_feed(conn)) {
+            drop(id);
+            return false;
+        }
+
+        bool want_write = !conn.out.empty() || !conn.feed.empty();
+        if (want_write != conn.want_write) {
+            conn.want_write = want_write;
+            watch(conn.fd, id, EPOLLIN | EPOLLRDHUP | (want_write ? EPOLLOUT : 0u), EPOLL_CTL_MOD);
+        }
+        return true;
+    }
+
+    // Replies must not overtake broadcasts already queued for the connection
+    static void queue_reply(Connection& conn, uint32_t table, const uint8_t* frame, size_t size) {
+        if (conn.feed.empty()) {
+            append_bytes(conn.out, frame, size);
+        } else {
+            conn.feed.push_back(make_shared_frame(table, false, frame, size));
+        }
+    }
+
+    // Writes queued shared frames straight from their buffers; false on a socket error
+    bool send_feed(Connection& conn) {
+        while (!conn.feed.empty()) {
+            iovec parts[64];
+            size_t count = 0;
+            size_t wanted = 0;
+            for (auto it = conn.feed.begin(); it != conn.feed.end() && count < 64; ++it, ++count) {
+                size_t skip = count == 0 ? conn.feed_offset : 0;
+                parts[count].iov_base = const_cast<uint8_t*>((*it)->data + skip);
+                parts[count].iov_len = (*it)->size - skip;
+                wanted += parts[count].iov_len;
+            }
+            msghdr message{};
+            message.msg_iov = parts;
+            message.msg_iovlen = count;
+            ssize_t n = sendmsg(conn.fd, &message, MSG_NOSIGNAL);
+            if (n < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            size_t left = static_cast<size_t>(n);
+            while (left > 0) {
+                size_t remaining = conn.feed.front()->size - conn.feed_offset;
+                if (left < remaining) {
+                    conn.feed_offset += left;
+                    break;
+                }
+                left -= remaining;
+                conn.feed.pop_front();
+                conn.feed_offset = 0;
+            }
+            if (static_cast<size_t>(n) < wanted) {
+                return true; // socket buffer is full
+            }
+        }
+        return true;
+    }
+
+    void on_readable(uint64_t id, Connection& conn) {
+        char buffer[16384];
+        while (true) {
+            ssize_t n = recv(conn.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                conn.in.append(buffer, static_cast<size_t>(n));
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                drop(id);
+                return;
+            }
+            break;
+        }
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(conn.in.data());
+        size_t start = 0;
+        Frame frame;
+        while (true) {
+            DecodeStatus status = decode_frame(data + start, conn.in.size() - start, frame);
+            if (status == DecodeStatus::Incomplete) {
+                break;
+            }
+            if (status != DecodeStatus::Ok) {
+                // The stream cannot be resynchronized after a bad frame
+                uint8_t reply[ERROR_FRAME_SIZE];
+                queue_reply(conn, 0, reply, encode_error(reply, 0, ErrorCode::Malformed, 0));
+                if (flush(id, conn)) {
+                    drop(id);
+                }
+                return;
+            }
+            Table* table = registry.find(frame.table);
+            if (table && (frame.kind == FrameKind::Subscribe || frame.kind == FrameKind::Unsubscribe)) {
+                spectate(id, conn, frame);
+            } else if (table && frame.kind == FrameKind::Peek) {
+                // Answered here from the published state without waiting for the table
+                uint8_t reply[MAX_FRAME_SIZE];
+                queue_reply(conn, frame.table, reply, encode_keyframe(reply, frame.table, table->view()));
+            } else if (table) {
+                table->post(TableRequest{frame, this, id, nullptr});
+            } else {
+                uint8_t reply[ERROR_FRAME_SIZE];
+                queue_reply(conn, frame.table, reply, encode_error(reply, frame.table, ErrorCode::UnknownTable, 0));
+            }
+            start += frame.length;
+        }
+        conn.in.erase(0, start);
+        flush(id, conn);
+    }
+
+    // Moves finished replies from the workers onto their connections
+    void drain_completions() {
+        uint64_t value;
+        ssize_t ignored = read(wake_fd, &value, sizeof(value));
+        (void)ignored;
+        wake_pending.store(false, std::memory_order_seq_cst);
+
+        std::vector<uint64_t> touched;
+        Completion completion;
+        while (completions.pop(completion)) {
+            if (completion.shared) {
+                fan_out(completion.shared, touched);
+                completion.shared.reset();
+                continue;
+            }
+            auto it = connections.find(completion.connection);
+            if (it == connections.end()) {
+                continue; // connection closed while the table was working
+            }
+            Connection& conn = it->second;
+            if (conn.out.empty() && conn.feed.empty()) {
+                touched.push_back(completion.connection);
+            }
+            uint32_t table = get_u32(completion.frame + 4);
+            if (is_keyframe(completion.frame)) {
+                auto watched = conn.watching.find(table);
+                if (watched != conn.watching.end()) {
+                    watched->second = true;
+                }
+            }
+            queue_reply(conn, table, completion.frame, completion.size);
+        }
+        for (uint64_t id : touched) {
+            auto it = connections.find(id);
+            if (it != connections.end()) {
+                flush(id, it->second);
+            }
+        }
+    }
+
+    static bool is_keyframe(const uint8_t* frame) {
+        return frame[1] == static_cast<uint8_t>(FrameKind::State) && (frame[9] & STATE_KEYFRAME);
+    }
+
+    // Queues one shared frame on every spectator of its table: a pointer per connection
+    void fan_out(const SharedFramePtr& frame, std::vector<uint64_t>& touched) {
+        auto list = spectators.find(frame->table);
+        if (list == spectators.end()) {
+            return;
+        }
+        bool keyframe = is_keyframe(frame->data);
+        for (uint64_t id : list->second) {
+            Connection& conn = connections.find(id)->second;
+            bool& synced = conn.watching.find(frame->table)->second;
+            if (!synced && !keyframe) {
+                continue; // its keyframe is still on the way
+            }
+            if (conn.feed.size() >= SPECTATOR_BACKLOG) {
+                fall_behind(id, conn);
+                continue;
+            }
+            synced = true;
+            if (conn.out.empty() && conn.feed.empty()) {
+                touched.push_back(id);
+            }
+            conn.feed.push_back(frame);
+        }
+    }
+
+    void signal() {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+public:
+    EventLoop(TableRegistry& registry, const ServerConfig& config, int shared_unix_fd)
+        : registry(registry), epoll_fd(epoll_create1(0)), wake_fd(eventfd(0, EFD_NONBLOCK)),
+          tcp_fd(-1), unix_fd(shared_unix_fd), next_id(UNIX_ID + 1), wake_pending(false), running(true) {
+        if (epoll_fd < 0 || wake_fd < 0) {
+            throw SocketException("epoll_create1/eventfd");
+        }
+        watch(wake_fd, WAKE_ID, EPOLLIN, EPOLL_CTL_ADD);
+        if (config.port != 0) {
+            tcp_fd = listen_tcp(config.port);
+            watch(tcp_fd, TCP_ID, EPOLLIN, EPOLL_CTL_ADD);
+        }
+        if (unix_fd >= 0) {
+            watch(unix_fd, UNIX_ID, EPOLLIN | EPOLLEXCLUSIVE, EPOLL_CTL_ADD);
+        }
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    ~EventLoop() {
+        for (auto& entry : connections) {
+            close(entry.second.fd);
+        }
+        if (tcp_fd >= 0) {
+            close(tcp_fd);
+        }
+        close(wake_fd);
+        close(epoll_fd);
+    }
+
+    void run() {
+        epoll_event events[256];
+        while (running.load(std::memory_order_relaxed)) {
+            int count = epoll_wait(epoll_fd, events, 256, -1);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw SocketException("epoll_wait");
+            }
+            for (int i = 0; i < count; i++) {
+                uint64_t id = events[i].data.u64;
+                if (id == WAKE_ID) {
+                    drain_completions();
+                    continue;
+                }
+                if (id == TCP_ID || id == UNIX_ID) {
+                    accept_all(id == TCP_ID ? tcp_fd : unix_fd);
+                    continue;
+                }
+                auto it = connections.find(id);
+                if (it == connections.end()) {
+                    continue;
+                }
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    drop(id);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    if (!flush(id, it->second)) {
+                        continue;
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                    on_readable(id, it->second);
+                }
+            }
+        }
+    }
+
+    // Called by table workers; wakes the loop at most once per drain
+    void deliver(uint64_t connection, const uint8_t* frame, size_t size) override {
+        Completion completion;
+        completion.connection = connection;
+        completion.size = static_cast<uint8_t>(size);
+        std::memcpy(completion.frame, frame, size);
+        completions.push(std::move(completion));
+        if (!wake_pending.exchange(true, std::memory_order_seq_cst)) {
+            signal();
+        }
+    }
+
+    void broadcast(const SharedFramePtr& frame) override {
+        Completion completion{};
+        completion.shared = frame;
+        completions.push(std::move(completion));
+        if (!wake_pending.exchange(true, std::memory_order_seq_cst)) {
+            signal();
+        }
+    }
+
+    void stop() {
+        running.store(false, std::memory_order_relaxed);
+        signal();
+    }
+};
+
+class GameServer {
+private:
+    ServerConfig config;
+    Scheduler scheduler;
+    std::unique_ptr<Journal> journal;
+    TableRegistry registry;
+    int unix_fd;
+    size_t recovered;
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    std::vector<std::thread> threads;
+    std::thread snapshotter;
+    std::mutex snapshot_lock;
+    std::condition_variable snapshot_wake;
+    bool stopping = false;
+
+    void snapshot_loop() {
+        std::unique_lock<std::mutex> guard(snapshot_lock);
+        while (!snapshot_wake.wait_for(guard, config.snapshot_interval, [&] { return stopping; })) {
+            guard.unlock();
+            try {
+                registry.snapshot(config.snapshot_path);
+            } catch (const std::exception& e) {
+                std::cerr << "Snapshot failed: " << e.what() << std::endl;
+            }
+            guard.lock();
+        }
+    }
+
+    static std::unique_ptr<Journal> open_journal(const ServerConfig& config) {
+        if (config.journal_path.empty()) {
+            return nullptr;
+        }
+        JournalConfig journal_config;
+        journal_config.path = config.journal_path;
+        journal_config.durability_window = config.durability_window;
+        return std::make_unique<Journal>(journal_config);
+    }
+
+public:
+    explicit GameServer(const ServerConfig& config)
+        : config(config), scheduler(config.workers), journal(open_journal(config)),
+          registry(scheduler, config.tables, journal.get()), unix_fd(-1), recovered(0) {
+        recovered = registry.recover(config.snapshot_path, config.journal_path, config.workers);
+        if (!config.unix_path.empty()) {
+            unix_fd = listen_unix(config.unix_path);
+        }
+        for (size_t i = 0; i < std::max<size_t>(1, config.threads); i++) {
+            loops.push_back(std::make_unique<EventLoop>(registry, config, unix_fd));
+        }
+    }
+
+    GameServer(const GameServer&) = delete;
+    GameServer& operator=(const GameServer&) = delete;
+
+    ~GameServer() {
+        stop();
+        scheduler.stop();
+        if (unix_fd >= 0) {
+            close(unix_fd);
+            unlink(config.unix_path.c_str());
+        }
+    }
+
+    void start() {
+        for (auto& loop : loops) {
+            EventLoop* raw = loop.get();
+            threads.emplace_back([raw] { raw->run(); });
+        }
+        if (!config.snapshot_path.empty() && config.snapshot_interval.count() > 0) {
+            snapshotter = std::thread([this] { snapshot_loop(); });
+        }
+    }
+
+    void stop() {
+        if (snapshotter.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(snapshot_lock);
+                stopping = true;
+            }
+            snapshot_wake.notify_all();
+            snapshotter.join();
+        }
+        for (auto& loop : loops) {
+            loop->stop();
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    size_t table_count() const { return registry.size(); }
+
+    // Consistent view of one table, readable from any thread while the server runs
+    TableState table_view(uint32_t table) const { return registry.find(table)->view(); }
+    size_t recovered_events() const { return recovered; }
+};
@@ -0,0 +1,165 @@
+#define SIMPLIFIED_GUI_NO_MAIN
+#include "SimplifiedGUI.cpp"
+#include <sys/resource.h>
+#include <cstdlib>
+
+/*
+ * Offscreen GUI responsiveness benchmark.
+ * Starts GameWindow on Qt's offscreen platform and plays a scripted game through the
+ * entry points a person uses: it picks an action and a target in the ActionPanel and
+ * calls executeAction(), and every fifth turn passes with GameWindow::nextTurn(). Each
+ * call is timed until the window has taken in the result and painted it; the report
+ * gives p50/p99/max for both and the process's peak memory. Dialogs the game raises are
+ * closed as soon as they open, and counted. When a game ends a new window takes over.
+ * Usage: ./guibench [--actions N] [--players N]
+ */
+
+// Calls that take longer than this to show their result are counted as stalls
+const qint64 STALL_MS = 250;
+
+double percentile(std::vector<double>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+// Peak resident set size so far, in KiB
+long peak_kib() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Sets up the panel for the current player's move: coup once the window insists, bribe
+// once a coup is affordable so nobody gets there often, otherwise gather, tax or arrest
+// someone with coins. Returns false on turns the script passes with Next Turn instead.
+bool choose_move(GameWindow& window, size_t turn) {
+    if (turn % 5 == 4) {
+        return false;
+    }
+    const Game& game = *window.getGame();
+    const Player* player = game.get_current_player();
+    ActionPanel* panel = window.getActionPanel();
+    QComboBox* selector = panel->findChild<QComboBox*>("playerSelector");
+    TargetFilter* targets = dynamic_cast<TargetFilter*>(selector->model());
+
+    // A merchant's arrest pays the pot instead
+    int arrest_cost = player->get_role() == "Merchant" ? STANDARD_RULES.merchant_arrest_cost
+                                                       : STANDARD_RULES.arrest_steal;
+    const char* button = turn % 3 == 1 ? "taxAction" : "gatherAction";
+    int target = -1;
+    if (player->get_coins() >= STANDARD_RULES.forced_coup) {
+        button = "coupAction";
+        target = 0;
+    } else if (player->get_coins() >= STANDARD_RULES.coup_cost) {
+        button = "bribeAction";
+    } else if (turn % 3 == 2 && player->get_coins() >= arrest_cost) {
+        for (int row = 0; row < targets->rowCount(); row++) {
+            const Player* candidate = game.get_player(targets->seatAt(row));
+            if (candidate->get_coins() > 0 && candidate != game.get_last_arrested()) {
+                button = "arrestAction";
+                target = row;
+                break;
+            }
+        }
+    }
+    panel->findChild<QRadioButton*>(button)->setChecked(true);
+    if (target >= 0) {
+        selector->setCurrentIndex(target);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t actions = 2000;
+    size_t players = ROLE_COUNT;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--actions") {
+            actions = std::stoul(value);
+        } else if (flag == "--players") {
+            players = std::clamp<size_t>(std::stoul(value), 2, MAX_PLAYERS);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Headless unless the caller picked a platform
+    setenv("QT_QPA_PLATFORM", "offscreen", 0);
+    QApplication app(argc, argv);
+
+    // Game::next_turn() announces players who must coup; keep that off the results
+    std::ostream report(std::cout.rdbuf());
+    std::cout.setstate(std::ios_base::badbit);
+
+    // Modal dialogs run their own event loop, where this timer still fires
+    size_t dialogs = 0;
+    QTimer closer;
+    QObject::connect(&closer, &QTimer::timeout, [&] {
+        if (QWidget* dialog = QApplication::activeModalWidget()) {
+            dialog->close();
+            dialogs++;
+        }
+    });
+    closer.start(1);
+
+    long before = peak_kib();
+    std::unique_ptr<GameWindow> window;
+    size_t games = 0;
+    size_t stalls = 0;
+    std::vector<double> executed;
+    std::vector<double> passed;
+    for (size_t i = 0; i < actions; i++) {
+        if (!window || window->getGame()->is_game_over()) {
+            window = std::make_unique<GameWindow>(players);
+            window->show();
+            QApplication::processEvents();
+            games++;
+        }
+        const Game& game = *window->getGame();
+        size_t seat = game.get_current_index();
+        bool act = choose_move(*window, i);
+
+        QElapsedTimer timer;
+        timer.start();
+        if (act) {
+            window->getActionPanel()->executeAction();
+        } else {
+            window->nextTurn();
+        }
+        // The engine answers on its own thread; take in its updates until the turn passes
+        while (game.get_current_index() == seat && !game.is_game_over() && timer.elapsed() < STALL_MS) {
+            window->nextFrame();
+            QApplication::processEvents();
+        }
+        // Paint what changed
+        QApplication::processEvents();
+        double elapsed = static_cast<double>(timer.nsecsElapsed()) / 1000.0;
+
+        if (game.get_current_index() == seat && !game.is_game_over()) {
+            stalls++;
+        } else {
+            (act ? executed : passed).push_back(elapsed);
+        }
+    }
+
+    report << actions << " calls over " << games << " games of " << players << " players, " << dialogs
+           << " dialogs closed, " << stalls << " stalled" << std::endl;
+    report << "executeAction: p50 " << percentile(executed, 0.5) << " us, p99 " << percentile(executed, 0.99)
+           << " us, max " << percentile(executed, 1.0) << " us (" << executed.size() << " calls)" << std::endl;
+    report << "nextTurn:      p50 " << percentile(passed, 0.5) << " us, p99 " << percentile(passed, 0.99)
+           << " us, max " << percentile(passed, 1.0) << " us (" << passed.size() << " calls)" << std::endl;
+    report << "peak RSS: " << peak_kib() / 1024 << " MiB (" << before / 1024 << " MiB before the first window)"
+           << std::endl;
+    return stalls == 0 ? 0 : 1;
+}
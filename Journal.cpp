@@ -0,0 +1,326 @@
+#pragma once
+#include "Action.cpp"
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * Append-only event journal shared by every table in a process.
+ * Records are fixed 16-byte binary events:
+ *   table u32 | seq u32 | action u8 | actor u8 | target u8 | reserved u8 | crc32 u32
+ * seq counts events per table starting at 1; action JOURNAL_RESET marks a table
+ * starting a fresh game.
+ *
+ * append() only queues the record. A writer thread commits queued records in groups:
+ * one write() and one fdatasync() per durability window, so a crash loses at most the
+ * events of the last window. Callers that need an event on disk use wait_durable().
+ * If a write or fsync fails the writer stops: nothing after the failure is counted as
+ * durable, and append() and wait_durable() throw the error from then on.
+ * On open, a torn or corrupt tail left by a crash is truncated away.
+ */
+
+const char JOURNAL_MAGIC[4] = {'C', 'P', 'J', '1'};
+const size_t JOURNAL_HEADER_SIZE = 8;
+const size_t JOURNAL_RECORD_SIZE = 16;
+const uint8_t JOURNAL_RESET = 0;
+
+class JournalException : public std::runtime_error {
+public:
+    JournalException(const std::string& message) : std::runtime_error(message) {}
+};
+
+struct JournalRecord {
+    uint32_t table;
+    uint32_t seq;
+    uint8_t action;
+    uint8_t actor;
+    uint8_t target;
+};
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void encode_record(uint8_t* out, const JournalRecord& record) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(record.table >> (8 * i));
+        out[4 + i] = static_cast<uint8_t>(record.seq >> (8 * i));
+    }
+    out[8] = record.action;
+    out[9] = record.actor;
+    out[10] = record.target;
+    out[11] = 0;
+    uint32_t crc = crc32(out, 12);
+    for (int i = 0; i < 4; i++) {
+        out[12 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+}
+
+// Returns false if the record's checksum does not match
+bool decode_record(const uint8_t* in, JournalRecord& record) {
+    uint32_t stored = 0;
+    for (int i = 0; i < 4; i++) {
+        stored |= static_cast<uint32_t>(in[12 + i]) << (8 * i);
+    }
+    if (stored != crc32(in, 12) || in[11] != 0) {
+        return false;
+    }
+    record.table = 0;
+    record.seq = 0;
+    for (int i = 0; i < 4; i++) {
+        record.table |= static_cast<uint32_t>(in[i]) << (8 * i);
+        record.seq |= static_cast<uint32_t>(in[4 + i]) << (8 * i);
+    }
+    record.action = in[8];
+    record.actor = in[9];
+    record.target = in[10];
+    return true;
+}
+
+// Reads every intact record in order and returns the byte length of the valid prefix.
+// Reading stops at the first torn or corrupt record.
+size_t replay_journal(const std::string& path, const std::function<void(const JournalRecord&)>& visit) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw JournalException("Cannot open journal " + path);
+    }
+    char header[JOURNAL_HEADER_SIZE];
+    if (read(fd, header, sizeof(header)) != static_cast<ssize_t>(sizeof(header)) ||
+        std::memcmp(header, JOURNAL_MAGIC, 4) != 0) {
+        close(fd);
+        throw JournalException(path + " is not a journal");
+    }
+
+    size_t valid = JOURNAL_HEADER_SIZE;
+    std::vector<uint8_t> buffer(JOURNAL_RECORD_SIZE * 4096);
+    size_t filled = 0;
+    while (true) {
+        ssize_t n = read(fd, buffer.data() + filled, buffer.size() - filled);
+        if (n <= 0) {
+            break;
+        }
+        filled += static_cast<size_t>(n);
+        size_t used = 0;
+        JournalRecord record;
+        while (filled - used >= JOURNAL_RECORD_SIZE) {
+            if (!decode_record(buffer.data() + used, record)) {
+                close(fd);
+                return valid;
+            }
+            visit(record);
+            used += JOURNAL_RECORD_SIZE;
+            valid += JOURNAL_RECORD_SIZE;
+        }
+        std::memmove(buffer.data(), buffer.data() + used, filled - used);
+        filled -= used;
+    }
+    close(fd);
+    return valid;
+}
+
+struct JournalConfig {
+    std::string path;
+    // Longest time an appended event may wait before it is fsynced
+    std::chrono::microseconds durability_window{2000};
+    bool fsync = true;
+};
+
+class Journal {
+private:
+    JournalConfig config;
+    int fd;
+    std::mutex lock;
+    std::condition_variable queued;
+    std::condition_variable committed;
+    std::vector<uint8_t> pending;
+    std::unordered_map<uint32_t, uint32_t> sequences;
+    uint64_t appended;
+    uint64_t durable;
+    uint64_t syncs;
+    bool running;
+    std::string failure; // why the writer stopped, empty while it is healthy
+    std::thread writer;
+
+    void write_all(const std::vector<uint8_t>& data) {
+        size_t written = 0;
+        while (written < data.size()) {
+            ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw JournalException(std::string("Journal write failed: ") + std::strerror(errno));
+            }
+            written += static_cast<size_t>(n);
+        }
+    }
+
+    void commit_loop() {
+        std::vector<uint8_t> batch;
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            queued.wait(guard, [&] { return !pending.empty() || !running; });
+            if (pending.empty() && !running) {
+                return;
+            }
+            if (running) {
+                // Let the group fill up for one durability window
+                queued.wait_for(guard, config.durability_window, [&] { return !running; });
+            }
+            batch.swap(pending);
+            uint64_t batch_end = appended;
+            guard.unlock();
+
+            try {
+                write_all(batch);
+                if (config.fsync && fdatasync(fd) < 0) {
+                    throw JournalException(std::string("Journal fsync failed: ") + std::strerror(errno));
+                }
+            } catch (const JournalException& e) {
+                guard.lock();
+                failure = e.what();
+                committed.notify_all();
+                return;
+            }
+            batch.clear();
+
+            guard.lock();
+            durable = batch_end;
+            syncs++;
+            committed.notify_all();
+        }
+    }
+
+public:
+    explicit Journal(const JournalConfig& config)
+        : config(config), fd(-1), appended(0), durable(0), syncs(0), running(true) {
+        fd = open(config.path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw JournalException("Cannot open journal " + config.path);
+        }
+        struct stat info;
+        fstat(fd, &info);
+        if (info.st_size < static_cast<off_t>(JOURNAL_HEADER_SIZE)) {
+            char header[JOURNAL_HEADER_SIZE] = {};
+            std::memcpy(header, JOURNAL_MAGIC, 4);
+            if (ftruncate(fd, 0) < 0 || pwrite(fd, header, sizeof(header), 0) != sizeof(header)) {
+                close(fd);
+                throw JournalException("Cannot initialize journal " + config.path);
+            }
+        } else {
+            // Continue the per-table sequences and cut off a torn tail
+            size_t valid = replay_journal(config.path, [this](const JournalRecord& record) {
+                sequences[record.table] = record.seq;
+            });
+            if (ftruncate(fd, static_cast<off_t>(valid)) < 0) {
+                close(fd);
+                throw JournalException("Cannot truncate journal " + config.path);
+            }
+        }
+        lseek(fd, 0, SEEK_END);
+        writer = std::thread([this] { commit_loop(); });
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Commits everything still queued before closing
+    ~Journal() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            running = false;
+        }
+        queued.notify_all();
+        writer.join();
+        close(fd);
+    }
+
+    // Queues an event and returns its position in the journal (1-based). If seq is given
+    // it receives the event's sequence number within its table.
+    uint64_t append(uint32_t table, uint8_t action, uint8_t actor, uint8_t target, uint32_t* seq = nullptr) {
+        uint8_t bytes[JOURNAL_RECORD_SIZE];
+        std::lock_guard<std::mutex> guard(lock);
+        if (!failure.empty()) {
+            throw JournalException(failure);
+        }
+        JournalRecord record{table, ++sequences[table], action, actor, target};
+        if (seq) {
+            *seq = record.seq;
+        }
+        encode_record(bytes, record);
+        pending.insert(pending.end(), bytes, bytes + JOURNAL_RECORD_SIZE);
+        if (pending.size() == JOURNAL_RECORD_SIZE) {
+            queued.notify_one();
+        }
+        return ++appended;
+    }
+
+    uint64_t append(uint32_t table, const Action& action) {
+        return append(table, static_cast<uint8_t>(action.type), action.actor, action.target);
+    }
+
+    uint64_t append_reset(uint32_t table) {
+        return append(table, JOURNAL_RESET, 0, NO_TARGET);
+    }
+
+    // Blocks until the event at position lsn has been fsynced; throws if the writer
+    // failed before it got there
+    void wait_durable(uint64_t lsn) {
+        std::unique_lock<std::mutex> guard(lock);
+        queued.notify_one();
+        committed.wait(guard, [&] { return durable >= lsn || !failure.empty(); });
+        if (durable < lsn) {
+            throw JournalException(failure);
+        }
+    }
+
+    uint64_t durable_lsn() {
+        std::lock_guard<std::mutex> guard(lock);
+        return durable;
+    }
+
+    uint64_t sync_count() {
+        std::lock_guard<std::mutex> guard(lock);
+        return syncs;
+    }
+
+    uint32_t last_seq(uint32_t table) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = sequences.find(table);
+        return it == sequences.end() ? 0 : it->second;
+    }
+
+    // Makes the table's next event follow seq, if the journal is behind it. A table
+    // restored from a snapshot whose events are no longer in the journal continues from
+    // the snapshot, so recovery does not mistake its new events for ones already applied.
+    void continue_from(uint32_t table, uint32_t seq) {
+        std::lock_guard<std::mutex> guard(lock);
+        uint32_t& last = sequences[table];
+        last = std::max(last, seq);
+    }
+};
@@ -0,0 +1,68 @@
+#include "Journal.cpp"
+#include <atomic>
+
+/*
+ * Journal throughput benchmark.
+ * Several producer threads append events for many tables while the writer group-commits them.
+ * Usage: ./journalbench [--events N] [--threads N] [--window-us N] [--path FILE]
+ */
+
+int main(int argc, char* argv[]) {
+    size_t events = 1000000;
+    size_t threads = 4;
+    JournalConfig config;
+    config.path = "journalbench.wal";
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--events") {
+            events = std::stoul(value);
+        } else if (flag == "--threads") {
+            threads = std::stoul(value);
+        } else if (flag == "--window-us") {
+            config.durability_window = std::chrono::microseconds(std::stol(value));
+        } else if (flag == "--path") {
+            config.path = value;
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+    unlink(config.path.c_str());
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t syncs = 0;
+    {
+        Journal journal(config);
+        std::vector<std::thread> producers;
+        std::atomic<uint64_t> last(0);
+        for (size_t t = 0; t < threads; t++) {
+            producers.emplace_back([&, t] {
+                uint64_t lsn = 0;
+                for (size_t i = t; i < events; i += threads) {
+                    lsn = journal.append(static_cast<uint32_t>(i % 50000), Action{ActionType::Gather, 0, NO_TARGET});
+                }
+                uint64_t seen = last.load();
+                while (lsn > seen && !last.compare_exchange_weak(seen, lsn)) {
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        journal.wait_durable(last.load());
+        syncs = journal.sync_count();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << events << " events durable in " << elapsed << "s = "
+              << static_cast<uint64_t>(events / elapsed) << " events/sec, "
+              << syncs << " group commits (window " << config.durability_window.count() << "us)" << std::endl;
+    unlink(config.path.c_str());
+    return 0;
+}
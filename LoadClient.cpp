@@ -0,0 +1,268 @@
+#include "GameServer.cpp"
+#include <chrono>
+
+/*
+ * Load generator for the game server.
+ * Each connection drives its own block of tables, keeping one request in flight
+ * per table: the current player gathers (or coups once it can afford it), then ends the turn.
+ * Spectators subscribe to the first connection's tables and count the changes they receive.
+ * Usage: ./loadclient [--port N | --unix PATH] [--connections N] [--tables N] [--seconds N]
+ *                     [--spectators N]
+ */
+
+struct LoadConfig {
+    uint16_t port = 7777;
+    std::string unix_path;
+    size_t connections = 4;
+    size_t tables_per_connection = 256;
+    int seconds = 5;
+    size_t spectators = 0;
+};
+
+struct TableCursor {
+    uint32_t table;
+    TableState state;
+    bool end_turn;
+};
+
+int connect_to_server(const LoadConfig& config) {
+    int fd;
+    if (!config.unix_path.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, config.unix_path.c_str(), sizeof(addr.sun_path) - 1);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw SocketException("connect " + config.unix_path);
+        }
+    } else {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config.port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            throw SocketException("connect port " + std::to_string(config.port));
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+// Encodes the next action for a table from its last known state
+size_t next_request(uint8_t* out, const TableCursor& cursor) {
+    const TableState& state = cursor.state;
+    uint8_t me = state.current;
+    if (cursor.end_turn) {
+        return encode_action(out, cursor.table, Action{ActionType::NextTurn, me, NO_TARGET});
+    }
+    if (state.seat[me].coins >= 7) {
+        for (uint8_t seat = 0; seat < state.seats; seat++) {
+            if (seat != me && !(state.seat[seat].flags & SEAT_ELIMINATED)) {
+                return encode_action(out, cursor.table, Action{ActionType::Coup, me, seat});
+            }
+        }
+    }
+    return encode_action(out, cursor.table, Action{ActionType::Gather, me, NO_TARGET});
+}
+
+// Applies a state or error reply to the cursor
+void apply_reply(TableCursor& cursor, const Frame& frame) {
+    if (frame.kind == FrameKind::State) {
+        apply_state(cursor.state, frame);
+        // After a successful action end the turn; after a turn change, act again
+        cursor.end_turn = !cursor.end_turn;
+    } else if (frame.kind == FrameKind::Error && frame.error != ErrorCode::UnknownTable) {
+        cursor.state.current = frame.current;
+        cursor.end_turn = false;
+    } else {
+        throw std::runtime_error("Unexpected reply for table " + std::to_string(frame.table));
+    }
+}
+
+// Sends out and reads expected reply frames, handing each to on_reply.
+// Replies for different tables may arrive in any order.
+template <typename Handler>
+void exchange(int fd, const std::string& out, std::string& in, size_t expected, Handler on_reply) {
+    if (send(fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size())) {
+        throw SocketException("send");
+    }
+    char buffer[65536];
+    size_t replies = 0;
+    size_t start = 0;
+    Frame frame;
+    while (replies < expected) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            throw SocketException("recv");
+        }
+        in.append(buffer, static_cast<size_t>(n));
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(in.data());
+        DecodeStatus status;
+        while (replies < expected &&
+               (status = decode_frame(data + start, in.size() - start, frame)) != DecodeStatus::Incomplete) {
+            if (status != DecodeStatus::Ok) {
+                throw std::runtime_error("Malformed reply from server");
+            }
+            on_reply(frame);
+            replies++;
+            start += frame.length;
+        }
+    }
+    in.erase(0, start);
+}
+
+uint64_t drive_connection(const LoadConfig& config, size_t index, std::chrono::steady_clock::time_point deadline) {
+    int fd = connect_to_server(config);
+    std::vector<TableCursor> cursors;
+    std::string out;
+    std::string in;
+    uint8_t frame[MAX_FRAME_SIZE];
+    for (size_t i = 0; i < config.tables_per_connection; i++) {
+        uint32_t table = static_cast<uint32_t>(index * config.tables_per_connection + i);
+        cursors.push_back(TableCursor{table, TableState{}, false});
+        out.append(reinterpret_cast<char*>(frame), encode_sync(frame, table));
+    }
+    uint32_t first = cursors.front().table;
+    exchange(fd, out, in, cursors.size(), [&](const Frame& reply) {
+        if (reply.kind != FrameKind::State) {
+            throw std::runtime_error("Table " + std::to_string(reply.table) + " is not hosted");
+        }
+        apply_state(cursors.at(reply.table - first).state, reply);
+    });
+
+    uint64_t completed = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        out.clear();
+        for (const auto& cursor : cursors) {
+            out.append(reinterpret_cast<char*>(frame), next_request(frame, cursor));
+        }
+        exchange(fd, out, in, cursors.size(), [&](const Frame& reply) {
+            apply_reply(cursors.at(reply.table - first), reply);
+        });
+        completed += cursors.size();
+    }
+    close(fd);
+    return completed;
+}
+
+// Watches the first connection's tables until the deadline; returns the frames received
+uint64_t spectate(const LoadConfig& config, std::chrono::steady_clock::time_point deadline) {
+    int fd = connect_to_server(config);
+    timeval timeout{0, 100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    std::string out;
+    uint8_t frame[MAX_FRAME_SIZE];
+    for (uint32_t table = 0; table < config.tables_per_connection; table++) {
+        out.append(reinterpret_cast<char*>(frame), encode_subscribe(frame, table));
+    }
+    if (send(fd, out.data(), out.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(out.size())) {
+        throw SocketException("send");
+    }
+
+    std::string in;
+    char buffer[65536];
+    uint64_t received = 0;
+    Frame reply;
+    while (std::chrono::steady_clock::now() < deadline) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                continue;
+            }
+            throw SocketException("recv");
+        }
+        in.append(buffer, static_cast<size_t>(n));
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(in.data());
+        size_t start = 0;
+        DecodeStatus status;
+        while ((status = decode_frame(data + start, in.size() - start, reply)) == DecodeStatus::Ok) {
+            received++;
+            start += reply.length;
+        }
+        if (status != DecodeStatus::Incomplete) {
+            throw std::runtime_error("Malformed frame from server");
+        }
+        in.erase(0, start);
+    }
+    close(fd);
+    return received;
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--port") {
+            config.port = static_cast<uint16_t>(std::stoi(value));
+        } else if (flag == "--unix") {
+            config.unix_path = value;
+        } else if (flag == "--connections") {
+            config.connections = std::stoul(value);
+        } else if (flag == "--tables") {
+            config.tables_per_connection = std::stoul(value);
+        } else if (flag == "--seconds") {
+            config.seconds = std::stoi(value);
+        } else if (flag == "--spectators") {
+            config.spectators = std::stoul(value);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::seconds(config.seconds);
+    std::vector<std::thread> workers;
+    std::vector<uint64_t> counts(config.connections, 0);
+    std::vector<uint64_t> watched(config.spectators, 0);
+    std::atomic<bool> failed(false);
+
+    for (size_t i = 0; i < config.spectators; i++) {
+        workers.emplace_back([&, i] {
+            try {
+                watched[i] = spectate(config, deadline);
+            } catch (const std::exception& e) {
+                std::cerr << "Spectator " << i << ": " << e.what() << std::endl;
+                failed = true;
+            }
+        });
+    }
+
+    for (size_t i = 0; i < config.connections; i++) {
+        workers.emplace_back([&, i] {
+            try {
+                counts[i] = drive_connection(config, i, deadline);
+            } catch (const std::exception& e) {
+                std::cerr << "Connection " << i << ": " << e.what() << std::endl;
+                failed = true;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
+        total += count;
+    }
+    std::cout << total << " actions in " << elapsed << "s = "
+              << static_cast<uint64_t>(total / elapsed) << " actions/sec" << std::endl;
+    if (config.spectators > 0) {
+        uint64_t frames = 0;
+        for (uint64_t count : watched) {
+            frames += count;
+        }
+        std::cout << config.spectators << " spectators received " << frames << " frames = "
+                  << static_cast<uint64_t>(frames / elapsed) << " frames/sec" << std::endl;
+    }
+    return failed ? 1 : 0;
+}
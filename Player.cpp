@@ -1,7 +1,9 @@
+#pragma once
 #include <iostream>
 #include <string>
 #include <vector>
 #include <stdexcept>
+#include "Rules.cpp"
 
 // Forward declarations
 class Player;
@@ -38,6 +40,16 @@ public:
     NotPlayerTurnException(const std::string& message) : InvalidActionException(message) {}
 };
 
+// Receives the game's changes as they happen, so a UI can redraw only what changed
+class GameListener {
+public:
+    virtual ~GameListener() {}
+    // A player's coins, sanction or elimination changed
+    virtual void player_changed(const Player& player) = 0;
+    // The turn moved from seat previous to seat current
+    virtual void turn_changed(size_t previous, size_t current) = 0;
+};
+
 // Base Player class
 class Player {
 private:
@@ -49,6 +61,9 @@ private:
     Player* last_arrested;
     Game* game;
 
+    // Tells the game's listener, if any, that this player changed
+    void changed();
+
 public:
     // Constructor
     Player(const std::string& name, const std::string& role, Game* game)
@@ -87,7 +102,12 @@ public:
 
     // Utility methods
     bool is_sanctioned() const { return sanctioned; }
-    void set_sanctioned(bool value) { sanctioned = value; }
+    void set_sanctioned(bool value) {
+        if (sanctioned != value) {
+            sanctioned = value;
+            changed();
+        }
+    }
     int get_coins() const { return coins; }
     
     void add_coins(int amount) {
@@ -95,6 +115,9 @@ public:
             throw std::invalid_argument("Cannot add negative coins");
         }
         coins += amount;
+        if (amount != 0) {
+            changed();
+        }
     }
     
     void remove_coins(int amount) {
@@ -105,12 +128,20 @@ public:
             throw InsufficientCoinsException("Not enough coins");
         }
         coins -= amount;
+        if (amount != 0) {
+            changed();
+        }
     }
     
-    std::string get_name() const { return name; }
-    std::string get_role() const { return role; }
+    const std::string& get_name() const { return name; }
+    const std::string& get_role() const { return role; }
     bool is_eliminated() const { return !active; }
-    void eliminate() { active = false; }
+    void eliminate() {
+        if (active) {
+            active = false;
+            changed();
+        }
+    }
     
     Player* get_last_arrested() const { return last_arrested; }
     void set_last_arrested(Player* player) { last_arrested = player; }
@@ -125,9 +156,12 @@ private:
     std::vector<Player*> players;
     size_t current_player_index;
     Player* last_arrested;
+    GameListener* listener;
+
+    void copy_players(const Game& other);
 
 public:
-    Game() : current_player_index(0), last_arrested(nullptr) {}
+    Game() : current_player_index(0), last_arrested(nullptr), listener(nullptr) {}
     
     // Rule of Three
     Game(const Game& other);
@@ -144,35 +178,57 @@ public:
     Player* get_player_by_name(const std::string& name) const;
     Player* get_current_player() const;
     
+    // Seat-indexed access, used by hosts that address players by seat number
+    size_t player_count() const { return players.size(); }
+    Player* get_player(size_t index) const { return players.at(index); }
+    size_t get_current_index() const { return current_player_index; }
+    void set_current_index(size_t index) {
+        size_t previous = current_player_index;
+        current_player_index = index;
+        if (listener && previous != index) {
+            listener->turn_changed(previous, index);
+        }
+    }
+    
     Player* get_last_arrested() const { return last_arrested; }
     void set_last_arrested(Player* player) { last_arrested = player; }
+
+    // Changes are reported to at most one listener; copies of the game start without one
+    void set_listener(GameListener* game_listener) { listener = game_listener; }
+    GameListener* get_listener() const { return listener; }
 };
 
+inline void Player::changed() {
+    if (game && game->get_listener()) {
+        game->get_listener()->player_changed(*this);
+    }
+}
+
 // Implementation of Player methods
 void Player::gather() {
     if (is_sanctioned()) {
         throw SanctionedException("Player is sanctioned and cannot gather coins");
     }
-    add_coins(1);
+    add_coins(STANDARD_RULES.gather);
 }
 
 void Player::tax() {
     if (is_sanctioned()) {
         throw SanctionedException("Player is sanctioned and cannot tax");
     }
-    add_coins(2);
+    add_coins(STANDARD_RULES.tax);
 }
 
 void Player::bribe() {
-    if (get_coins() < 4) {
+    if (get_coins() < STANDARD_RULES.bribe_cost) {
         throw InsufficientCoinsException("Not enough coins to bribe");
     }
-    remove_coins(4);
+    remove_coins(STANDARD_RULES.bribe_cost);
     // Logic for extra action would be implemented by the game
 }
 
 void Player::arrest(Player& target) {
-    if (get_coins() < 1) {
+    if (get_coins() < STANDARD_RULES.arrest_steal) {
         throw InsufficientCoinsException("Not enough coins to arrest");
     }
     
@@ -180,29 +236,31 @@ void Player::arrest(Player& target) {
         throw ConsecutiveArrestException("Cannot arrest the same player in consecutive turns");
     }
     
-    if (target.get_coins() < 1) {
+    // Takes what the rules allow, or all the target has if that is less
+    int stolen = std::min(target.get_coins(), STANDARD_RULES.arrest_steal);
+    if (stolen <= 0) {
         throw InvalidActionException("Target player has no coins to steal");
     }
     
-    target.remove_coins(1);
-    add_coins(1);
+    target.remove_coins(stolen);
+    add_coins(stolen);
     get_game()->set_last_arrested(&target);
 }
 
 void Player::sanction(Player& target) {
-    if (get_coins() < 3) {
+    if (get_coins() < STANDARD_RULES.sanction_cost) {
         throw InsufficientCoinsException("Not enough coins to sanction");
     }
     
-    remove_coins(3);
+    remove_coins(STANDARD_RULES.sanction_cost);
     target.set_sanctioned(true);
 }
 
 void Player::coup(Player& target) {
-    if (get_coins() < 7) {
+    if (get_coins() < STANDARD_RULES.coup_cost) {
         throw InsufficientCoinsException("Not enough coins to coup");
     }
     
-    remove_coins(7);
+    remove_coins(STANDARD_RULES.coup_cost);
     get_game()->eliminate_player(target);
 }
\ No newline at end of file
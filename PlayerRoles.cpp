@@ -1,3 +1,4 @@
+#pragma once
 #include "Player.cpp"
 
 // Governor: Takes 3 coins instead of 2 when performing tax, can block tax actions
@@ -11,7 +12,7 @@ public:
         if (is_sanctioned()) {
             throw SanctionedException("Player is sanctioned and cannot tax");
         }
-        add_coins(3); // Governor takes 3 coins instead of 2
+        add_coins(STANDARD_RULES.governor_tax); // Governor takes more than the usual tax
     }
     
     // Special ability: Block another player's tax action
@@ -49,18 +50,18 @@ public:
     
     // Special ability: Invest coins
     void invest() {
-        if (get_coins() < 3) {
+        if (get_coins() < STANDARD_RULES.invest_cost) {
             throw InsufficientCoinsException("Not enough coins to invest");
         }
         
-        remove_coins(3);
-        add_coins(6); // Return on investment: 6 coins
+        remove_coins(STANDARD_RULES.invest_cost);
+        add_coins(STANDARD_RULES.invest_return); // Return on investment
     }
     
     // Special ability: Get compensation when sanctioned
     void compensate() {
         if (is_sanctioned()) {
-            add_coins(1); // Get 1 coin as compensation
+            add_coins(STANDARD_RULES.sanction_compensation);
         }
     }
 };
@@ -73,18 +74,18 @@ public:
     
     // Special ability: Protect against coup
     void protect(Player& target) {
-        if (get_coins() < 5) {
+        if (get_coins() < STANDARD_RULES.protect_cost) {
             throw InsufficientCoinsException("Not enough coins to protect");
         }
         
-        remove_coins(5);
+        remove_coins(STANDARD_RULES.protect_cost);
         // Logic to prevent the coup would be implemented by the game
         std::cout << get_name() << " protected " << target.get_name() << " from a coup" << std::endl;
     }
     
     // Special ability: Regain coin lost from being arrested
     void recover_arrest() {
-        add_coins(1); // Regain the coin lost from being arrested
+        add_coins(STANDARD_RULES.arrest_recovery);
     }
 };
 
@@ -96,18 +97,19 @@ public:
     
     // Special ability: Block bribe and cause the player to lose coins
     void block_bribe(Player& target) {
-        // The target has already paid 4 coins, we're not adding them back
+        // The target has already paid for the bribe, we're not adding it back
         std::cout << get_name() << " blocked " << target.get_name() << "'s bribe" << std::endl;
     }
     
     // Special ability: Force sanctioning player to pay extra coin
     void penalize_sanction(Player& target) {
-        if (target.get_coins() < 1) {
+        if (target.get_coins() < STANDARD_RULES.sanction_penalty) {
             throw InvalidActionException("Target player has no coins to penalize");
         }
         
-        target.remove_coins(1);
-        std::cout << get_name() << " forced " << target.get_name() << " to pay an extra coin for sanctioning" << std::endl;
+        target.remove_coins(STANDARD_RULES.sanction_penalty);
+        std::cout << get_name() << " forced " << target.get_name() << " to pay " << STANDARD_RULES.sanction_penalty
+                  << " more for sanctioning" << std::endl;
     }
 };
 
@@ -119,14 +121,14 @@ public:
     
     // Special ability: Get bonus coin at start of turn
     void bonus() {
-        if (get_coins() >= 3) {
-            add_coins(1); // Get 1 extra coin if starting with 3+ coins
+        if (get_coins() >= STANDARD_RULES.merchant_bonus_at) {
+            add_coins(STANDARD_RULES.merchant_bonus);
         }
     }
     
     // Override arrest to pay pot instead of another player
     void arrest(Player& target) override {
-        if (get_coins() < 1) {
+        if (get_coins() < STANDARD_RULES.merchant_arrest_cost) {
             throw InsufficientCoinsException("Not enough coins to arrest");
         }
         
@@ -134,10 +136,22 @@ public:
             throw ConsecutiveArrestException("Cannot arrest the same player in consecutive turns");
         }
         
-        // Merchant pays 2 coins to the pot when arrested
-        remove_coins(2);
+        // Merchant pays the pot when arresting
+        remove_coins(STANDARD_RULES.merchant_arrest_cost);
         
         get_game()->set_last_arrested(&target);
-        std::cout << get_name() << " paid 2 coins to the pot instead of giving to " << target.get_name() << std::endl;
+        std::cout << get_name() << " paid " << STANDARD_RULES.merchant_arrest_cost
+                  << " coins to the pot instead of giving to " << target.get_name() << std::endl;
     }
-};
\ No newline at end of file
+};
+
+// Creates a player for the given role name
+Player* make_role_player(const std::string& role, const std::string& name, Game* game) {
+    if (role == "Governor") return new Governor(name, game);
+    if (role == "Spy") return new Spy(name, game);
+    if (role == "Baron") return new Baron(name, game);
+    if (role == "General") return new General(name, game);
+    if (role == "Judge") return new Judge(name, game);
+    if (role == "Merchant") return new Merchant(name, game);
+    throw std::invalid_argument("Unknown role: " + role);
+}
@@ -0,0 +1,300 @@
+#pragma once
+#include "TableState.cpp"
+
+/*
+ * Versioned binary wire protocol used by the game server.
+ * All integers are little-endian. Every frame starts with a 4-byte header:
+ *   version u8 | kind u8 | length u16 (whole frame, header included)
+ *
+ * Action (12 bytes):  header | table u32 | action u8 | actor u8 | target u8 | reserved u8
+ * State (12 + 4n):    header | table u32 | current u8 | flags u8 | count u8 | seats u8
+ *                     then n entries of seat u8 | seat flags u8 | coins u16
+ *   A state frame lists only the seats that changed, unless STATE_KEYFRAME is set,
+ *   in which case it lists every seat.
+ * Error (12 bytes):   header | table u32 | code u8 | current u8 | reserved u16
+ * Sync (8 bytes):     header | table u32   (asks for a keyframe of the table)
+ * Subscribe (8 bytes):   header | table u32 (spectate: a keyframe, then every change)
+ * Unsubscribe (8 bytes): header | table u32 (stop spectating; not answered)
+ * Peek (8 bytes):      header | table u32   (asks for the last published keyframe; it may
+ *                     not yet include actions still queued for the table)
+ *
+ * decode_frame() validates a frame in place and never allocates; malformed input is
+ * rejected after a handful of comparisons.
+ */
+
+const uint8_t PROTOCOL_VERSION = 1;
+const size_t FRAME_HEADER_SIZE = 4;
+const size_t ACTION_FRAME_SIZE = 12;
+const size_t STATE_FRAME_BASE_SIZE = 12;
+const size_t STATE_ENTRY_SIZE = 4;
+const size_t ERROR_FRAME_SIZE = 12;
+const size_t SYNC_FRAME_SIZE = 8;
+const size_t MAX_FRAME_SIZE = STATE_FRAME_BASE_SIZE + STATE_ENTRY_SIZE * MAX_SEATS;
+
+const uint8_t STATE_KEYFRAME = 0x01;
+
+enum class FrameKind : uint8_t {
+    Action = 1,
+    State = 2,
+    Error = 3,
+    Sync = 4,
+    Subscribe = 5,
+    Unsubscribe = 6,
+    Peek = 7
+};
+
+enum class ErrorCode : uint8_t {
+    InvalidAction = 1,
+    InsufficientCoins,
+    Sanctioned,
+    ConsecutiveArrest,
+    GameOver,
+    NotPlayerTurn,
+    UnknownTable,
+    Malformed
+};
+
+enum class DecodeStatus {
+    Ok,
+    Incomplete,
+    BadVersion,
+    BadKind,
+    BadLength,
+    BadField
+};
+
+// Decoded view of one frame; entries points into the caller's buffer
+struct Frame {
+    FrameKind kind;
+    uint16_t length;
+    uint32_t table;
+    // Action frames
+    Action action;
+    // State frames
+    uint8_t current;
+    uint8_t flags;
+    uint8_t count;
+    uint8_t seats;
+    const uint8_t* entries;
+    // Error frames
+    ErrorCode error;
+};
+
+struct SeatDelta {
+    uint8_t seat;
+    SeatState state;
+};
+
+inline void put_u16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline void put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+inline uint16_t get_u16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline uint32_t get_u32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+inline void put_u64(uint8_t* out, uint64_t value) {
+    put_u32(out, static_cast<uint32_t>(value));
+    put_u32(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+inline uint64_t get_u64(const uint8_t* in) {
+    return static_cast<uint64_t>(get_u32(in)) | (static_cast<uint64_t>(get_u32(in + 4)) << 32);
+}
+
+inline void put_header(uint8_t* out, FrameKind kind, size_t length) {
+    out[0] = PROTOCOL_VERSION;
+    out[1] = static_cast<uint8_t>(kind);
+    put_u16(out + 2, static_cast<uint16_t>(length));
+}
+
+// Each encoder writes into out (at least MAX_FRAME_SIZE bytes) and returns the frame size
+size_t encode_action(uint8_t* out, uint32_t table, const Action& action) {
+    put_header(out, FrameKind::Action, ACTION_FRAME_SIZE);
+    put_u32(out + 4, table);
+    out[8] = static_cast<uint8_t>(action.type);
+    out[9] = action.actor;
+    out[10] = action.target;
+    out[11] = 0;
+    return ACTION_FRAME_SIZE;
+}
+
+// Encodes the seats that differ between before and after, or every seat when keyframe is set
+size_t encode_state(uint8_t* out, uint32_t table, const TableState& before, const TableState& after, bool keyframe) {
+    keyframe = keyframe || before.seats != after.seats;
+    uint8_t count = 0;
+    uint8_t* entry = out + STATE_FRAME_BASE_SIZE;
+    for (uint8_t seat = 0; seat < after.seats; seat++) {
+        if (keyframe || before.seat[seat] != after.seat[seat]) {
+            entry[0] = seat;
+            entry[1] = after.seat[seat].flags;
+            put_u16(entry + 2, static_cast<uint16_t>(after.seat[seat].coins));
+            entry += STATE_ENTRY_SIZE;
+            count++;
+        }
+    }
+    size_t length = STATE_FRAME_BASE_SIZE + STATE_ENTRY_SIZE * count;
+    put_header(out, FrameKind::State, length);
+    put_u32(out + 4, table);
+    out[8] = after.current;
+    out[9] = keyframe ? STATE_KEYFRAME : 0;
+    out[10] = count;
+    out[11] = after.seats;
+    return length;
+}
+
+size_t encode_keyframe(uint8_t* out, uint32_t table, const TableState& state) {
+    return encode_state(out, table, state, state, true);
+}
+
+// Sync, Subscribe, Unsubscribe and Peek frames share the same table-only layout
+size_t encode_table_request(uint8_t* out, FrameKind kind, uint32_t table) {
+    put_header(out, kind, SYNC_FRAME_SIZE);
+    put_u32(out + 4, table);
+    return SYNC_FRAME_SIZE;
+}
+
+size_t encode_sync(uint8_t* out, uint32_t table) {
+    return encode_table_request(out, FrameKind::Sync, table);
+}
+
+size_t encode_subscribe(uint8_t* out, uint32_t table) {
+    return encode_table_request(out, FrameKind::Subscribe, table);
+}
+
+size_t encode_unsubscribe(uint8_t* out, uint32_t table) {
+    return encode_table_request(out, FrameKind::Unsubscribe, table);
+}
+
+size_t encode_peek(uint8_t* out, uint32_t table) {
+    return encode_table_request(out, FrameKind::Peek, table);
+}
+
+size_t encode_error(uint8_t* out, uint32_t table, ErrorCode code, uint8_t current) {
+    put_header(out, FrameKind::Error, ERROR_FRAME_SIZE);
+    put_u32(out + 4, table);
+    out[8] = static_cast<uint8_t>(code);
+    out[9] = current;
+    put_u16(out + 10, 0);
+    return ERROR_FRAME_SIZE;
+}
+
+// Maps the engine's exception hierarchy onto wire error codes
+ErrorCode error_code_for(const std::exception& e) {
+    if (dynamic_cast<const InsufficientCoinsException*>(&e)) return ErrorCode::InsufficientCoins;
+    if (dynamic_cast<const SanctionedException*>(&e)) return ErrorCode::Sanctioned;
+    if (dynamic_cast<const ConsecutiveArrestException*>(&e)) return ErrorCode::ConsecutiveArrest;
+    if (dynamic_cast<const GameOverException*>(&e)) return ErrorCode::GameOver;
+    if (dynamic_cast<const NotPlayerTurnException*>(&e)) return ErrorCode::NotPlayerTurn;
+    return ErrorCode::InvalidAction;
+}
+
+DecodeStatus decode_frame(const uint8_t* data, size_t size, Frame& frame) {
+    if (size < FRAME_HEADER_SIZE) {
+        return DecodeStatus::Incomplete;
+    }
+    if (data[0] != PROTOCOL_VERSION) {
+        return DecodeStatus::BadVersion;
+    }
+    frame.kind = static_cast<FrameKind>(data[1]);
+    frame.length = get_u16(data + 2);
+
+    size_t min_length;
+    switch (frame.kind) {
+        case FrameKind::Action: min_length = ACTION_FRAME_SIZE; break;
+        case FrameKind::State: min_length = STATE_FRAME_BASE_SIZE; break;
+        case FrameKind::Error: min_length = ERROR_FRAME_SIZE; break;
+        case FrameKind::Sync:
+        case FrameKind::Subscribe:
+        case FrameKind::Unsubscribe:
+        case FrameKind::Peek: min_length = SYNC_FRAME_SIZE; break;
+        default: return DecodeStatus::BadKind;
+    }
+    if (frame.length < min_length || frame.length > MAX_FRAME_SIZE) {
+        return DecodeStatus::BadLength;
+    }
+    if (size < frame.length) {
+        return DecodeStatus::Incomplete;
+    }
+    frame.table = get_u32(data + 4);
+
+    if (frame.kind == FrameKind::Action) {
+        if (frame.length != ACTION_FRAME_SIZE) {
+            return DecodeStatus::BadLength;
+        }
+        uint8_t type = data[8];
+        if (type == 0 || type >= static_cast<uint8_t>(ActionType::Count) || data[11] != 0) {
+            return DecodeStatus::BadField;
+        }
+        frame.action = Action{static_cast<ActionType>(type), data[9], data[10]};
+        return DecodeStatus::Ok;
+    }
+
+    if (frame.kind == FrameKind::Sync || frame.kind == FrameKind::Subscribe || frame.kind == FrameKind::Unsubscribe ||
+        frame.kind == FrameKind::Peek) {
+        return frame.length == SYNC_FRAME_SIZE ? DecodeStatus::Ok : DecodeStatus::BadLength;
+    }
+
+    if (frame.kind == FrameKind::Error) {
+        if (frame.length != ERROR_FRAME_SIZE) {
+            return DecodeStatus::BadLength;
+        }
+        if (data[8] == 0 || data[8] > static_cast<uint8_t>(ErrorCode::Malformed)) {
+            return DecodeStatus::BadField;
+        }
+        frame.error = static_cast<ErrorCode>(data[8]);
+        frame.current = data[9];
+        return DecodeStatus::Ok;
+    }
+
+    frame.current = data[8];
+    frame.flags = data[9];
+    frame.count = data[10];
+    frame.seats = data[11];
+    frame.entries = data + STATE_FRAME_BASE_SIZE;
+    if (frame.length != STATE_FRAME_BASE_SIZE + STATE_ENTRY_SIZE * frame.count) {
+        return DecodeStatus::BadLength;
+    }
+    if ((frame.flags & ~STATE_KEYFRAME) != 0 || frame.seats > MAX_SEATS || frame.count > frame.seats ||
+        frame.current >= frame.seats || ((frame.flags & STATE_KEYFRAME) && frame.count != frame.seats)) {
+        return DecodeStatus::BadField;
+    }
+    for (uint8_t i = 0; i < frame.count; i++) {
+        const uint8_t* entry = frame.entries + STATE_ENTRY_SIZE * i;
+        if (entry[0] >= frame.seats || (entry[1] & ~(SEAT_SANCTIONED | SEAT_ELIMINATED)) != 0) {
+            return DecodeStatus::BadField;
+        }
+    }
+    return DecodeStatus::Ok;
+}
+
+// Reads entry i of a validated state frame
+SeatDelta state_entry(const Frame& frame, uint8_t i) {
+    const uint8_t* entry = frame.entries + STATE_ENTRY_SIZE * i;
+    return SeatDelta{entry[0], SeatState{static_cast<int16_t>(get_u16(entry + 2)), entry[1]}};
+}
+
+// Applies a validated state frame to a client-side copy of the table
+void apply_state(TableState& state, const Frame& frame) {
+    if (frame.flags & STATE_KEYFRAME) {
+        state = TableState{};
+    }
+    state.seats = frame.seats;
+    state.current = frame.current;
+    for (uint8_t i = 0; i < frame.count; i++) {
+        SeatDelta delta = state_entry(frame, i);
+        state.seat[delta.seat] = delta.state;
+    }
+}
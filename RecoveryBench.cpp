@@ -0,0 +1,105 @@
+#include "GameServer.cpp"
+
+/*
+ * Crash-recovery benchmark.
+ * Plays a history on many tables into a journal, snapshots them part way, plays a
+ * short tail, then times rebuilding every table two ways: replaying the whole journal
+ * on one thread, and loading the snapshot plus replaying only the tail in parallel.
+ * Usage: ./recoverybench [--tables N] [--history N] [--tail N] [--threads N]
+ */
+
+void play(TableRegistry& registry, size_t actions) {
+    uint8_t buffer[MAX_FRAME_SIZE];
+    Frame frame;
+    for (uint32_t id = 0; id < registry.size(); id++) {
+        Table* table = registry.find(id);
+        for (size_t i = 0; i < actions; i++) {
+            encode_action(buffer, id, bot_action(table->get_game(), i % 2 == 1));
+            decode_frame(buffer, ACTION_FRAME_SIZE, frame);
+            table->execute(frame, buffer);
+        }
+    }
+}
+
+bool same_tables(TableRegistry& a, TableRegistry& b) {
+    for (uint32_t id = 0; id < a.size(); id++) {
+        if (capture_state(a.find(id)->get_game()) != capture_state(b.find(id)->get_game())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    size_t tables = 50000;
+    size_t history = 200;
+    size_t tail = 10;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--tables") {
+            tables = std::stoul(value);
+        } else if (flag == "--history") {
+            history = std::stoul(value);
+        } else if (flag == "--tail") {
+            tail = std::stoul(value);
+        } else if (flag == "--threads") {
+            threads = std::stoul(value);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    JournalConfig config;
+    config.path = "recoverybench.wal";
+    config.fsync = false;
+    std::string snapshot_path = "recoverybench.snap";
+    unlink(config.path.c_str());
+    unlink(snapshot_path.c_str());
+
+    Scheduler scheduler(1, false);
+    TableRegistry live(scheduler, tables, nullptr);
+    {
+        Journal journal(config);
+        TableRegistry journaled(scheduler, tables, &journal);
+        play(journaled, history);
+        std::vector<TableSnapshot> snapshots;
+        for (uint32_t id = 0; id < tables; id++) {
+            snapshots.push_back(journaled.find(id)->snapshot());
+        }
+        write_snapshot_file(snapshot_path, snapshots);
+        play(journaled, tail);
+        for (uint32_t id = 0; id < tables; id++) {
+            TableSnapshot snapshot = journaled.find(id)->snapshot();
+            live.find(id)->restore(snapshot);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TableRegistry full(scheduler, tables);
+    size_t full_events = full.recover("", config.path, 1);
+    double full_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    TableRegistry fast(scheduler, tables);
+    size_t tail_events = fast.recover(snapshot_path, config.path, threads);
+    double fast_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool consistent = same_tables(live, full) && same_tables(live, fast);
+    std::cout << tables << " tables" << std::endl;
+    std::cout << "full journal replay:      " << full_events << " events in " << full_time << "s" << std::endl;
+    std::cout << "snapshot + parallel tail: " << tail_events << " events in " << fast_time << "s ("
+              << threads << " threads, " << full_time / fast_time << "x faster)" << std::endl;
+    std::cout << (consistent ? "recovered state matches" : "RECOVERED STATE DIFFERS") << std::endl;
+
+    unlink(config.path.c_str());
+    unlink(snapshot_path.c_str());
+    return consistent ? 0 : 1;
+}
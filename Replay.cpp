@@ -0,0 +1,645 @@
+#pragma once
+#include "EventLog.cpp"
+#include "EventCodec.cpp"
+#include "Protocol.cpp"
+#include "Journal.cpp"
+#include <bit>
+#include <memory>
+#include <sys/mman.h>
+
+/*
+ * Archive of finished games for replay.
+ * A replay file holds any number of games, each stored as one self-contained block,
+ * followed by a directory so any game can be found without reading the others:
+ *   header:    magic "CPR1" | version u16 | reserved u16 | game_count u64 | directory u64
+ *   game:      event_count u32 | turn_count u32 | stride u16 | roster_size u16 | players u8 | encoding u8
+ *              | checkpoint_every u16
+ *              roster:      per seat role u8 | name_len u8 | name
+ *              events:      raw encoding: event_count packed 10-byte Events, 4-byte aligned
+ *                           packed encoding: size u32 | offset u32 of each 16-event block
+ *                           | blocks coded with EventCodec.cpp, 4-byte aligned
+ *              index:       event position of the first event of every stride-th turn, u32 each
+ *              checkpoints: state at the start of every checkpoint_every-th turn after turn 0:
+ *                           position u32 | current u8 | last_arrested u8 | reserved u16
+ *                           then per seat: flags u8 | reserved u8 | coins i16
+ *   directory: per game offset u64 | size u32 | crc32 u32 of the game block
+ * Everything is little-endian. ReplayFile maps the file read-only and hands out
+ * ReplayGame views. Raw events point straight into the mapping, so iterating them
+ * copies nothing; packed events take about a third of the space and are decoded a
+ * block at a time by scan(). Seeking to a turn reads one index entry and scans at most one
+ * stride of events. Games are recorded from a freshly seated table: every player
+ * starts with no coins and seat 0 moves first.
+ * Checkpoints are taken by re-playing the game through the engine as it is written.
+ * restore_turn() rebuilds the board at any turn from the nearest checkpoint before it,
+ * so it performs at most checkpoint_every turns of events however long the game is.
+ */
+
+const char REPLAY_MAGIC[4] = {'C', 'P', 'R', '1'};
+const uint16_t REPLAY_VERSION = 1;
+const size_t REPLAY_HEADER_SIZE = 24;
+const size_t REPLAY_GAME_HEADER_SIZE = 16;
+const size_t REPLAY_DIRECTORY_ENTRY_SIZE = 16;
+const uint16_t REPLAY_DEFAULT_STRIDE = 8;
+const uint16_t REPLAY_DEFAULT_CHECKPOINT = 32;
+const size_t REPLAY_CHECKPOINT_BASE = 8;
+const size_t REPLAY_CHECKPOINT_SEAT_SIZE = 4;
+const uint8_t REPLAY_RAW = 0;
+const uint8_t REPLAY_PACKED = 1;
+
+static_assert(sizeof(Event) == 10 && alignof(Event) <= 4, "Replay events are stored as packed 10-byte records");
+static_assert(std::is_trivially_copyable<Event>::value, "Replay events are read in place");
+static_assert(std::endian::native == std::endian::little, "Replay events are read in place as little-endian");
+
+class ReplayException : public std::runtime_error {
+public:
+    ReplayException(const std::string& message) : std::runtime_error(message) {}
+};
+
+inline size_t align4(size_t offset) {
+    return (offset + 3) & ~static_cast<size_t>(3);
+}
+
+struct ReplayOptions {
+    uint16_t index_stride = REPLAY_DEFAULT_STRIDE;
+    uint16_t checkpoint_every = REPLAY_DEFAULT_CHECKPOINT; // 0 writes no checkpoints
+    bool packed = false;                                   // code events with EventCodec.cpp
+};
+
+struct RosterEntry {
+    uint8_t role;
+    std::string name;
+};
+
+// Read-only view of one game inside a mapped replay file
+class ReplayGame {
+private:
+    const uint8_t* block;
+    size_t block_size;
+    const Event* event_data;
+    const uint8_t* packed_events;
+    uint32_t packed_size;
+    const uint8_t* index;
+    const uint8_t* checkpoints;
+    uint32_t events;
+    uint32_t turns;
+    uint16_t stride;
+    uint16_t checkpoint_every;
+    uint8_t players;
+    uint8_t encoding;
+
+    void decode_block(size_t block_id, Event* out) const {
+        size_t offset = get_u32(packed_events + 4 + 4 * block_id);
+        if (offset > packed_size) {
+            throw ReplayException("Replay event block is out of bounds");
+        }
+        try {
+            decode_events(packed_events + offset, packed_size - offset, out,
+                          std::min<size_t>(CODEC_BLOCK, events - block_id * CODEC_BLOCK));
+        } catch (const CodecException& error) {
+            throw ReplayException(std::string("Replay events are corrupt: ") + error.what());
+        }
+    }
+
+public:
+    ReplayGame(const uint8_t* data, size_t size) : block(data), block_size(size) {
+        if (size < REPLAY_GAME_HEADER_SIZE) {
+            throw ReplayException("Replay game is truncated");
+        }
+        events = get_u32(data);
+        turns = get_u32(data + 4);
+        stride = get_u16(data + 8);
+        uint16_t roster_size = get_u16(data + 10);
+        players = data[12];
+        encoding = data[13];
+        checkpoint_every = get_u16(data + 14);
+        if (stride == 0 || turns == 0) {
+            throw ReplayException("Replay game is malformed");
+        }
+        size_t events_offset = align4(REPLAY_GAME_HEADER_SIZE + roster_size);
+        size_t events_size = sizeof(Event) * static_cast<size_t>(events);
+        packed_size = 0;
+        if (encoding == REPLAY_PACKED) {
+            packed_size = events_offset + 4 <= size ? get_u32(data + events_offset) : 0;
+            events_size = packed_size;
+            if (packed_size < 4 + 4 * ((static_cast<size_t>(events) + CODEC_BLOCK - 1) / CODEC_BLOCK)) {
+                throw ReplayException("Replay game is malformed");
+            }
+        }
+        size_t index_offset = align4(events_offset + events_size);
+        size_t checkpoints_offset = index_offset + 4 * index_size();
+        if (players > MAX_SEATS || encoding > REPLAY_PACKED ||
+            checkpoints_offset + checkpoint_size() * checkpoint_count() > size) {
+            throw ReplayException("Replay game is malformed");
+        }
+        event_data = encoding == REPLAY_RAW ? reinterpret_cast<const Event*>(data + events_offset) : nullptr;
+        packed_events = encoding == REPLAY_PACKED ? data + events_offset : nullptr;
+        index = data + index_offset;
+        checkpoints = data + checkpoints_offset;
+    }
+
+    const uint8_t* data() const { return block; }
+    size_t size() const { return block_size; }
+    size_t event_count() const { return events; }
+    uint32_t turn_count() const { return turns; }
+    uint16_t index_stride() const { return stride; }
+    size_t index_size() const { return (turns + stride - 1) / stride; }
+    uint8_t player_count() const { return players; }
+    uint16_t checkpoint_interval() const { return checkpoint_every; }
+    size_t checkpoint_count() const { return checkpoint_every ? (turns - 1) / checkpoint_every : 0; }
+    size_t checkpoint_size() const { return REPLAY_CHECKPOINT_BASE + REPLAY_CHECKPOINT_SEAT_SIZE * players; }
+    bool packed() const { return encoding == REPLAY_PACKED; }
+
+    // In-place access to raw games; packed games have no in-place events, use scan()
+    const Event* begin() const { return event_data; }
+    const Event* end() const { return event_data ? event_data + events : nullptr; }
+    const Event& operator[](size_t position) const { return event_data[position]; }
+
+    // Calls visit(position, event) for the events in [from, to) until visit returns
+    // false; returns the position it stopped at, or to
+    template <typename Visit>
+    size_t scan(size_t from, size_t to, Visit visit) const {
+        to = std::min<size_t>(to, events);
+        if (!packed()) {
+            for (size_t position = from; position < to; position++) {
+                if (!visit(position, event_data[position])) {
+                    return position;
+                }
+            }
+            return to;
+        }
+        Event decoded[CODEC_BLOCK];
+        for (size_t first = from - from % CODEC_BLOCK; first < to; first += CODEC_BLOCK) {
+            decode_block(first / CODEC_BLOCK, decoded);
+            for (size_t position = std::max(first, from); position < std::min(first + CODEC_BLOCK, to); position++) {
+                if (!visit(position, decoded[position - first])) {
+                    return position;
+                }
+            }
+        }
+        return to;
+    }
+
+    Event event(size_t position) const {
+        Event found{};
+        scan(position, position + 1, [&](size_t, const Event& event) {
+            found = event;
+            return true;
+        });
+        return found;
+    }
+
+    std::vector<Event> all_events() const {
+        std::vector<Event> all;
+        all.reserve(events);
+        scan(0, events, [&](size_t, const Event& event) {
+            all.push_back(event);
+            return true;
+        });
+        return all;
+    }
+
+    // Position of the first event of a turn; turn_count() gives event_count()
+    size_t seek_turn(uint32_t turn) const {
+        if (turn > turns) {
+            throw ReplayException("Game has no turn " + std::to_string(turn));
+        }
+        if (turn == turns) {
+            return events;
+        }
+        size_t position = std::min<size_t>(get_u32(index + 4 * (turn / stride)), events);
+        uint32_t skip = turn % stride;
+        if (skip == 0) {
+            return position;
+        }
+        size_t last = scan(position, events, [&](size_t, const Event& event) {
+            return event.action != ActionType::NextTurn || --skip > 0;
+        });
+        return std::min<size_t>(last + 1, events);
+    }
+
+    // Checkpoint n (from 1) holds the state at the start of turn n * checkpoint_interval()
+    const uint8_t* checkpoint(size_t n) const {
+        return checkpoints + checkpoint_size() * (n - 1);
+    }
+
+    std::vector<RosterEntry> roster() const {
+        std::vector<RosterEntry> seats;
+        const uint8_t* in = block + REPLAY_GAME_HEADER_SIZE;
+        const uint8_t* roster_end = in + get_u16(block + 10);
+        for (uint8_t i = 0; i < players; i++) {
+            if (in + 2 > roster_end || in + 2 + in[1] > roster_end) {
+                throw ReplayException("Replay roster is malformed");
+            }
+            seats.push_back(RosterEntry{in[0], std::string(reinterpret_cast<const char*>(in + 2), in[1])});
+            in += 2 + in[1];
+        }
+        return seats;
+    }
+
+    // Seats the game's players into an empty game, as they were when it started
+    void seat_players(Game& game) const {
+        if (game.player_count() != 0) {
+            throw std::logic_error("Can only seat a replay into an empty game");
+        }
+        for (const auto& seat : roster()) {
+            if (seat.role >= ROLE_COUNT) {
+                throw ReplayException("Replay roster has an unknown role");
+            }
+            game.add_player(make_role_player(ROLE_NAMES[seat.role], seat.name, &game));
+        }
+    }
+};
+
+// Read-only memory mapping of a replay file
+class ReplayFile {
+private:
+    const uint8_t* mapping;
+    size_t mapping_size;
+    uint64_t games;
+    const uint8_t* directory;
+
+public:
+    explicit ReplayFile(const std::string& path) : mapping(nullptr), mapping_size(0), games(0), directory(nullptr) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw ReplayException("Cannot open replay " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(REPLAY_HEADER_SIZE)) {
+            close(fd);
+            throw ReplayException(path + " is not a replay file");
+        }
+        mapping_size = static_cast<size_t>(info.st_size);
+        void* address = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) {
+            throw ReplayException("Cannot map replay " + path);
+        }
+        mapping = static_cast<const uint8_t*>(address);
+
+        games = get_u64(mapping + 8);
+        uint64_t directory_offset = get_u64(mapping + 16);
+        if (std::memcmp(mapping, REPLAY_MAGIC, 4) != 0 || get_u16(mapping + 4) != REPLAY_VERSION ||
+            directory_offset > mapping_size || games > (mapping_size - directory_offset) / REPLAY_DIRECTORY_ENTRY_SIZE) {
+            munmap(const_cast<uint8_t*>(mapping), mapping_size);
+            throw ReplayException(path + " is not a valid replay file");
+        }
+        directory = mapping + directory_offset;
+    }
+
+    ~ReplayFile() {
+        munmap(const_cast<uint8_t*>(mapping), mapping_size);
+    }
+
+    ReplayFile(const ReplayFile&) = delete;
+    ReplayFile& operator=(const ReplayFile&) = delete;
+
+    uint64_t game_count() const { return games; }
+
+    // The raw block of a game, bounds-checked against the mapping
+    std::pair<const uint8_t*, size_t> block(uint64_t id) const {
+        if (id >= games) {
+            throw ReplayException("Replay has no game " + std::to_string(id));
+        }
+        const uint8_t* entry = directory + REPLAY_DIRECTORY_ENTRY_SIZE * id;
+        uint64_t offset = get_u64(entry);
+        uint32_t size = get_u32(entry + 8);
+        if (offset % 4 != 0 || offset > mapping_size || size > mapping_size - offset) {
+            throw ReplayException("Replay game " + std::to_string(id) + " is out of bounds");
+        }
+        return {mapping + offset, size};
+    }
+
+    ReplayGame game(uint64_t id) const {
+        auto [data, size] = block(id);
+        return ReplayGame(data, size);
+    }
+
+    // Checks a game block against the checksum in the directory
+    bool verify(uint64_t id) const {
+        auto [data, size] = block(id);
+        return crc32(data, size) == get_u32(directory + REPLAY_DIRECTORY_ENTRY_SIZE * id + 12);
+    }
+};
+
+// Streams games into a new replay file; the directory is written by close()
+class ReplayWriter {
+private:
+    std::string path;
+    int fd;
+    uint64_t offset;
+    ReplayOptions options;
+    std::vector<uint8_t> directory;
+    std::vector<uint8_t> block;
+    std::vector<uint8_t> checkpoints;
+    std::vector<uint8_t> packed;
+
+    // Re-plays the game on a copy of its roster, recording the state every checkpoint_every turns
+    void take_checkpoints(const Game& game, const Event* events, size_t count) {
+        uint16_t checkpoint_every = options.checkpoint_every;
+        checkpoints.clear();
+        if (checkpoint_every == 0) {
+            return;
+        }
+        Game replay;
+        for (size_t i = 0; i < game.player_count(); i++) {
+            const Player* player = game.get_player(i);
+            replay.add_player(make_role_player(player->get_role(), player->get_name(), &replay));
+        }
+        size_t record = REPLAY_CHECKPOINT_BASE + REPLAY_CHECKPOINT_SEAT_SIZE * game.player_count();
+        uint32_t turns = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (events[i].action == ActionType::None) {
+                continue;
+            }
+            try {
+                perform(replay, Action{events[i].action, events[i].actor, events[i].target});
+            } catch (const std::exception& error) {
+                throw ReplayException("Cannot checkpoint game: event " + std::to_string(i) + " is rejected: " +
+                                      error.what());
+            }
+            if (events[i].action != ActionType::NextTurn || ++turns % checkpoint_every != 0) {
+                continue;
+            }
+            TableState state = capture_state(replay);
+            checkpoints.resize(checkpoints.size() + record);
+            uint8_t* out = checkpoints.data() + checkpoints.size() - record;
+            put_u32(out, static_cast<uint32_t>(i + 1));
+            out[4] = state.current;
+            out[5] = NO_TARGET;
+            for (uint8_t seat = 0; seat < state.seats; seat++) {
+                if (replay.get_last_arrested() == replay.get_player(seat)) {
+                    out[5] = seat;
+                }
+                uint8_t* entry = out + REPLAY_CHECKPOINT_BASE + REPLAY_CHECKPOINT_SEAT_SIZE * seat;
+                entry[0] = state.seat[seat].flags;
+                put_u16(entry + 2, static_cast<uint16_t>(state.seat[seat].coins));
+            }
+        }
+    }
+
+    void write_all(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw ReplayException("Cannot write replay " + path);
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    void append_block(const uint8_t* data, size_t size) {
+        uint8_t entry[REPLAY_DIRECTORY_ENTRY_SIZE];
+        put_u64(entry, offset);
+        put_u32(entry + 8, static_cast<uint32_t>(size));
+        put_u32(entry + 12, crc32(data, size));
+        directory.insert(directory.end(), entry, entry + sizeof(entry));
+        write_all(data, size);
+        offset += size;
+    }
+
+    // The packed events section: size | block offsets | coded blocks
+    void pack_events(const Event* events, size_t count) {
+        size_t blocks = (count + CODEC_BLOCK - 1) / CODEC_BLOCK;
+        packed.assign(4 + 4 * blocks, 0);
+        for (size_t b = 0; b < blocks; b++) {
+            put_u32(packed.data() + 4 + 4 * b, static_cast<uint32_t>(packed.size()));
+            encode_events(events + b * CODEC_BLOCK, std::min(CODEC_BLOCK, count - b * CODEC_BLOCK), packed);
+        }
+        put_u32(packed.data(), static_cast<uint32_t>(packed.size()));
+    }
+
+public:
+    explicit ReplayWriter(const std::string& file, const ReplayOptions& replay_options = ReplayOptions())
+        : path(file), fd(-1), offset(REPLAY_HEADER_SIZE), options(replay_options) {
+        if (options.index_stride == 0) {
+            throw std::invalid_argument("Replay index stride must be positive");
+        }
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw ReplayException("Cannot create replay " + path);
+        }
+        uint8_t header[REPLAY_HEADER_SIZE] = {};
+        write_all(header, sizeof(header));
+    }
+
+    ~ReplayWriter() {
+        if (fd >= 0) {
+            try {
+                close();
+            } catch (const ReplayException&) {
+            }
+        }
+    }
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    // Adds a game played by game's players from a fresh start; returns its id
+    uint64_t add_game(const Game& game, const Event* events, size_t count) {
+        if (game.player_count() > MAX_SEATS || count > UINT32_MAX) {
+            throw std::invalid_argument("Game is too large for a replay");
+        }
+        std::vector<uint32_t> index{0};
+        uint32_t turns = 1;
+        for (size_t i = 0; i < count; i++) {
+            if (events[i].action == ActionType::NextTurn) {
+                if (turns % options.index_stride == 0) {
+                    index.push_back(static_cast<uint32_t>(i + 1));
+                }
+                turns++;
+            }
+        }
+
+        size_t roster_size = 0;
+        for (size_t i = 0; i < game.player_count(); i++) {
+            roster_size += 2 + std::min<size_t>(game.get_player(i)->get_name().size(), 255);
+        }
+        size_t events_offset = align4(REPLAY_GAME_HEADER_SIZE + roster_size);
+        if (options.packed) {
+            pack_events(events, count);
+        }
+        size_t index_offset = align4(events_offset + (options.packed ? packed.size() : sizeof(Event) * count));
+        size_t checkpoints_offset = index_offset + 4 * index.size();
+        take_checkpoints(game, events, count);
+        block.assign(checkpoints_offset + checkpoints.size(), 0);
+
+        uint8_t* out = block.data();
+        put_u32(out, static_cast<uint32_t>(count));
+        put_u32(out + 4, turns);
+        put_u16(out + 8, options.index_stride);
+        put_u16(out + 10, static_cast<uint16_t>(roster_size));
+        out[12] = static_cast<uint8_t>(game.player_count());
+        out[13] = options.packed ? REPLAY_PACKED : REPLAY_RAW;
+        put_u16(out + 14, options.checkpoint_every);
+        uint8_t* seat = out + REPLAY_GAME_HEADER_SIZE;
+        for (size_t i = 0; i < game.player_count(); i++) {
+            const Player* player = game.get_player(i);
+            std::string name = player->get_name().substr(0, 255);
+            seat[0] = role_id(player->get_role());
+            seat[1] = static_cast<uint8_t>(name.size());
+            std::memcpy(seat + 2, name.data(), name.size());
+            seat += 2 + name.size();
+        }
+        if (options.packed) {
+            std::memcpy(out + events_offset, packed.data(), packed.size());
+        } else if (count > 0) {
+            std::memcpy(out + events_offset, events, sizeof(Event) * count);
+        }
+        for (size_t i = 0; i < index.size(); i++) {
+            put_u32(out + index_offset + 4 * i, index[i]);
+        }
+        if (!checkpoints.empty()) {
+            std::memcpy(out + checkpoints_offset, checkpoints.data(), checkpoints.size());
+        }
+        append_block(block.data(), block.size());
+        return directory.size() / REPLAY_DIRECTORY_ENTRY_SIZE - 1;
+    }
+
+    // Applies to the games added after it
+    void set_options(const ReplayOptions& replay_options) {
+        if (replay_options.index_stride == 0) {
+            throw std::invalid_argument("Replay index stride must be positive");
+        }
+        options = replay_options;
+    }
+
+    // Copies a game from another replay file as it is
+    uint64_t add_game(const ReplayGame& game) {
+        append_block(game.data(), game.size());
+        return directory.size() / REPLAY_DIRECTORY_ENTRY_SIZE - 1;
+    }
+
+    void close() {
+        if (fd < 0) {
+            return;
+        }
+        uint8_t header[REPLAY_HEADER_SIZE] = {};
+        std::memcpy(header, REPLAY_MAGIC, 4);
+        put_u16(header + 4, REPLAY_VERSION);
+        put_u64(header + 8, directory.size() / REPLAY_DIRECTORY_ENTRY_SIZE);
+        put_u64(header + 16, offset);
+        bool ok = true;
+        try {
+            write_all(directory.data(), directory.size());
+        } catch (const ReplayException&) {
+            ok = false;
+        }
+        ok = ok && pwrite(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+        ::close(fd);
+        fd = -1;
+        if (!ok) {
+            throw ReplayException("Cannot write replay " + path);
+        }
+    }
+};
+
+// Replays a game's actions through the engine and checks each one produced the
+// recorded event; throws on the first one that does not. Leaves the final state in game.
+void check_replay(const ReplayGame& replay, Game& game) {
+    replay.seat_players(game);
+    replay.scan(0, replay.event_count(), [&](size_t position, const Event& recorded) {
+        if (recorded.action == ActionType::None) {
+            return true;
+        }
+        Event replayed{};
+        try {
+            replayed = perform_event(game, Action{recorded.action, recorded.actor, recorded.target});
+        } catch (const std::exception& error) {
+            throw ReplayException("Event " + std::to_string(position) + " is rejected: " + error.what());
+        }
+        if (!(replayed == recorded)) {
+            throw ReplayException("Event " + std::to_string(position) + " does not match the recorded outcome");
+        }
+        return true;
+    });
+}
+
+// Seats the game's players into an empty game and brings it to the start of a turn:
+// restores the nearest checkpoint at or before the turn, then performs the events after it
+void restore_turn(const ReplayGame& replay, uint32_t turn, Game& game) {
+    size_t end = replay.seek_turn(turn);
+    replay.seat_players(game);
+    size_t position = 0;
+    size_t nearest = replay.checkpoint_interval() ? std::min<size_t>(turn / replay.checkpoint_interval(),
+                                                                     replay.checkpoint_count()) : 0;
+    if (nearest > 0) {
+        const uint8_t* in = replay.checkpoint(nearest);
+        position = std::min<size_t>(get_u32(in), end);
+        for (uint8_t seat = 0; seat < replay.player_count(); seat++) {
+            const uint8_t* entry = in + REPLAY_CHECKPOINT_BASE + REPLAY_CHECKPOINT_SEAT_SIZE * seat;
+            Player* player = game.get_player(seat);
+            player->add_coins(static_cast<int16_t>(get_u16(entry + 2)));
+            player->set_sanctioned(entry[0] & SEAT_SANCTIONED);
+            if (entry[0] & SEAT_ELIMINATED) {
+                player->eliminate();
+            }
+        }
+        if (in[4] >= replay.player_count()) {
+            throw ReplayException("Replay checkpoint is malformed");
+        }
+        game.set_current_index(in[4]);
+        game.set_last_arrested(in[5] < replay.player_count() ? game.get_player(in[5]) : nullptr);
+    }
+    replay.scan(position, end, [&](size_t, const Event& event) {
+        if (event.action != ActionType::None) {
+            perform(game, Action{event.action, event.actor, event.target});
+        }
+        return true;
+    });
+}
+
+// Moves a replay's board to any turn, for viewers scrubbing back and forth. A move forward
+// that starts at or after the checkpoint the target turn would restore from just performs
+// the events in between; any other move restores from that checkpoint. Either way a seek
+// performs at most about checkpoint_interval() turns of events, however long the game.
+class ReplayCursor {
+private:
+    ReplayGame replay;
+    std::unique_ptr<Game> game;
+    uint32_t at;
+    size_t position; // first event of turn at
+
+    // First turn of the checkpoint restore_turn() would start turn from
+    uint32_t restore_point(uint32_t turn) const {
+        if (replay.checkpoint_interval() == 0) {
+            return 0;
+        }
+        size_t nearest = std::min<size_t>(turn / replay.checkpoint_interval(), replay.checkpoint_count());
+        return static_cast<uint32_t>(nearest * replay.checkpoint_interval());
+    }
+
+public:
+    explicit ReplayCursor(const ReplayGame& replay_game)
+        : replay(replay_game), game(std::make_unique<Game>()), at(0), position(0) {
+        replay.seat_players(*game);
+    }
+
+    const ReplayGame& game_replay() const { return replay; }
+    const Game& board() const { return *game; }
+    uint32_t turn() const { return at; }
+    // Position of the first event of the current turn
+    size_t event_position() const { return position; }
+
+    void seek(uint32_t turn) {
+        size_t end = replay.seek_turn(turn);
+        if (turn >= at && at >= restore_point(turn)) {
+            replay.scan(position, end, [&](size_t, const Event& event) {
+                if (event.action != ActionType::None) {
+                    perform(*game, Action{event.action, event.actor, event.target});
+                }
+                return true;
+            });
+        } else {
+            auto restored = std::make_unique<Game>();
+            restore_turn(replay, turn, *restored);
+            game = std::move(restored);
+        }
+        at = turn;
+        position = end;
+    }
+};
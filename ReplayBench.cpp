@@ -0,0 +1,242 @@
+#include "Replay.cpp"
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <random>
+
+/*
+ * Replay seek and reconstruction benchmark.
+ * Records many bot games, writes them to a replay file, maps it, and times jumping to
+ * a random turn of a random game through the turn index, against scanning the game's
+ * events from the start. It then rewrites the archive with checkpoints every K turns
+ * for several K and times rebuilding the board at random turns, against file size.
+ * Finally it records one long game and times a viewer scrubbing its timeline: short
+ * drags back and forth plus jumps, with a ReplayCursor against restoring every turn, and
+ * (for a sample of the moves) against re-playing from the start with no checkpoints.
+ * Every game is re-played once to check the archive.
+ * Usage: ./replaybench [--games N] [--turns N] [--coup-at COINS] [--stride N] [--seeks N]
+ *                      [--scrub-turns N]
+ * e.g. --coup-at 1000 --turns 2000 records long games that never end early.
+ */
+
+struct RecordedGame {
+    Game game;
+    std::vector<Event> events;
+};
+
+// Plays one game with the scripted bot, recording every event. The bot holds off its
+// coups until it has coup_at coins, which sets how long games run.
+void record_game(RecordedGame& recorded, std::mt19937& rng, size_t max_turns, int coup_at) {
+    Game& game = recorded.game;
+    std::vector<Event>& events = recorded.events;
+    seat_standard_players(game);
+    events.push_back(game_started_event(game));
+    for (size_t turn = 0; turn < max_turns && !game.is_game_over(); turn++) {
+        Action action = bot_action(game, false, rng());
+        if (action.type == ActionType::Coup && game.get_player(action.actor)->get_coins() < coup_at) {
+            action.type = ActionType::Gather;
+            action.target = NO_TARGET;
+        }
+        try {
+            events.push_back(perform_event(game, action));
+        } catch (const std::exception&) {
+            events.push_back(perform_event(game, Action{ActionType::Gather, events.back().actor, NO_TARGET}));
+        }
+        if (!game.is_game_over()) {
+            events.push_back(perform_event(game, bot_action(game, true)));
+        }
+    }
+}
+
+// Writes every game to path and returns the file size in bytes
+size_t write_archive(const std::string& path, const std::vector<RecordedGame>& games, uint16_t stride,
+                     uint16_t checkpoint_every) {
+    ReplayOptions options;
+    options.index_stride = stride;
+    options.checkpoint_every = checkpoint_every;
+    ReplayWriter writer(path, options);
+    for (const auto& recorded : games) {
+        writer.add_game(recorded.game, recorded.events.data(), recorded.events.size());
+    }
+    writer.close();
+    struct stat info;
+    stat(path.c_str(), &info);
+    return static_cast<size_t>(info.st_size);
+}
+
+double percentile(std::vector<double>& samples, double fraction) {
+    size_t rank = static_cast<size_t>(fraction * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+int main(int argc, char* argv[]) {
+    size_t games = 20000;
+    size_t turns = 300;
+    size_t seeks = 200000;
+    int coup_at = 10;
+    uint16_t stride = REPLAY_DEFAULT_STRIDE;
+    size_t scrub_turns = 10000;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--games") {
+            games = std::stoul(value);
+        } else if (flag == "--turns") {
+            turns = std::stoul(value);
+        } else if (flag == "--coup-at") {
+            coup_at = std::stoi(value);
+        } else if (flag == "--stride") {
+            stride = static_cast<uint16_t>(std::stoul(value));
+        } else if (flag == "--seeks") {
+            seeks = std::stoul(value);
+        } else if (flag == "--scrub-turns") {
+            scrub_turns = std::stoul(value);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Game::next_turn() announces players who must coup; keep that off the results
+    std::ostream report(std::cout.rdbuf());
+    std::cout.setstate(std::ios_base::badbit);
+
+    std::mt19937 rng(42);
+    std::vector<RecordedGame> recorded(games);
+    for (auto& game : recorded) {
+        record_game(game, rng, turns, coup_at);
+    }
+
+    std::string path = "replaybench.cpr";
+    size_t size = write_archive(path, recorded, stride, REPLAY_DEFAULT_CHECKPOINT);
+    ReplayFile file(path);
+    size_t invalid = 0;
+    for (uint64_t id = 0; id < file.game_count(); id++) {
+        try {
+            Game game;
+            check_replay(file.game(id), game);
+        } catch (const ReplayException&) {
+            invalid++;
+        }
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> targets(seeks);
+    for (auto& target : targets) {
+        target.first = rng() % file.game_count();
+        target.second = static_cast<uint32_t>(rng() % file.game(target.first).turn_count());
+    }
+
+    // Separate passes, so neither method runs with the other's cache footprint
+    std::vector<size_t> positions(seeks);
+    std::vector<double> indexed(seeks);
+    for (size_t i = 0; i < seeks; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ReplayGame replay = file.game(targets[i].first);
+        positions[i] = replay.seek_turn(targets[i].second);
+        indexed[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::vector<double> scanned(seeks);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < seeks; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ReplayGame replay = file.game(targets[i].first);
+        size_t position = 0;
+        for (uint32_t skip = targets[i].second; skip > 0; position++) {
+            if (replay[position].action == ActionType::NextTurn) {
+                skip--;
+            }
+        }
+        scanned[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        mismatches += position != positions[i];
+    }
+
+    report << file.game_count() << " games in " << size / (1024 * 1024) << " MiB, index every " << stride
+           << " turns, " << invalid << " failed validation" << std::endl;
+    report << "indexed seek: p50 " << percentile(indexed, 0.5) << " ns, p99 " << percentile(indexed, 0.99)
+           << " ns" << std::endl;
+    report << "linear scan:  p50 " << percentile(scanned, 0.5) << " ns, p99 " << percentile(scanned, 0.99)
+           << " ns" << std::endl;
+
+    // State at a turn: K = 0 re-plays from the start and is the reference for the others
+    size_t rebuilds = std::min<size_t>(seeks, 20000);
+    std::vector<TableState> reference(rebuilds);
+    report << "state at turn (" << rebuilds << " random turns):" << std::endl;
+    for (uint16_t checkpoint_every : {0, 8, 32, 128}) {
+        size = write_archive(path, recorded, stride, checkpoint_every);
+        ReplayFile archive(path);
+        std::vector<double> rebuilt(rebuilds);
+        for (size_t i = 0; i < rebuilds; i++) {
+            auto start = std::chrono::steady_clock::now();
+            Game game;
+            restore_turn(archive.game(targets[i].first), targets[i].second, game);
+            TableState state = capture_state(game);
+            rebuilt[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            if (checkpoint_every == 0) {
+                reference[i] = state;
+            } else {
+                mismatches += state != reference[i];
+            }
+        }
+        report << "  checkpoint every " << checkpoint_every << " turns: " << size / 1024 << " KiB, p50 "
+               << percentile(rebuilt, 0.5) / 1000 << " us, p99 " << percentile(rebuilt, 0.99) / 1000 << " us"
+               << std::endl;
+    }
+
+    // Scrubbing one long game: a drag moves a few turns at a time, now and then the viewer jumps
+    std::vector<RecordedGame> long_game(1);
+    record_game(long_game[0], rng, scrub_turns, std::numeric_limits<int>::max());
+    write_archive(path, long_game, stride, REPLAY_DEFAULT_CHECKPOINT);
+    ReplayFile scrubbed(path);
+    ReplayGame timeline = scrubbed.game(0);
+    std::vector<uint32_t> drag(seeks);
+    int64_t at = 0;
+    for (auto& turn : drag) {
+        at = rng() % 50 == 0 ? static_cast<int64_t>(rng() % timeline.turn_count())
+                             : std::clamp<int64_t>(at + static_cast<int64_t>(rng() % 41) - 20, 0, timeline.turn_count());
+        turn = static_cast<uint32_t>(at);
+    }
+    ReplayCursor cursor(timeline);
+    std::vector<double> stepped(seeks);
+    std::vector<double> restored(seeks);
+    for (size_t i = 0; i < seeks; i++) {
+        auto start = std::chrono::steady_clock::now();
+        cursor.seek(drag[i]);
+        stepped[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        Game game;
+        restore_turn(timeline, drag[i], game);
+        restored[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        mismatches += capture_state(game) != capture_state(cursor.board());
+    }
+    size_t sampled = std::min<size_t>(seeks, 2000);
+    write_archive(path, long_game, stride, 0);
+    ReplayFile unchecked(path);
+    std::vector<double> replayed(sampled);
+    for (size_t i = 0; i < sampled; i++) {
+        auto start = std::chrono::steady_clock::now();
+        Game game;
+        restore_turn(unchecked.game(0), drag[i], game);
+        replayed[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    report << "scrubbing a " << timeline.turn_count() << "-turn game (" << seeks << " moves):" << std::endl;
+    report << "  cursor:        p50 " << percentile(stepped, 0.5) / 1000 << " us, p99 "
+           << percentile(stepped, 0.99) / 1000 << " us" << std::endl;
+    report << "  restore_turn:  p50 " << percentile(restored, 0.5) / 1000 << " us, p99 "
+           << percentile(restored, 0.99) / 1000 << " us" << std::endl;
+    report << "  from turn 0:   p50 " << percentile(replayed, 0.5) / 1000 << " us, p99 "
+           << percentile(replayed, 0.99) / 1000 << " us (" << sampled << " moves)" << std::endl;
+
+    if (mismatches > 0) {
+        report << "INDEXED SEEKS OR REBUILT STATES DISAGREE " << mismatches << " times" << std::endl;
+    }
+
+    unlink(path.c_str());
+    return invalid == 0 && mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "Replay.cpp"
+#include <iostream>
+
+/*
+ * Command-line tool for replay archives.
+ *   ./replaytool inspect FILE                  summary of every game in the file
+ *   ./replaytool inspect FILE GAME [--turn N]  roster and events of one game, or the board and
+ *                                              events of one turn
+ *   ./replaytool validate FILE                 checksums and re-plays every game
+ *   ./replaytool extract FILE GAME OUT         copies one game into a new replay file
+ *   ./replaytool pack FILE OUT                 rewrites every game with packed events
+ */
+
+int usage() {
+    std::cerr << "Usage: replaytool inspect FILE [GAME [--turn N]]" << std::endl;
+    std::cerr << "       replaytool validate FILE" << std::endl;
+    std::cerr << "       replaytool extract FILE GAME OUT" << std::endl;
+    std::cerr << "       replaytool pack FILE OUT" << std::endl;
+    return 2;
+}
+
+void print_events(const ReplayGame& replay, size_t from, size_t to) {
+    Game game;
+    replay.seat_players(game);
+    uint32_t turn = 0;
+    replay.scan(0, to, [&](size_t position, const Event& event) {
+        if (position >= from) {
+            std::cout << "  [" << position << "] turn " << turn << ": " << format_event(event, game) << std::endl;
+        }
+        if (event.action == ActionType::NextTurn) {
+            turn++;
+        }
+        return true;
+    });
+}
+
+// Rewrites every game with packed events, keeping each game's index and checkpoint spacing
+int pack(const ReplayFile& file, const std::string& out) {
+    ReplayWriter writer(out);
+    for (uint64_t id = 0; id < file.game_count(); id++) {
+        ReplayGame replay = file.game(id);
+        writer.set_options(ReplayOptions{replay.index_stride(), replay.checkpoint_interval(), true});
+        Game game;
+        replay.seat_players(game);
+        std::vector<Event> events = replay.all_events();
+        writer.add_game(game, events.data(), events.size());
+    }
+    writer.close();
+    return 0;
+}
+
+int inspect(const ReplayFile& file, int argc, char* argv[]) {
+    if (argc == 0) {
+        uint64_t events = 0;
+        uint64_t turns = 0;
+        for (uint64_t id = 0; id < file.game_count(); id++) {
+            ReplayGame replay = file.game(id);
+            events += replay.event_count();
+            turns += replay.turn_count();
+        }
+        std::cout << file.game_count() << " games, " << turns << " turns, " << events << " events" << std::endl;
+        return 0;
+    }
+
+    ReplayGame replay = file.game(std::stoull(argv[0]));
+    std::cout << "Game " << argv[0] << ": " << replay.event_count() << " events over " << replay.turn_count()
+              << " turns, index every " << replay.index_stride() << " turns, checkpoint every "
+              << replay.checkpoint_interval() << " turns, " << (replay.packed() ? "packed" : "raw") << " events, "
+              << replay.size() << " bytes" << std::endl;
+    std::vector<RosterEntry> roster = replay.roster();
+    for (size_t seat = 0; seat < roster.size(); seat++) {
+        std::string role = roster[seat].role < ROLE_COUNT ? ROLE_NAMES[roster[seat].role] : "?";
+        std::cout << "  seat " << seat << ": " << roster[seat].name << " (" << role << ")" << std::endl;
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--turn") {
+        uint32_t turn = static_cast<uint32_t>(std::stoul(argv[2]));
+        Game game;
+        restore_turn(replay, turn, game);
+        std::cout << "At the start of turn " << turn << ":" << std::endl;
+        for (size_t seat = 0; seat < game.player_count(); seat++) {
+            const Player* player = game.get_player(seat);
+            std::cout << "  " << (seat == game.get_current_index() ? "> " : "  ") << player->get_name() << ": "
+                      << player->get_coins() << " coins" << (player->is_sanctioned() ? ", sanctioned" : "")
+                      << (player->is_eliminated() ? ", eliminated" : "") << std::endl;
+        }
+        print_events(replay, replay.seek_turn(turn), replay.seek_turn(std::min(turn + 1, replay.turn_count())));
+    } else if (argc == 1) {
+        print_events(replay, 0, replay.event_count());
+    } else {
+        return usage();
+    }
+    return 0;
+}
+
+int validate(const ReplayFile& file) {
+    uint64_t bad = 0;
+    for (uint64_t id = 0; id < file.game_count(); id++) {
+        try {
+            if (!file.verify(id)) {
+                throw ReplayException("checksum mismatch");
+            }
+            Game game;
+            check_replay(file.game(id), game);
+        } catch (const std::exception& error) {
+            std::cout << "game " << id << ": " << error.what() << std::endl;
+            bad++;
+        }
+    }
+    std::cout << file.game_count() - bad << " of " << file.game_count() << " games valid" << std::endl;
+    return bad == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        return usage();
+    }
+    std::string command = argv[1];
+    try {
+        ReplayFile file(argv[2]);
+        if (command == "inspect") {
+            return inspect(file, argc - 3, argv + 3);
+        }
+        if (command == "validate" && argc == 3) {
+            return validate(file);
+        }
+        if (command == "extract" && argc == 5) {
+            ReplayWriter writer(argv[4]);
+            writer.add_game(file.game(std::stoull(argv[3])));
+            writer.close();
+            return 0;
+        }
+        if (command == "pack" && argc == 4) {
+            return pack(file, argv[3]);
+        }
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return usage();
+}
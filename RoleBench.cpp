@@ -0,0 +1,198 @@
+#include "RoleEngine.cpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+/*
+ * Role dispatch benchmark: the virtual Player hierarchy against VariantGame.
+ * Plays bot games on the classic engine to script them, using every role's ability as
+ * well as the common actions and keeping the moves it accepts, then replays the same actions through perform() on a
+ * Game and on a VariantGame, best of several rounds each. Both engines must refuse the
+ * same actions and end every game with the same board.
+ * Usage: ./rolebench [--games N] [--turns N] [--rounds N]
+ */
+
+// Next live seat after seat
+uint8_t next_live(const Game& game, size_t seat) {
+    for (size_t i = 1; i < game.player_count(); i++) {
+        size_t other = (seat + i) % game.player_count();
+        if (!game.get_player(other)->is_eliminated()) {
+            return static_cast<uint8_t>(other);
+        }
+    }
+    return NO_TARGET;
+}
+
+// A move the current player can mostly afford: coups at 10+ coins (or sometimes at 7),
+// otherwise a mix of gathering, taxing, the role's ability, arrests, sanctions and bribes
+Action role_move(const Game& game, uint32_t roll) {
+    uint8_t seat = static_cast<uint8_t>(game.get_current_index());
+    const Player* player = game.get_player(seat);
+    int coins = player->get_coins();
+    uint8_t target = next_live(game, (seat + roll / 8) % game.player_count());
+    if (target == seat) {
+        target = next_live(game, seat);
+    }
+    if (coins >= 10 || (coins >= 7 && roll % 5 == 0)) {
+        return Action{ActionType::Coup, seat, target};
+    }
+    ActionType type = player->is_sanctioned() ? ActionType::Bribe : ActionType::Gather;
+    switch (roll % 8) {
+        case 1: type = player->is_sanctioned() ? type : ActionType::Tax; break;
+        case 2:
+        case 3: type = special_action(player->get_role()); break;
+        case 4: type = coins >= 2 && game.get_player(target)->get_coins() > 0 ? ActionType::Arrest : type; break;
+        case 5: type = coins >= 3 ? ActionType::Sanction : type; break;
+        case 6: type = coins >= 4 ? ActionType::Bribe : type; break;
+        default: break;
+    }
+    return Action{type, seat, action_has_target(type) ? target : NO_TARGET};
+}
+
+struct Script {
+    std::vector<Action> actions;
+    std::vector<size_t> starts; // first action of each game, plus the end
+};
+
+Script script_games(size_t games, size_t turns) {
+    Script script;
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < games; i++) {
+        script.starts.push_back(script.actions.size());
+        Game game;
+        seat_standard_players(game);
+        for (size_t turn = 0; turn < turns && !game.is_game_over(); turn++) {
+            // Refused moves are left out, so the replays time dispatch rather than exceptions
+            Action action = role_move(game, rng());
+            try {
+                perform(game, action);
+                script.actions.push_back(action);
+            } catch (const std::exception&) {
+            }
+            if (!game.is_game_over()) {
+                script.actions.push_back(bot_action(game, true));
+                perform(game, script.actions.back());
+            }
+        }
+    }
+    script.starts.push_back(script.actions.size());
+    return script;
+}
+
+// Final board of a game, for comparing the engines
+struct Board {
+    std::vector<int> coins;
+    std::vector<bool> active;
+    size_t current;
+
+    bool operator==(const Board&) const = default;
+};
+
+Board board_of(const Game& game) {
+    Board board{{}, {}, game.get_current_index()};
+    for (size_t seat = 0; seat < game.player_count(); seat++) {
+        board.coins.push_back(game.get_player(seat)->get_coins());
+        board.active.push_back(!game.get_player(seat)->is_eliminated());
+    }
+    return board;
+}
+
+Board board_of(const VariantGame& game) {
+    Board board{{}, {}, game.get_current_index()};
+    for (size_t seat = 0; seat < game.player_count(); seat++) {
+        board.coins.push_back(game.state(seat).coins);
+        board.active.push_back(game.state(seat).active);
+    }
+    return board;
+}
+
+struct Timing {
+    double best = 0;
+    size_t refused = 0;
+    std::vector<Board> boards;
+};
+
+// Replays every scripted game on a fresh Engine, rounds times; keeps the fastest round
+template <typename Engine>
+Timing replay(const Script& script, size_t rounds) {
+    Timing timing;
+    for (size_t round = 0; round < rounds; round++) {
+        bool last = round + 1 == rounds;
+        size_t refused = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t g = 0; g + 1 < script.starts.size(); g++) {
+            Engine game;
+            seat_standard_players(game);
+            for (size_t i = script.starts[g]; i < script.starts[g + 1]; i++) {
+                try {
+                    if constexpr (std::is_same_v<Engine, Game>) {
+                        perform(game, script.actions[i]);
+                    } else {
+                        game.perform(script.actions[i]);
+                    }
+                } catch (const std::exception&) {
+                    refused++;
+                }
+            }
+            if (last) {
+                timing.boards.push_back(board_of(game));
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        timing.best = round == 0 ? seconds : std::min(timing.best, seconds);
+        timing.refused = refused;
+    }
+    return timing;
+}
+
+int main(int argc, char* argv[]) {
+    size_t games = 20000;
+    size_t turns = 300;
+    size_t rounds = 5;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--games") {
+            games = std::stoul(value);
+        } else if (flag == "--turns") {
+            turns = std::stoul(value);
+        } else if (flag == "--rounds") {
+            rounds = std::max<size_t>(std::stoul(value), 1);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Game::next_turn() and some abilities print; keep that off the results
+    std::ostream report(std::cout.rdbuf());
+    std::cout.setstate(std::ios_base::badbit);
+
+    Script script = script_games(games, turns);
+    size_t actions = script.actions.size();
+    report << games << " games, " << actions << " actions, best of " << rounds << " rounds" << std::endl;
+
+    Timing virtual_timing = replay<Game>(script, rounds);
+    Timing variant_timing = replay<VariantGame>(script, rounds);
+
+    auto line = [&](const char* name, const Timing& timing) {
+        report << name << static_cast<double>(actions) / timing.best / 1e6 << " M actions/s, "
+               << timing.best * 1e9 / static_cast<double>(actions) << " ns/action (" << timing.refused
+               << " refused)" << std::endl;
+    };
+    line("virtual Player*:       ", virtual_timing);
+    line("std::variant by value: ", variant_timing);
+    report << "speedup " << virtual_timing.best / variant_timing.best << "x; seat storage " << sizeof(RolePlayer)
+           << " bytes in place vs a pointer to a " << sizeof(Governor) << "-byte heap object" << std::endl;
+
+    if (virtual_timing.refused != variant_timing.refused || virtual_timing.boards != variant_timing.boards) {
+        report << "MISMATCH: the engines disagree" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,343 @@
+#pragma once
+#include "Action.cpp"
+#include "Rules.cpp"
+#include <type_traits>
+#include <variant>
+
+/*
+ * Value-typed role engine.
+ * The role set is closed, so instead of heap-allocated Players behind virtual calls, found
+ * again with dynamic_cast whenever a role's extras are needed, each seat here is a
+ * RolePlayer: a std::variant of six role structs, held by value in one vector. An action
+ * visits the actor's role once; inside, every call is on the concrete type, so
+ * Governor's tax or the Merchant's turn-end bonus is a direct call the compiler can inline,
+ * and an ability a role does not have is ruled out by `if constexpr` instead of a failed
+ * cast. Roles change the shared rules by hiding RoleState's methods.
+ * VariantGame takes the same seat-addressed Actions as perform(Game&, const Action&) and
+ * follows the same rules, checks and exceptions, so the two engines can run side by side
+ * (RoleBench.cpp). Unlike the classes in PlayerRoles.cpp it prints nothing and has no
+ * listener.
+ * Costs and payouts come from the game's rules policy (Rules.cpp). VariantGame plays
+ * the standard rules, fixed at compile time; BasicVariantGame<StaticRules<R>> compiles a
+ * house-rule variant, and BasicVariantGame<RuntimeRules> takes its rules at run time.
+ */
+
+const size_t NO_SEAT = static_cast<size_t>(-1);
+
+// State and rules shared by every role
+struct RoleState {
+    int coins = 0;
+    bool active = true;
+    bool sanctioned = false;
+
+    void remove_coins(int amount) {
+        if (coins < amount) {
+            throw InsufficientCoinsException("Not enough coins");
+        }
+        coins -= amount;
+    }
+
+    void gather(const RuleSet& rules) {
+        if (sanctioned) {
+            throw SanctionedException("Player is sanctioned and cannot gather coins");
+        }
+        coins += rules.gather;
+    }
+
+    void tax(const RuleSet& rules) {
+        if (sanctioned) {
+            throw SanctionedException("Player is sanctioned and cannot tax");
+        }
+        coins += rules.tax;
+    }
+
+    void bribe(const RuleSet& rules) {
+        if (coins < rules.bribe_cost) {
+            throw InsufficientCoinsException("Not enough coins to bribe");
+        }
+        coins -= rules.bribe_cost;
+    }
+
+    void arrest(const RuleSet& rules, RoleState& target, size_t target_seat, size_t& last_arrested) {
+        if (coins < rules.arrest_steal) {
+            throw InsufficientCoinsException("Not enough coins to arrest");
+        }
+        if (last_arrested == target_seat) {
+            throw ConsecutiveArrestException("Cannot arrest the same player in consecutive turns");
+        }
+        int stolen = std::min(target.coins, rules.arrest_steal);
+        if (stolen <= 0) {
+            throw InvalidActionException("Target player has no coins to steal");
+        }
+        target.coins -= stolen;
+        coins += stolen;
+        last_arrested = target_seat;
+    }
+
+    void sanction(const RuleSet& rules, RoleState& target) {
+        if (coins < rules.sanction_cost) {
+            throw InsufficientCoinsException("Not enough coins to sanction");
+        }
+        coins -= rules.sanction_cost;
+        target.sanctioned = true;
+    }
+
+    void coup(const RuleSet& rules, RoleState& target) {
+        if (coins < rules.coup_cost) {
+            throw InsufficientCoinsException("Not enough coins to coup");
+        }
+        coins -= rules.coup_cost;
+        target.active = false;
+    }
+
+    // Runs as the player's turn ends, after their sanction is lifted
+    void end_turn(const RuleSet&) {}
+};
+
+struct GovernorRole : RoleState {
+    void tax(const RuleSet& rules) {
+        if (sanctioned) {
+            throw SanctionedException("Player is sanctioned and cannot tax");
+        }
+        coins += rules.governor_tax;
+    }
+};
+
+struct SpyRole : RoleState {};
+
+struct BaronRole : RoleState {
+    void invest(const RuleSet& rules) {
+        if (coins < rules.invest_cost) {
+            throw InsufficientCoinsException("Not enough coins to invest");
+        }
+        coins += rules.invest_return - rules.invest_cost;
+    }
+
+    // Compensation for a sanction; as in Game::next_turn() the sanction is already
+    // lifted by the time this runs
+    void end_turn(const RuleSet& rules) {
+        if (sanctioned) {
+            coins += rules.sanction_compensation;
+        }
+    }
+};
+
+struct GeneralRole : RoleState {
+    void protect(const RuleSet& rules) {
+        if (coins < rules.protect_cost) {
+            throw InsufficientCoinsException("Not enough coins to protect");
+        }
+        coins -= rules.protect_cost;
+    }
+};
+
+struct JudgeRole : RoleState {};
+
+struct MerchantRole : RoleState {
+    void bonus(const RuleSet& rules) {
+        if (coins >= rules.merchant_bonus_at) {
+            coins += rules.merchant_bonus;
+        }
+    }
+
+    // Pays the pot instead of taking a coin from the target
+    void arrest(const RuleSet& rules, RoleState&, size_t target_seat, size_t& last_arrested) {
+        if (coins < rules.merchant_arrest_cost) {
+            throw InsufficientCoinsException("Not enough coins to arrest");
+        }
+        if (last_arrested == target_seat) {
+            throw ConsecutiveArrestException("Cannot arrest the same player in consecutive turns");
+        }
+        remove_coins(rules.merchant_arrest_cost);
+        last_arrested = target_seat;
+    }
+
+    void end_turn(const RuleSet& rules) { bonus(rules); }
+};
+
+// Alternatives in ROLE_NAMES order, so index() is the role id
+using RolePlayer = std::variant<GovernorRole, SpyRole, BaronRole, GeneralRole, JudgeRole, MerchantRole>;
+
+static_assert(std::variant_size_v<RolePlayer> == ROLE_COUNT, "RolePlayer has one alternative per role");
+
+RolePlayer make_role_state(uint8_t role) {
+    switch (role) {
+        case 0: return GovernorRole{};
+        case 1: return SpyRole{};
+        case 2: return BaronRole{};
+        case 3: return GeneralRole{};
+        case 4: return JudgeRole{};
+        case 5: return MerchantRole{};
+        default: throw std::invalid_argument("Unknown role id: " + std::to_string(role));
+    }
+}
+
+inline RoleState& role_state(RolePlayer& player) {
+    return std::visit([](auto& role) -> RoleState& { return role; }, player);
+}
+
+inline const RoleState& role_state(const RolePlayer& player) {
+    return std::visit([](const auto& role) -> const RoleState& { return role; }, player);
+}
+
+template <typename Rules = StandardRules>
+class BasicVariantGame {
+private:
+    [[no_unique_address]] Rules rules;
+    std::vector<RolePlayer> players;
+    std::vector<std::string> names;
+    size_t current = 0;
+    size_t last_arrested = NO_SEAT;
+    size_t live = 0;
+
+    [[noreturn]] void lacks(size_t seat, const char* role) const {
+        throw InvalidActionException(names[seat] + " is not a " + role);
+    }
+
+    // The actor's action, on its concrete role type
+    template <typename Role>
+    int act(Role& role, const Action& action, RoleState* target) {
+        const RuleSet& r = rules.get();
+        switch (action.type) {
+            case ActionType::Gather: role.gather(r); return 0;
+            case ActionType::Tax: role.tax(r); return 0;
+            case ActionType::Bribe: role.bribe(r); return 0;
+            case ActionType::Arrest: role.arrest(r, *target, action.target, last_arrested); return 0;
+            case ActionType::Sanction: role.sanction(r, *target); return 0;
+            case ActionType::Coup:
+                role.coup(r, *target);
+                live--;
+                return 0;
+            case ActionType::BlockTax:
+                if constexpr (std::is_same_v<Role, GovernorRole>) {
+                    return 0;
+                } else {
+                    lacks(action.actor, "Governor");
+                }
+            case ActionType::ViewCoins:
+                if constexpr (std::is_same_v<Role, SpyRole>) {
+                    return target->coins;
+                } else {
+                    lacks(action.actor, "Spy");
+                }
+            case ActionType::Invest:
+                if constexpr (std::is_same_v<Role, BaronRole>) {
+                    role.invest(r);
+                    return 0;
+                } else {
+                    lacks(action.actor, "Baron");
+                }
+            case ActionType::Protect:
+                if constexpr (std::is_same_v<Role, GeneralRole>) {
+                    role.protect(r);
+                    return 0;
+                } else {
+                    lacks(action.actor, "General");
+                }
+            case ActionType::BlockBribe:
+                if constexpr (std::is_same_v<Role, JudgeRole>) {
+                    return 0;
+                } else {
+                    lacks(action.actor, "Judge");
+                }
+            case ActionType::Bonus:
+                if constexpr (std::is_same_v<Role, MerchantRole>) {
+                    role.bonus(r);
+                    return 0;
+                } else {
+                    lacks(action.actor, "Merchant");
+                }
+            default:
+                throw InvalidActionException("Unknown action");
+        }
+    }
+
+public:
+    explicit BasicVariantGame(Rules game_rules = Rules()) : rules(game_rules) {}
+
+    const RuleSet& get_rules() const { return rules.get(); }
+
+    void add_player(uint8_t role, const std::string& name) {
+        players.push_back(make_role_state(role));
+        names.push_back(name);
+        live++;
+    }
+
+    size_t player_count() const { return players.size(); }
+    size_t get_current_index() const { return current; }
+    bool is_game_over() const { return live <= 1; }
+    // The current player has enough coins that they must coup
+    bool must_coup() const { return role_state(players[current]).coins >= rules.get().forced_coup; }
+    const std::string& name(size_t seat) const { return names.at(seat); }
+    uint8_t role(size_t seat) const { return static_cast<uint8_t>(players.at(seat).index()); }
+    const RoleState& state(size_t seat) const { return role_state(players.at(seat)); }
+
+    // Hands a player coins outside the rules, as scripts and tests do
+    void add_coins(size_t seat, int amount) {
+        if (amount < 0) {
+            throw std::invalid_argument("Cannot add negative coins");
+        }
+        role_state(players.at(seat)).coins += amount;
+    }
+
+    std::string winner() const {
+        if (!is_game_over()) {
+            throw std::runtime_error("Game is not over yet");
+        }
+        for (size_t seat = 0; seat < players.size(); seat++) {
+            if (role_state(players[seat]).active) {
+                return names[seat];
+            }
+        }
+        throw std::runtime_error("No winner found");
+    }
+
+    void next_turn() {
+        if (is_game_over()) {
+            throw GameOverException("Game is already over");
+        }
+        std::visit([&](auto& role) {
+            role.sanctioned = false;
+            role.end_turn(rules.get());
+        }, players[current]);
+        do {
+            current = (current + 1) % players.size();
+        } while (!role_state(players[current]).active);
+    }
+
+    // Runs an action on behalf of the current player, as perform(Game&, const Action&) does.
+    // Returns the coin count seen by view_coins, 0 for every other action.
+    int perform(const Action& action) {
+        if (is_game_over()) {
+            throw GameOverException("Game is already over");
+        }
+        if (action.actor != current) {
+            throw NotPlayerTurnException("It is not this player's turn");
+        }
+        RoleState* target = nullptr;
+        if (action_has_target(action.type)) {
+            if (action.target >= players.size() || action.target == action.actor) {
+                throw InvalidActionException("Invalid target player");
+            }
+            target = &role_state(players[action.target]);
+            if (!target->active) {
+                throw InvalidActionException("Target player is eliminated");
+            }
+        }
+        if (action.type == ActionType::NextTurn) {
+            next_turn();
+            return 0;
+        }
+        return std::visit([&](auto& role) { return act(role, action, target); }, players[action.actor]);
+    }
+};
+
+using VariantGame = BasicVariantGame<>;
+
+// Seats the six standard roles, as seat_standard_players() does for a Game
+template <typename Rules>
+void seat_standard_players(BasicVariantGame<Rules>& game) {
+    for (uint8_t i = 0; i < ROLE_COUNT; i++) {
+        game.add_player(i, standard_name(i));
+    }
+}
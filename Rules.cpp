@@ -0,0 +1,113 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+
+/*
+ * Rule parameters: what actions cost and pay.
+ * The classic engine (Player.cpp, PlayerRoles.cpp, Game.cpp) plays STANDARD_RULES. The
+ * value-typed engine in RoleEngine.cpp takes its rules as a policy: StaticRules<R> bakes a
+ * RuleSet in at compile time, so a house-rule variant compiles to its own code with every
+ * cost folded into a constant, while RuntimeRules reads a RuleSet chosen at run time
+ * (e.g. parsed by parse_rules()) for variants nobody compiled in.
+ * RuleSet is a structural type, so a constexpr RuleSet can be a template argument.
+ */
+
+struct RuleSet {
+    int gather = 1;
+    int tax = 2;
+    int arrest_steal = 1;          // most an arrest takes from its target
+    int governor_tax = 3;
+    int bribe_cost = 4;
+    int sanction_cost = 3;
+    int sanction_penalty = 1;      // Judge makes a sanctioning player pay this more
+    int coup_cost = 7;
+    int forced_coup = 10;          // a player starting a turn with this many coins must coup
+    int invest_cost = 3;           // Baron
+    int invest_return = 6;
+    int sanction_compensation = 1; // Baron, for a turn spent sanctioned
+    int protect_cost = 5;          // General
+    int arrest_recovery = 1;       // General, regained after being arrested
+    int merchant_bonus_at = 3;     // Merchant's bonus needs this many coins
+    int merchant_bonus = 1;
+    int merchant_arrest_cost = 2;  // Merchant pays this to the pot instead of taking a coin
+
+    bool operator==(const RuleSet&) const = default;
+};
+
+constexpr RuleSet STANDARD_RULES{};
+
+// Rules fixed at compile time; reads of get() fold to constants once inlined
+template <RuleSet R>
+struct StaticRules {
+    static constexpr RuleSet rules = R;
+    static constexpr const RuleSet& get() { return rules; }
+};
+
+using StandardRules = StaticRules<STANDARD_RULES>;
+
+// Rules chosen at run time
+struct RuntimeRules {
+    RuleSet rules;
+    const RuleSet& get() const { return rules; }
+};
+
+struct RuleField {
+    const char* name;
+    int RuleSet::*field;
+};
+
+const RuleField RULE_FIELDS[] = {
+    {"gather", &RuleSet::gather},
+    {"tax", &RuleSet::tax},
+    {"arrest_steal", &RuleSet::arrest_steal},
+    {"governor_tax", &RuleSet::governor_tax},
+    {"bribe_cost", &RuleSet::bribe_cost},
+    {"sanction_cost", &RuleSet::sanction_cost},
+    {"sanction_penalty", &RuleSet::sanction_penalty},
+    {"coup_cost", &RuleSet::coup_cost},
+    {"forced_coup", &RuleSet::forced_coup},
+    {"invest_cost", &RuleSet::invest_cost},
+    {"invest_return", &RuleSet::invest_return},
+    {"sanction_compensation", &RuleSet::sanction_compensation},
+    {"protect_cost", &RuleSet::protect_cost},
+    {"arrest_recovery", &RuleSet::arrest_recovery},
+    {"merchant_bonus_at", &RuleSet::merchant_bonus_at},
+    {"merchant_bonus", &RuleSet::merchant_bonus},
+    {"merchant_arrest_cost", &RuleSet::merchant_arrest_cost},
+};
+
+// Standard rules changed by a comma-separated list of name=value, e.g. "coup_cost=5,tax=3"
+RuleSet parse_rules(const std::string& spec) {
+    RuleSet rules = STANDARD_RULES;
+    size_t start = 0;
+    while (start < spec.size()) {
+        size_t end = spec.find(',', start);
+        if (end == std::string::npos) {
+            end = spec.size();
+        }
+        std::string item = spec.substr(start, end - start);
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Expected name=value, got '" + item + "'");
+        }
+        std::string name = item.substr(0, equals);
+        int* value = nullptr;
+        for (const RuleField& field : RULE_FIELDS) {
+            if (name == field.name) {
+                value = &(rules.*field.field);
+            }
+        }
+        if (!value) {
+            throw std::invalid_argument("Unknown rule '" + name + "'");
+        }
+        size_t used = 0;
+        std::string number = item.substr(equals + 1);
+        int parsed = std::stoi(number, &used);
+        if (used != number.size() || parsed < 0) {
+            throw std::invalid_argument("Bad value for " + name + ": '" + number + "'");
+        }
+        *value = parsed;
+        start = end + 1;
+    }
+    return rules;
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include "Protocol.cpp"
+#include <string_view>
+
+/*
+ * Saved games: a versioned binary image of a Game and its Players.
+ *   header: magic "CPG1" | version u16 | seat_size u16 | size u32 | seats u16 | current u16
+ *           | last_arrested u16 | reserved u16
+ *   seats:  per seat, seat_size bytes: coins i32 | flags u8 | reserved u8 | last_arrested u16
+ *           | name_len u16 | role_len u16 | strings u32 (offset of the name, followed by the role)
+ *   then the names and roles.
+ * Seat numbers of 0xFFFF mean nobody; flags use SEAT_SANCTIONED and SEAT_ELIMINATED.
+ * Everything is little-endian. save_game() computes the size first and writes straight
+ * into the caller's buffer. SavedGame checks every bound once and then reads fields in
+ * place, handing names and roles out as views into the buffer, so inspecting a save
+ * copies nothing. Later versions may append fields to each seat (seat_size says how
+ * far apart seats are), which older readers skip.
+ */
+
+const char SAVE_MAGIC[4] = {'C', 'P', 'G', '1'};
+const uint16_t SAVE_VERSION = 1;
+const size_t SAVE_HEADER_SIZE = 20;
+const size_t SAVE_SEAT_SIZE = 16;
+const uint16_t SAVE_NO_SEAT = 0xFFFF;
+
+class SaveException : public std::runtime_error {
+public:
+    SaveException(const std::string& message) : std::runtime_error(message) {}
+};
+
+inline uint16_t save_seat_of(const Game& game, const Player* player) {
+    for (size_t i = 0; i < game.player_count(); i++) {
+        if (game.get_player(i) == player) {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    return SAVE_NO_SEAT;
+}
+
+// Bytes save_game() needs for the game
+size_t saved_size(const Game& game) {
+    size_t size = SAVE_HEADER_SIZE + SAVE_SEAT_SIZE * game.player_count();
+    for (size_t i = 0; i < game.player_count(); i++) {
+        size += game.get_player(i)->get_name().size() + game.get_player(i)->get_role().size();
+    }
+    return size;
+}
+
+// Writes the game into out, which must hold saved_size(game) bytes; returns the size
+size_t save_game(const Game& game, uint8_t* out, size_t capacity) {
+    size_t size = saved_size(game);
+    if (size > capacity) {
+        throw std::length_error("Save buffer is too small");
+    }
+    if (game.player_count() >= SAVE_NO_SEAT || size > UINT32_MAX) {
+        throw std::length_error("Game is too large to save");
+    }
+    std::memcpy(out, SAVE_MAGIC, 4);
+    put_u16(out + 4, SAVE_VERSION);
+    put_u16(out + 6, static_cast<uint16_t>(SAVE_SEAT_SIZE));
+    put_u32(out + 8, static_cast<uint32_t>(size));
+    put_u16(out + 12, static_cast<uint16_t>(game.player_count()));
+    put_u16(out + 14, static_cast<uint16_t>(game.get_current_index()));
+    put_u16(out + 16, save_seat_of(game, game.get_last_arrested()));
+    put_u16(out + 18, 0);
+
+    size_t strings = SAVE_HEADER_SIZE + SAVE_SEAT_SIZE * game.player_count();
+    for (size_t i = 0; i < game.player_count(); i++) {
+        const Player* player = game.get_player(i);
+        const std::string& name = player->get_name();
+        const std::string& role = player->get_role();
+        if (name.size() > UINT16_MAX || role.size() > UINT16_MAX) {
+            throw std::length_error("Player name or role is too long to save");
+        }
+        uint8_t* seat = out + SAVE_HEADER_SIZE + SAVE_SEAT_SIZE * i;
+        put_u32(seat, static_cast<uint32_t>(player->get_coins()));
+        seat[4] = static_cast<uint8_t>((player->is_sanctioned() ? SEAT_SANCTIONED : 0) |
+                                       (player->is_eliminated() ? SEAT_ELIMINATED : 0));
+        seat[5] = 0;
+        put_u16(seat + 6, save_seat_of(game, player->get_last_arrested()));
+        put_u16(seat + 8, static_cast<uint16_t>(name.size()));
+        put_u16(seat + 10, static_cast<uint16_t>(role.size()));
+        put_u32(seat + 12, static_cast<uint32_t>(strings));
+        std::memcpy(out + strings, name.data(), name.size());
+        std::memcpy(out + strings + name.size(), role.data(), role.size());
+        strings += name.size() + role.size();
+    }
+    return size;
+}
+
+// Appends the saved game to out
+size_t save_game(const Game& game, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + saved_size(game));
+    return save_game(game, out.data() + start, out.size() - start);
+}
+
+// Read-only view of one seat of a saved game
+class SavedSeat {
+private:
+    const uint8_t* base;
+    const uint8_t* seat;
+
+public:
+    SavedSeat(const uint8_t* data, const uint8_t* record) : base(data), seat(record) {}
+
+    int32_t coins() const { return static_cast<int32_t>(get_u32(seat)); }
+    bool sanctioned() const { return seat[4] & SEAT_SANCTIONED; }
+    bool eliminated() const { return seat[4] & SEAT_ELIMINATED; }
+    uint16_t last_arrested() const { return get_u16(seat + 6); }
+    std::string_view name() const {
+        return std::string_view(reinterpret_cast<const char*>(base + get_u32(seat + 12)), get_u16(seat + 8));
+    }
+    std::string_view role() const {
+        return std::string_view(reinterpret_cast<const char*>(base + get_u32(seat + 12) + get_u16(seat + 8)),
+                                get_u16(seat + 10));
+    }
+};
+
+// Read-only view of a saved game; the buffer must outlive it
+class SavedGame {
+private:
+    const uint8_t* data;
+    size_t seat_size;
+    uint16_t seats;
+
+public:
+    SavedGame(const uint8_t* buffer, size_t size) : data(buffer) {
+        if (size < SAVE_HEADER_SIZE || std::memcmp(data, SAVE_MAGIC, 4) != 0) {
+            throw SaveException("Not a saved game");
+        }
+        if (version() == 0 || version() > SAVE_VERSION) {
+            throw SaveException("Saved game version " + std::to_string(version()) + " is not supported");
+        }
+        seat_size = get_u16(data + 6);
+        seats = get_u16(data + 12);
+        size_t saved = get_u32(data + 8);
+        if (saved > size) {
+            throw SaveException("Saved game is truncated");
+        }
+        if (seat_size < SAVE_SEAT_SIZE || SAVE_HEADER_SIZE + seat_size * seats > saved || seats == SAVE_NO_SEAT ||
+            (seats > 0 && current() >= seats) || (last_arrested() >= seats && last_arrested() != SAVE_NO_SEAT)) {
+            throw SaveException("Saved game is malformed");
+        }
+        for (uint16_t i = 0; i < seats; i++) {
+            const uint8_t* record = seat_record(i);
+            size_t strings = get_u32(record + 12);
+            uint16_t arrested = get_u16(record + 6);
+            if (strings > saved || saved - strings < static_cast<size_t>(get_u16(record + 8)) + get_u16(record + 10) ||
+                (arrested >= seats && arrested != SAVE_NO_SEAT)) {
+                throw SaveException("Saved seat " + std::to_string(i) + " is malformed");
+            }
+        }
+    }
+
+    const uint8_t* seat_record(uint16_t seat) const { return data + SAVE_HEADER_SIZE + seat_size * seat; }
+
+    uint16_t version() const { return get_u16(data + 4); }
+    size_t size() const { return get_u32(data + 8); }
+    uint16_t seat_count() const { return seats; }
+    uint16_t current() const { return get_u16(data + 14); }
+    uint16_t last_arrested() const { return get_u16(data + 16); }
+    SavedSeat seat(uint16_t seat) const {
+        if (seat >= seats) {
+            throw std::out_of_range("Saved game has no seat " + std::to_string(seat));
+        }
+        return SavedSeat(data, seat_record(seat));
+    }
+};
+
+// Seats the saved players into an empty game and restores the table as it was saved
+void load_game(const SavedGame& saved, Game& game) {
+    if (game.player_count() != 0) {
+        throw std::logic_error("Can only load into an empty game");
+    }
+    for (uint16_t i = 0; i < saved.seat_count(); i++) {
+        SavedSeat seat = saved.seat(i);
+        std::string name(seat.name());
+        std::string role(seat.role());
+        // Roles other than the standard six load as plain players, as Game's copy does
+        Player* player = role_id(role) != NO_ROLE ? make_role_player(role, name, &game) : new Player(name, role, &game);
+        game.add_player(player);
+        if (seat.coins() < 0) {
+            throw SaveException("Saved seat " + std::to_string(i) + " has negative coins");
+        }
+        player->add_coins(seat.coins());
+        player->set_sanctioned(seat.sanctioned());
+        if (seat.eliminated()) {
+            player->eliminate();
+        }
+    }
+    for (uint16_t i = 0; i < saved.seat_count(); i++) {
+        uint16_t arrested = saved.seat(i).last_arrested();
+        game.get_player(i)->set_last_arrested(arrested == SAVE_NO_SEAT ? nullptr : game.get_player(arrested));
+    }
+    game.set_current_index(saved.current());
+    game.set_last_arrested(saved.last_arrested() == SAVE_NO_SEAT ? nullptr : game.get_player(saved.last_arrested()));
+}
@@ -0,0 +1,423 @@
+#pragma once
+#include "Protocol.cpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+/*
+ * Scenario language for scripted games and regression checks.
+ * A scenario file is read a line at a time; '#' starts a comment. A file holds any
+ * number of scenarios, each starting from an empty table:
+ *   scenario NAME...               starts a scenario; the rest of the line is its name
+ *   player NAME ROLE               seats a player (Governor, Spy, Baron, General, Judge, Merchant)
+ *   NAME ACTION [TARGET]           the player acts (gather, tax, bribe, arrest, sanction, coup,
+ *                                  block_tax, view_coins, invest, protect, block_bribe, bonus)
+ *   NAME ACTION [TARGET] fails [E] the action must be refused, with error E if given (invalid,
+ *                                  insufficient_coins, sanctioned, consecutive_arrest, game_over,
+ *                                  not_player_turn)
+ *   next                           passes the turn
+ *   give NAME N                    hands the player N coins
+ *   expect NAME N                  the player has N coins
+ *   expect NAME STATE              sanctioned, free (not sanctioned), eliminated or active
+ *   expect turn NAME               it is the player's turn
+ *   expect winner NAME             the game is over and the player won
+ *   expect seen N                  the last view_coins saw N coins
+ *   say TEXT...                    narration, passed to the listener; {seen} in the text
+ *                                  stands for what the last view_coins saw
+ *   show                           asks the listener to show the table
+ * Actions go straight to the player, as hand-written scripts call them: whose turn it is
+ * is only checked by `expect turn`. compile_scenarios() resolves every name, role and
+ * action once and emits 8-byte instructions with seat numbers for operands, so
+ * run_scenario() is a switch over a flat array with no string handling on the way.
+ * Narration and names live in a string pool, and source lines in an array of their own
+ * that is only read when a check fails.
+ */
+
+class ScenarioException : public std::runtime_error {
+public:
+    ScenarioException(const std::string& message) : std::runtime_error(message) {}
+};
+
+enum class ScenarioOp : uint8_t {
+    Begin,        // value: name string; clears the table
+    Seat,         // a: role id, value: name string
+    Act,          // a: action, b: actor, c: target
+    ActFails,     // a: action, b: actor, c: target, value: expected ErrorCode, 0 for any
+    Next,
+    Give,         // b: seat, value: coins
+    ExpectCoins,  // b: seat, value: coins
+    ExpectState,  // b: seat, a: ScenarioState
+    ExpectTurn,   // b: seat
+    ExpectWinner, // b: seat
+    ExpectSeen,   // value: coins
+    Say,          // value: text string
+    SaySeen,      // value: text before {seen}, followed in the pool by the text after it
+    Show,
+    End
+};
+
+enum class ScenarioState : uint8_t { Sanctioned, Free, Eliminated, Active };
+
+struct ScenarioInstruction {
+    ScenarioOp op;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+    int32_t value;
+};
+
+static_assert(sizeof(ScenarioInstruction) == 8, "Scenario instructions are 8 bytes");
+
+struct ScenarioProgram {
+    std::string source;
+    std::vector<ScenarioInstruction> code;
+    std::vector<uint32_t> lines;      // source line of each instruction
+    std::vector<std::string> strings; // names and narration
+    std::vector<size_t> entries;      // Begin instruction of each scenario
+
+    size_t size() const { return entries.size(); }
+    const std::string& name(size_t scenario) const { return strings[code[entries[scenario]].value]; }
+};
+
+struct ScenarioResult {
+    bool passed;
+    uint32_t line; // of the failed check
+    std::string message;
+};
+
+// Receives a scenario's narration while it runs
+class ScenarioListener {
+public:
+    virtual ~ScenarioListener() {}
+    virtual void say(const std::string& text) = 0;
+    virtual void show(const Game& game) = 0;
+    // An action failed as the scenario expected
+    virtual void refused(const std::string& what) = 0;
+};
+
+const char* const SCENARIO_ERRORS[] = {"invalid", "insufficient_coins", "sanctioned", "consecutive_arrest",
+                                       "game_over", "not_player_turn"};
+const char* const SCENARIO_STATES[] = {"sanctioned", "free", "eliminated", "active"};
+
+class ScenarioCompiler {
+private:
+    ScenarioProgram program;
+    std::vector<std::string> players; // seated in the current scenario
+    uint32_t line = 0;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw ScenarioException(program.source + ":" + std::to_string(line) + ": " + message);
+    }
+
+    void emit(ScenarioOp op, uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, int32_t value = 0) {
+        if (program.entries.empty()) {
+            fail("expected 'scenario' first");
+        }
+        program.code.push_back(ScenarioInstruction{op, a, b, c, value});
+        program.lines.push_back(line);
+    }
+
+    int32_t intern(const std::string& text) {
+        program.strings.push_back(text);
+        return static_cast<int32_t>(program.strings.size() - 1);
+    }
+
+    uint8_t seat(const std::string& name) const {
+        for (size_t i = 0; i < players.size(); i++) {
+            if (players[i] == name) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        fail("unknown player '" + name + "'");
+    }
+
+    int32_t number(const std::string& token) const {
+        int32_t value = 0;
+        auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (error != std::errc() || end != token.data() + token.size()) {
+            fail("expected a number, got '" + token + "'");
+        }
+        return value;
+    }
+
+    template <size_t N>
+    uint8_t keyword(const std::string& token, const char* const (&names)[N], const char* what) const {
+        for (size_t i = 0; i < N; i++) {
+            if (token == names[i]) {
+                return static_cast<uint8_t>(i);
+            }
+        }
+        fail("unknown " + std::string(what) + " '" + token + "'");
+    }
+
+    void expect_count(const std::vector<std::string>& words, size_t count) const {
+        if (words.size() != count) {
+            fail("'" + words[0] + "' takes " + std::to_string(count - 1) + " argument" + (count == 2 ? "" : "s"));
+        }
+    }
+
+    // The rest of the line after its first word
+    static std::string rest(const std::string& text) {
+        size_t start = text.find_first_not_of(" \t");
+        start = text.find_first_of(" \t", start);
+        start = text.find_first_not_of(" \t", start);
+        size_t end = text.find_last_not_of(" \t\r");
+        return start == std::string::npos ? "" : text.substr(start, end - start + 1);
+    }
+
+    void statement(const std::string& text, const std::vector<std::string>& words) {
+        const std::string& head = words[0];
+        if (head == "scenario") {
+            players.clear();
+            program.entries.push_back(program.code.size());
+            emit(ScenarioOp::Begin, 0, 0, 0, intern(rest(text)));
+        } else if (head == "player") {
+            expect_count(words, 3);
+            static const char* const reserved[] = {"scenario", "player", "next", "give", "expect",
+                                                   "say", "show", "turn", "winner", "seen"};
+            for (const char* word : reserved) {
+                if (words[1] == word) {
+                    fail("'" + words[1] + "' cannot be a player name");
+                }
+            }
+            if (std::find(players.begin(), players.end(), words[1]) != players.end()) {
+                fail("player '" + words[1] + "' is already seated");
+            }
+            uint8_t role = role_id(words[2]);
+            if (role == NO_ROLE) {
+                fail("unknown role '" + words[2] + "'");
+            }
+            if (players.size() + 1 >= NO_TARGET) {
+                fail("too many players");
+            }
+            emit(ScenarioOp::Seat, role, 0, 0, intern(words[1]));
+            players.push_back(words[1]);
+        } else if (head == "next") {
+            expect_count(words, 1);
+            if (players.empty()) {
+                fail("'next' needs a seated player");
+            }
+            emit(ScenarioOp::Next);
+        } else if (head == "give") {
+            expect_count(words, 3);
+            int32_t coins = number(words[2]);
+            if (coins < 0) {
+                fail("cannot give a negative number of coins");
+            }
+            emit(ScenarioOp::Give, 0, seat(words[1]), 0, coins);
+        } else if (head == "expect") {
+            expect_count(words, 3);
+            if (words[1] == "turn") {
+                emit(ScenarioOp::ExpectTurn, 0, seat(words[2]));
+            } else if (words[1] == "winner") {
+                emit(ScenarioOp::ExpectWinner, 0, seat(words[2]));
+            } else if (words[1] == "seen") {
+                emit(ScenarioOp::ExpectSeen, 0, 0, 0, number(words[2]));
+            } else if (!words[2].empty() && (std::isdigit(static_cast<unsigned char>(words[2][0])) || words[2][0] == '-')) {
+                emit(ScenarioOp::ExpectCoins, 0, seat(words[1]), 0, number(words[2]));
+            } else {
+                emit(ScenarioOp::ExpectState, keyword(words[2], SCENARIO_STATES, "state"), seat(words[1]));
+            }
+        } else if (head == "say") {
+            std::string said = rest(text);
+            size_t seen = said.find("{seen}");
+            if (seen == std::string::npos) {
+                emit(ScenarioOp::Say, 0, 0, 0, intern(said));
+            } else {
+                emit(ScenarioOp::SaySeen, 0, 0, 0, intern(said.substr(0, seen)));
+                intern(said.substr(seen + 6));
+            }
+        } else if (head == "show") {
+            expect_count(words, 1);
+            emit(ScenarioOp::Show);
+        } else {
+            action(words);
+        }
+    }
+
+    // NAME ACTION [TARGET] [fails [ERROR]]
+    void action(const std::vector<std::string>& words) {
+        uint8_t actor = seat(words[0]);
+        if (words.size() < 2) {
+            fail("expected an action after '" + words[0] + "'");
+        }
+        ActionType type = action_from_name(words[1]);
+        if (type == ActionType::None || type == ActionType::NextTurn) {
+            fail("unknown action '" + words[1] + "'");
+        }
+        size_t at = 2;
+        uint8_t target = NO_TARGET;
+        if (action_has_target(type)) {
+            if (words.size() <= at) {
+                fail("'" + words[1] + "' needs a target");
+            }
+            target = seat(words[at++]);
+        }
+        if (words.size() == at) {
+            emit(ScenarioOp::Act, static_cast<uint8_t>(type), actor, target);
+            return;
+        }
+        if (words[at] != "fails" || words.size() > at + 2) {
+            fail("unexpected '" + words[at] + "'");
+        }
+        int32_t error = 0;
+        if (words.size() == at + 2) {
+            error = keyword(words[at + 1], SCENARIO_ERRORS, "error") + static_cast<int32_t>(ErrorCode::InvalidAction);
+        }
+        emit(ScenarioOp::ActFails, static_cast<uint8_t>(type), actor, target, error);
+    }
+
+public:
+    explicit ScenarioCompiler(const std::string& source) { program.source = source; }
+
+    ScenarioProgram compile(const std::string& text) {
+        std::istringstream in(text);
+        std::string raw;
+        while (std::getline(in, raw)) {
+            line++;
+            std::string code = raw.substr(0, raw.find('#'));
+            std::istringstream split(code);
+            std::vector<std::string> words;
+            for (std::string word; split >> word;) {
+                words.push_back(word);
+            }
+            if (!words.empty()) {
+                statement(code, words);
+            }
+        }
+        line++;
+        if (!program.entries.empty()) {
+            emit(ScenarioOp::End);
+        }
+        return std::move(program);
+    }
+};
+
+// Compiles scenario source; source names it in error messages
+ScenarioProgram compile_scenarios(const std::string& text, const std::string& source = "<scenario>") {
+    return ScenarioCompiler(source).compile(text);
+}
+
+ScenarioProgram load_scenarios(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw ScenarioException("Cannot open " + path);
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return compile_scenarios(text.str(), path);
+}
+
+// Runs one scenario of a program, stopping at the first check that fails
+ScenarioResult run_scenario(const ScenarioProgram& program, size_t scenario, ScenarioListener* listener = nullptr) {
+    Game game;
+    int seen = 0;
+    const ScenarioInstruction* code = program.code.data();
+    size_t pc = program.entries.at(scenario) + 1;
+    auto failed = [&](const std::string& message) {
+        return ScenarioResult{false, program.lines[pc], message};
+    };
+    auto name = [&](uint8_t seat) { return game.get_player(seat)->get_name(); };
+
+    for (;; pc++) {
+        const ScenarioInstruction& in = code[pc];
+        switch (in.op) {
+            case ScenarioOp::Seat:
+                game.add_player(make_role_player(ROLE_NAMES[in.a], program.strings[in.value], &game));
+                break;
+            case ScenarioOp::Act:
+            case ScenarioOp::ActFails: {
+                ActionType type = static_cast<ActionType>(in.a);
+                Player* target = in.c == NO_TARGET ? nullptr : game.get_player(in.c);
+                try {
+                    int result = apply_action(game, type, *game.get_player(in.b), target);
+                    if (type == ActionType::ViewCoins) {
+                        seen = result;
+                    }
+                } catch (const std::exception& e) {
+                    if (in.op == ScenarioOp::Act) {
+                        return failed(name(in.b) + " " + action_name(type) + ": " + e.what());
+                    }
+                    if (in.value != 0 && static_cast<int32_t>(error_code_for(e)) != in.value) {
+                        return failed(name(in.b) + " " + action_name(type) + " failed with '" + e.what() +
+                                      "', expected " + SCENARIO_ERRORS[in.value - 1]);
+                    }
+                    if (listener) {
+                        listener->refused(e.what());
+                    }
+                    break;
+                }
+                if (in.op == ScenarioOp::ActFails) {
+                    return failed(name(in.b) + " " + action_name(type) + " was expected to fail");
+                }
+                break;
+            }
+            case ScenarioOp::Next:
+                try {
+                    game.next_turn();
+                } catch (const std::exception& e) {
+                    return failed(std::string("next: ") + e.what());
+                }
+                break;
+            case ScenarioOp::Give:
+                game.get_player(in.b)->add_coins(in.value);
+                break;
+            case ScenarioOp::ExpectCoins:
+                if (game.get_player(in.b)->get_coins() != in.value) {
+                    return failed("expected " + name(in.b) + " to have " + std::to_string(in.value) + " coins, has " +
+                                  std::to_string(game.get_player(in.b)->get_coins()));
+                }
+                break;
+            case ScenarioOp::ExpectState: {
+                const Player* player = game.get_player(in.b);
+                bool holds = false;
+                switch (static_cast<ScenarioState>(in.a)) {
+                    case ScenarioState::Sanctioned: holds = player->is_sanctioned(); break;
+                    case ScenarioState::Free: holds = !player->is_sanctioned(); break;
+                    case ScenarioState::Eliminated: holds = player->is_eliminated(); break;
+                    case ScenarioState::Active: holds = !player->is_eliminated(); break;
+                }
+                if (!holds) {
+                    return failed("expected " + name(in.b) + " to be " + SCENARIO_STATES[in.a]);
+                }
+                break;
+            }
+            case ScenarioOp::ExpectTurn:
+                if (game.is_game_over() || game.get_current_index() != in.b) {
+                    return failed("expected it to be " + name(in.b) + "'s turn");
+                }
+                break;
+            case ScenarioOp::ExpectWinner:
+                if (!game.is_game_over() || game.player_count() == 0 || game.winner() != name(in.b)) {
+                    return failed("expected " + name(in.b) + " to have won");
+                }
+                break;
+            case ScenarioOp::ExpectSeen:
+                if (seen != in.value) {
+                    return failed("expected view_coins to see " + std::to_string(in.value) + " coins, saw " +
+                                  std::to_string(seen));
+                }
+                break;
+            case ScenarioOp::Say:
+                if (listener) {
+                    listener->say(program.strings[in.value]);
+                }
+                break;
+            case ScenarioOp::SaySeen:
+                if (listener) {
+                    listener->say(program.strings[in.value] + std::to_string(seen) + program.strings[in.value + 1]);
+                }
+                break;
+            case ScenarioOp::Show:
+                if (listener) {
+                    listener->show(game);
+                }
+                break;
+            case ScenarioOp::Begin:
+            case ScenarioOp::End:
+                return ScenarioResult{true, 0, ""};
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include "Scenario.cpp"
+#include <chrono>
+#include <iostream>
+
+/*
+ * Regression runner for scenario files (Scenario.cpp).
+ * Compiles every file once, runs each scenario --repeat times and reports the ones that
+ * fail with their file and line, then the compile time and how many scenarios ran a
+ * second. Exits with 1 if any scenario failed.
+ * Usage: ./scenario [--repeat N] FILE...
+ */
+
+int main(int argc, char* argv[]) {
+    size_t repeat = 1;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max<size_t>(std::stoul(argv[++i]), 1);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty()) {
+        std::cerr << "Usage: scenario [--repeat N] FILE..." << std::endl;
+        return 2;
+    }
+
+    // Game::next_turn() and some abilities print; keep that off the results
+    std::ostream report(std::cout.rdbuf());
+    std::cout.setstate(std::ios_base::badbit);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ScenarioProgram> programs;
+    size_t instructions = 0;
+    try {
+        for (const auto& path : paths) {
+            programs.push_back(load_scenarios(path));
+            instructions += programs.back().code.size();
+        }
+    } catch (const ScenarioException& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    double compiled = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t runs = 0;
+    size_t failures = 0;
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < repeat; round++) {
+        for (const auto& program : programs) {
+            for (size_t i = 0; i < program.size(); i++) {
+                ScenarioResult result = run_scenario(program, i);
+                runs++;
+                if (!result.passed && round == 0) {
+                    failures++;
+                    report << program.source << ":" << result.line << ": " << program.name(i) << ": "
+                           << result.message << std::endl;
+                }
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    report << runs / repeat << " scenarios from " << programs.size() << " files (" << instructions
+           << " instructions, compiled in " << compiled * 1000 << " ms), " << failures << " failed" << std::endl;
+    report << runs << " runs in " << seconds << " s: " << static_cast<double>(runs) / seconds << " scenarios/s"
+           << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Single-writer sequence lock for publishing small, trivially copyable values.
+ * The writer bumps the sequence to odd, stores the value, then bumps it to even;
+ * readers copy the value and retry if the sequence was odd or changed meanwhile.
+ * Readers never block the writer and never take a lock, and the writer never waits
+ * for readers. The value is stored as relaxed atomic words, so a torn read is
+ * detected and retried rather than being a data race.
+ */
+
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock values must be trivially copyable");
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint64_t> words[WORDS];
+
+public:
+    Seqlock() : sequence(0) {
+        for (auto& word : words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    explicit Seqlock(const T& value) : Seqlock() {
+        publish(value);
+    }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Only one thread may publish at a time
+    void publish(const T& value) {
+        uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        uint32_t start = sequence.load(std::memory_order_relaxed);
+        sequence.store(start + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(start + 2, std::memory_order_release);
+    }
+
+    // Safe from any thread; returns the most recently completed publish
+    T read() const {
+        uint64_t buffer[WORDS];
+        uint32_t before, after;
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    // Number of completed publishes
+    uint32_t version() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
@@ -0,0 +1,99 @@
+#include "GameServer.cpp"
+#include <csignal>
+
+// Totals read from every table's published state while the tables keep running
+void print_stats(const GameServer& server) {
+    uint64_t players = 0;
+    int64_t coins = 0;
+    for (uint32_t table = 0; table < server.table_count(); table++) {
+        TableState state = server.table_view(table);
+        for (uint8_t seat = 0; seat < state.seats; seat++) {
+            if (!(state.seat[seat].flags & SEAT_ELIMINATED)) {
+                players++;
+                coins += state.seat[seat].coins;
+            }
+        }
+    }
+    std::cout << players << " players in play holding " << coins << " coins" << std::endl;
+}
+
+// Runs the multi-table game server until SIGINT/SIGTERM
+// Usage: ./server [--port N] [--unix PATH] [--threads N] [--workers N] [--tables N]
+//                 [--journal PATH] [--durability-us N] [--snapshot PATH] [--snapshot-every SECONDS]
+//                 [--stats SECONDS]
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    long stats_interval = 0;
+    config.threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    config.workers = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--port") {
+            config.port = static_cast<uint16_t>(std::stoi(value));
+        } else if (flag == "--unix") {
+            config.unix_path = value;
+        } else if (flag == "--threads") {
+            config.threads = std::stoul(value);
+        } else if (flag == "--workers") {
+            config.workers = std::stoul(value);
+        } else if (flag == "--tables") {
+            config.tables = std::stoul(value);
+        } else if (flag == "--journal") {
+            config.journal_path = value;
+        } else if (flag == "--durability-us") {
+            config.durability_window = std::chrono::microseconds(std::stol(value));
+        } else if (flag == "--snapshot") {
+            config.snapshot_path = value;
+        } else if (flag == "--snapshot-every") {
+            config.snapshot_interval = std::chrono::seconds(std::stol(value));
+        } else if (flag == "--stats") {
+            stats_interval = std::stol(value);
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    // Block shutdown signals in every thread so main can wait for them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        GameServer server(config);
+        if (!config.journal_path.empty()) {
+            std::cout << "Replayed " << server.recovered_events() << " journal events from " << config.journal_path << std::endl;
+        }
+        server.start();
+        std::cout << "Serving " << server.table_count() << " tables on "
+                  << config.threads << " I/O loops and " << config.workers
+                  << " workers (port " << config.port;
+        if (!config.unix_path.empty()) {
+            std::cout << ", socket " << config.unix_path;
+        }
+        std::cout << ")" << std::endl;
+
+        if (stats_interval > 0) {
+            timespec timeout{stats_interval, 0};
+            while (sigtimedwait(&signals, nullptr, &timeout) < 0) {
+                print_stats(server);
+            }
+        } else {
+            int received = 0;
+            sigwait(&signals, &received);
+        }
+        std::cout << "Shutting down" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
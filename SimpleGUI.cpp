@@ -2,282 +2,400 @@
 #include <string>
 #include <vector>
 #include <algorithm>
-#include "Game.cpp"
+#include <limits>
+#include <chrono>
+#include <random>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "EventLog.cpp"
+#include "Terminal.cpp"
+
+// Simple console-based UI for the Coup game. Every screen (the table, the history, the
+// menu and its prompt) is drawn as one frame through a TerminalRenderer, which rewrites
+// only the lines that changed since the last frame and flushes once.
+// Given a CommandReader the UI runs in batch mode: menu choices come from the command
+// stream instead of the keyboard, and games are played back to back until it ends.
+
+// What a batch run got through
+struct ConsoleStats {
+    size_t games = 0;     // played to the end
+    size_t abandoned = 0; // left with 0 at the action menu
+    size_t actions = 0;   // performed by the engine
+    size_t rejected = 0;  // refused by the engine, or not a menu choice
+    size_t frames = 0;
+};
 
-// Simple console-based UI for the Coup game
 class ConsoleUI {
 private:
+    static constexpr size_t HISTORY_ROWS = 10;
+
     Game game;
-    std::vector<std::string> history;
+    EventLog history{16};
+    TerminalRenderer screen;
+    CommandReader* commands; // null when reading the keyboard
+    bool inputEnded = false;
+    ConsoleStats stats;
+    // Shown above the menu until the next action, e.g. why the last one was refused
+    std::string notice;
 
-    void addToHistory(const std::string& action) {
-        history.push_back(action);
-        if (history.size() > 10) {
-            history.erase(history.begin());
-        }
+    // Seats a fresh table of the six standard roles
+    void newGame() {
+        game = Game();
+        seat_standard_players(game);
+        history.clear();
+        history.append(game_started_event(game));
+        notice.clear();
+    }
+
+    // Runs an action for the current player and logs what it did
+    void record(ActionType type, uint8_t target = NO_TARGET) {
+        uint8_t actor = static_cast<uint8_t>(game.get_current_index());
+        history.append(perform_event(game, Action{type, actor, target}));
+        stats.actions++;
     }
 
     void displayHistory() {
-        std::cout << "\n===== Game History =====\n";
-        for (const auto& entry : history) {
-            std::cout << "- " << entry << std::endl;
+        screen.line("");
+        screen.line("===== Game History =====");
+        uint64_t start = history.end() - std::min<uint64_t>(history.size(), HISTORY_ROWS);
+        for (uint64_t i = start; i < history.end(); i++) {
+            screen.line("- " + format_event(history.at(i), game));
+        }
+        // Keep the history's height fixed, so the lines below it stay where they are
+        for (uint64_t i = history.end() - start; i < HISTORY_ROWS; i++) {
+            screen.line("");
         }
-        std::cout << "========================\n";
+        screen.line("========================");
     }
 
     void displayPlayerInfo(Player* player, bool isCurrent) {
         std::string prefix = isCurrent ? "-> " : "   ";
-        std::string status = player->is_eliminated() ? " [ELIMINATED]" : 
+        std::string status = player->is_eliminated() ? " [ELIMINATED]" :
                              player->is_sanctioned() ? " [SANCTIONED]" : "";
-        
-        std::cout << prefix << player->get_name() << " (" 
-                  << player->get_role() << ") - " 
-                  << player->get_coins() << " coins" 
-                  << status << std::endl;
+
+        screen.line(prefix + player->get_name() + " (" + player->get_role() + ") - " +
+                    std::to_string(player->get_coins()) + " coins" + status);
     }
 
     void displayGameState() {
-        std::cout << "\n===== Game State =====\n";
-        
+        screen.line("===== Game State =====");
+
         if (game.is_game_over()) {
-            std::cout << "Game Over! Winner: " << game.winner() << std::endl;
+            screen.line("Game Over! Winner: " + game.winner());
         } else {
-            std::cout << "Current Player: " << game.turn() << std::endl;
+            screen.line("Current Player: " + game.turn());
         }
-        
-        std::cout << "\nPlayers:\n";
-        for (const auto& name : game.players_list()) {
-            Player* player = game.get_player_by_name(name);
-            bool isCurrent = (name == game.turn());
-            displayPlayerInfo(player, isCurrent);
+
+        screen.line("");
+        screen.line("Players:");
+        for (size_t seat = 0; seat < game.player_count(); seat++) {
+            Player* player = game.get_player(seat);
+            if (!player->is_eliminated()) {
+                displayPlayerInfo(player, seat == game.get_current_index());
+            }
+        }
+
+        screen.line("=====================");
+    }
+
+    // Draws the table, the history, any notice, then the menu with its prompt
+    void drawFrame(const std::vector<std::string>& menu, const std::string& prompt) {
+        winsize size;
+        screen.set_rows(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 ? size.ws_row : 0);
+        screen.begin();
+        screen.line("=== Welcome to Coup Game ===");
+        screen.line("");
+        displayGameState();
+        displayHistory();
+        screen.line(notice);
+        for (const auto& item : menu) {
+            screen.line(item);
+        }
+        screen.line("");
+        screen.line(prompt);
+        screen.present();
+        stats.frames++;
+    }
+
+    // Reads a number typed after the prompt (or the next one in the command stream);
+    // -1 if it was not one, 0 at the end of input
+    int readChoice() {
+        int choice = -1;
+        if (commands) {
+            if (!commands->next(choice)) {
+                inputEnded = true;
+                return 0;
+            }
+        } else if (!(std::cin >> choice)) {
+            if (std::cin.eof()) {
+                return 0;
+            }
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            choice = -1;
         }
-        
-        std::cout << "=====================\n";
+        screen.input_taken();
+        return choice;
     }
 
     std::string getPlayerRoleSpecialAbility(const std::string& role) {
         if (role == "Governor") return "Block Tax";
         if (role == "Spy") return "View Coins";
-        if (role == "Baron") return "Invest (3 coins -> 6 coins)";
-        if (role == "General") return "Protect from Coup (5 coins)";
+        if (role == "Baron") {
+            return "Invest (" + std::to_string(STANDARD_RULES.invest_cost) + " coins -> " +
+                   std::to_string(STANDARD_RULES.invest_return) + " coins)";
+        }
+        if (role == "General") return "Protect from Coup (" + std::to_string(STANDARD_RULES.protect_cost) + " coins)";
         if (role == "Judge") return "Block Bribe";
         if (role == "Merchant") return "Get Bonus Coin";
         return "None";
     }
 
-    Player* selectTarget() {
-        std::vector<std::string> playerNames = game.players_list();
-        std::string currentPlayer = game.turn();
-        
-        // Remove current player from the list
-        playerNames.erase(std::remove(playerNames.begin(), playerNames.end(), currentPlayer), playerNames.end());
-        
-        if (playerNames.empty()) {
-            std::cout << "No other players to target!" << std::endl;
-            return nullptr;
+    // Returns the chosen target's seat, or NO_TARGET
+    uint8_t selectTarget() {
+        std::vector<uint8_t> seats;
+        std::vector<std::string> menu{"Select target player:"};
+        for (size_t seat = 0; seat < game.player_count(); seat++) {
+            const Player* player = game.get_player(seat);
+            if (seat != game.get_current_index() && !player->is_eliminated()) {
+                seats.push_back(static_cast<uint8_t>(seat));
+                menu.push_back(std::to_string(seats.size()) + ". " + player->get_name());
+            }
         }
-        
-        std::cout << "Select target player:\n";
-        for (size_t i = 0; i < playerNames.size(); i++) {
-            std::cout << (i + 1) << ". " << playerNames[i] << std::endl;
+
+        if (seats.empty()) {
+            notice = "No other players to target!";
+            return NO_TARGET;
         }
-        
-        int choice;
-        std::cout << "Enter choice (1-" << playerNames.size() << "): ";
-        std::cin >> choice;
-        
-        if (choice < 1 || choice > static_cast<int>(playerNames.size())) {
-            std::cout << "Invalid choice!" << std::endl;
-            return nullptr;
+
+        drawFrame(menu, "Enter choice (1-" + std::to_string(seats.size()) + "): ");
+        int choice = readChoice();
+
+        if (choice < 1 || choice > static_cast<int>(seats.size())) {
+            notice = "Invalid choice!";
+            stats.rejected++;
+            return NO_TARGET;
         }
-        
-        return game.get_player_by_name(playerNames[choice - 1]);
+
+        return seats[choice - 1];
     }
 
     void performSpecialAbility(Player* player) {
-        std::string role = player->get_role();
-        
-        if (role == "Governor") {
-            Player* target = selectTarget();
-            if (target) {
-                dynamic_cast<Governor*>(player)->block_tax(*target);
-                addToHistory(player->get_name() + " (Governor) blocked " + target->get_name() + "'s tax action");
-            }
-        } 
-        else if (role == "Spy") {
-            Player* target = selectTarget();
-            if (target) {
-                int coins = dynamic_cast<Spy*>(player)->view_coins(*target);
-                addToHistory(player->get_name() + " (Spy) viewed that " + target->get_name() + " has " + std::to_string(coins) + " coins");
-            }
-        }
-        else if (role == "Baron") {
-            try {
-                dynamic_cast<Baron*>(player)->invest();
-                addToHistory(player->get_name() + " (Baron) invested 3 coins to get 6 coins");
-            } catch (const std::exception& e) {
-                std::cout << "Error: " << e.what() << std::endl;
+        ActionType ability = special_action(player->get_role());
+        uint8_t target = NO_TARGET;
+        if (action_has_target(ability)) {
+            target = selectTarget();
+            if (target == NO_TARGET) {
+                return;
             }
         }
-        else if (role == "General") {
-            Player* target = selectTarget();
-            if (target) {
-                try {
-                    dynamic_cast<General*>(player)->protect(*target);
-                    addToHistory(player->get_name() + " (General) protected " + target->get_name() + " from a coup");
-                } catch (const std::exception& e) {
-                    std::cout << "Error: " << e.what() << std::endl;
-                }
-            }
+        record(ability, target);
+    }
+
+    // Actions that need a target are skipped if none was chosen
+    void recordTargeted(ActionType type) {
+        uint8_t target = selectTarget();
+        if (target != NO_TARGET) {
+            record(type, target);
         }
-        else if (role == "Judge") {
-            Player* target = selectTarget();
-            if (target) {
-                dynamic_cast<Judge*>(player)->block_bribe(*target);
-                addToHistory(player->get_name() + " (Judge) blocked " + target->get_name() + "'s bribe");
+    }
+
+    // Shows the action menu and carries out one choice; false if the player chose to exit
+    bool playTurn() {
+        Player* currentPlayer = game.get_current_player();
+        std::string currentPlayerRole = currentPlayer->get_role();
+
+        // Display available actions
+        const RuleSet& rules = STANDARD_RULES;
+        drawFrame({"Available Actions:",
+                   "1. Gather (take " + std::to_string(rules.gather) + " coin)",
+                   "2. Tax (take " + std::to_string(rules.tax) + "-" + std::to_string(rules.governor_tax) + " coins)",
+                   "3. Bribe (pay " + std::to_string(rules.bribe_cost) + " coins)",
+                   "4. Arrest (steal " + std::to_string(rules.arrest_steal) + " coin from another player)",
+                   "5. Sanction (prevent player from economic actions, costs " + std::to_string(rules.sanction_cost) + " coins)",
+                   "6. Coup (eliminate player, costs " + std::to_string(rules.coup_cost) + " coins)",
+                   "7. Special: " + getPlayerRoleSpecialAbility(currentPlayerRole),
+                   "8. Next Turn",
+                   "0. Exit Game"},
+                  "Enter choice (0-8): ");
+
+        // Get player choice
+        int choice = readChoice();
+        notice.clear();
+
+        try {
+            switch (choice) {
+                case 0: // Exit
+                    return false;
+
+                case 1: // Gather
+                    record(ActionType::Gather);
+                    break;
+
+                case 2: // Tax
+                    record(ActionType::Tax);
+                    break;
+
+                case 3: // Bribe
+                    record(ActionType::Bribe);
+                    break;
+
+                case 4: // Arrest
+                    recordTargeted(ActionType::Arrest);
+                    break;
+
+                case 5: // Sanction
+                    recordTargeted(ActionType::Sanction);
+                    break;
+
+                case 6: // Coup
+                    recordTargeted(ActionType::Coup);
+                    break;
+
+                case 7: // Special ability
+                    performSpecialAbility(currentPlayer);
+                    break;
+
+                case 8: // Next turn
+                    record(ActionType::NextTurn);
+                    break;
+
+                default:
+                    notice = "Invalid choice!";
+                    stats.rejected++;
             }
+        } catch (const std::exception& e) {
+            notice = std::string("Error: ") + e.what();
+            stats.rejected++;
         }
-        else if (role == "Merchant") {
-            dynamic_cast<Merchant*>(player)->bonus();
-            addToHistory(player->get_name() + " (Merchant) received a bonus coin");
-        }
+        return true;
+    }
+
+    void showWinner() {
+        notice.clear();
+        drawFrame({}, "Game Over! " + game.winner() + " is the winner!");
     }
 
 public:
-    ConsoleUI() {
-        // Create players with different roles
-        Player* alice = new Governor("Alice", &game);
-        Player* bob = new Spy("Bob", &game);
-        Player* charlie = new Baron("Charlie", &game);
-        Player* diana = new General("Diana", &game);
-        Player* ethan = new Judge("Ethan", &game);
-        Player* fiona = new Merchant("Fiona", &game);
-        
-        // Add players to game
-        game.add_player(alice);
-        game.add_player(bob);
-        game.add_player(charlie);
-        game.add_player(diana);
-        game.add_player(ethan);
-        game.add_player(fiona);
-        
-        addToHistory("Game started with 6 players");
+    explicit ConsoleUI(CommandReader* script = nullptr)
+        : screen(std::cout, isatty(STDOUT_FILENO)), commands(script) {
+        newGame();
     }
-    
+
     void run() {
         while (!game.is_game_over()) {
-            displayGameState();
-            displayHistory();
-            
-            Player* currentPlayer = game.get_current_player();
-            std::string currentPlayerName = currentPlayer->get_name();
-            std::string currentPlayerRole = currentPlayer->get_role();
-            
-            // Display available actions
-            std::cout << "\nAvailable Actions:\n";
-            std::cout << "1. Gather (take 1 coin)\n";
-            std::cout << "2. Tax (take 2-3 coins)\n";
-            std::cout << "3. Bribe (pay 4 coins)\n";
-            std::cout << "4. Arrest (steal 1 coin from another player)\n";
-            std::cout << "5. Sanction (prevent player from economic actions, costs 3 coins)\n";
-            std::cout << "6. Coup (eliminate player, costs 7 coins)\n";
-            std::cout << "7. Special: " << getPlayerRoleSpecialAbility(currentPlayerRole) << "\n";
-            std::cout << "8. Next Turn\n";
-            std::cout << "0. Exit Game\n";
-            
-            // Get player choice
-            int choice;
-            std::cout << "\nEnter choice (0-8): ";
-            std::cin >> choice;
-            
-            try {
-                switch (choice) {
-                    case 0: // Exit
-                        std::cout << "Exiting game..." << std::endl;
-                        return;
-                        
-                    case 1: // Gather
-                        currentPlayer->gather();
-                        addToHistory(currentPlayerName + " gathered 1 coin");
-                        break;
-                        
-                    case 2: // Tax
-                        currentPlayer->tax();
-                        if (currentPlayerRole == "Governor") {
-                            addToHistory(currentPlayerName + " (Governor) taxed 3 coins");
-                        } else {
-                            addToHistory(currentPlayerName + " taxed 2 coins");
-                        }
-                        break;
-                        
-                    case 3: // Bribe
-                        currentPlayer->bribe();
-                        addToHistory(currentPlayerName + " paid 4 coins to bribe");
-                        break;
-                        
-                    case 4: { // Arrest
-                        Player* target = selectTarget();
-                        if (target) {
-                            currentPlayer->arrest(*target);
-                            addToHistory(currentPlayerName + " arrested " + target->get_name() + " and stole 1 coin");
-                        }
-                        break;
-                    }
-                    
-                    case 5: { // Sanction
-                        Player* target = selectTarget();
-                        if (target) {
-                            currentPlayer->sanction(*target);
-                            addToHistory(currentPlayerName + " sanctioned " + target->get_name());
-                        }
-                        break;
-                    }
-                    
-                    case 6: { // Coup
-                        Player* target = selectTarget();
-                        if (target) {
-                            currentPlayer->coup(*target);
-                            addToHistory(currentPlayerName + " performed a coup on " + target->get_name() + " and eliminated them");
-                        }
-                        break;
-                    }
-                    
-                    case 7: // Special ability
-                        performSpecialAbility(currentPlayer);
-                        break;
-                        
-                    case 8: // Next turn
-                        game.next_turn();
-                        addToHistory(currentPlayerName + "'s turn ended. Now " + game.turn() + "'s turn.");
-                        break;
-                        
-                    default:
-                        std::cout << "Invalid choice!" << std::endl;
-                }
-            } catch (const std::exception& e) {
-                std::cout << "Error: " << e.what() << std::endl;
-                std::cout << "Press Enter to continue...";
-                std::cin.ignore();
-                std::cin.get();
+            if (!playTurn()) {
+                std::cout << "\nExiting game..." << std::endl;
+                return;
             }
-            
-            // Check if game is over after each action
-            if (game.is_game_over()) {
-                displayGameState();
-                displayHistory();
-                std::cout << "\nGame Over! " << game.winner() << " is the winner!" << std::endl;
+        }
+        showWinner();
+        std::cout << std::endl;
+    }
+
+    // Batch mode: plays games from the command stream until it ends. A game that is won
+    // is followed by a new one; 0 at the action menu abandons the game in progress.
+    const ConsoleStats& runBatch() {
+        while (true) {
+            bool exited = !playTurn();
+            if (inputEnded) {
                 break;
             }
+            if (game.is_game_over()) {
+                showWinner();
+                stats.games++;
+                newGame();
+            } else if (exited) {
+                stats.abandoned++;
+                newGame();
+            }
         }
+        return stats;
     }
 };
 
-int main() {
-    std::cout << "=== Welcome to Coup Game ===\n" << std::endl;
-    
+// Writes the menu choices that play games bot games through the console, for batch mode.
+// The bot is the one the benchmarks use; each line is one turn, its move and then 8.
+void writeBotCommands(std::ostream& out, size_t games) {
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < games; i++) {
+        Game game;
+        seat_standard_players(game);
+        out << "# game " << i + 1 << '\n';
+        while (!game.is_game_over()) {
+            Action action = bot_action(game, false, rng());
+            // The target menu lists the other live players in seat order
+            size_t choice = 1;
+            for (uint8_t seat = 0; action.target != NO_TARGET && seat < action.target; seat++) {
+                if (seat != action.actor && !game.get_player(seat)->is_eliminated()) {
+                    choice++;
+                }
+            }
+            try {
+                perform(game, action);
+                switch (action.type) {
+                    case ActionType::Gather: out << "1 "; break;
+                    case ActionType::Tax:    out << "2 "; break;
+                    case ActionType::Coup:   out << "6 " << choice << ' '; break;
+                    default: break;
+                }
+            } catch (const std::exception&) {
+                // Not allowed; the turn just passes
+            }
+            if (!game.is_game_over()) {
+                perform(game, bot_action(game, true));
+                out << "8\n";
+            }
+        }
+    }
+}
+
+// Usage: ./console                      play at the keyboard
+//        ./console --batch [FILE]       play the menu choices in FILE (default: stdin)
+//        ./console --generate GAMES     write the choices for GAMES bot games
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--generate") {
+        std::cout.sync_with_stdio(false);
+        writeBotCommands(std::cout, argc > 2 ? std::stoul(argv[2]) : 1000);
+        return 0;
+    }
+    if (mode == "--batch") {
+        int fd = STDIN_FILENO;
+        if (argc > 2 && std::string(argv[2]) != "-") {
+            fd = open(argv[2], O_RDONLY);
+            if (fd < 0) {
+                std::cerr << "Cannot open " << argv[2] << std::endl;
+                return 1;
+            }
+        }
+        // Frames are still built, but nothing is printed except the results
+        std::ostream report(std::cout.rdbuf());
+        std::cout.setstate(std::ios_base::badbit);
+
+        CommandReader commands(fd);
+        ConsoleUI ui(&commands);
+        auto start = std::chrono::steady_clock::now();
+        ConsoleStats stats = ui.runBatch();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        report << stats.games << " games played (" << stats.abandoned << " abandoned), " << stats.actions
+               << " actions, " << stats.rejected << " rejected, " << stats.frames << " frames in " << seconds
+               << " s" << std::endl;
+        report << static_cast<double>(stats.games) / seconds << " games/s, "
+               << static_cast<double>(stats.actions) / seconds << " actions/s, "
+               << static_cast<double>(stats.frames) / seconds << " frames/s" << std::endl;
+        return 0;
+    }
+    if (!mode.empty()) {
+        std::cerr << "Unknown option " << mode << std::endl;
+        return 1;
+    }
+
     ConsoleUI ui;
     ui.run();
-    
+
     std::cout << "\nThanks for playing!" << std::endl;
     return 0;
-}
\ No newline at end of file
+}
@@ -8,56 +8,92 @@
 #include <QPushButton>
 #include <QComboBox>
 #include <QRadioButton>
-#include <QTextEdit>
+#include <QPlainTextEdit>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QSlider>
+#include <QLineEdit>
+#include <QTableView>
+#include <QHeaderView>
+#include <QListView>
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+#include <QColor>
 #include <QMessageBox>
-#include <QScrollBar>
 #include <QList>
+#include <QStyle>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <algorithm>
+#include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
-#include "Game.cpp"
-
-// Simple game logger class
-class GameLogger {
-private:
-    std::vector<std::string> history;
-
-public:
-    void log(const std::string& action) {
-        history.push_back(action);
-    }
-
-    std::vector<std::string> get_history() const {
-        return history;
-    }
-
-    void clear() {
-        history.clear();
-    }
-};
+#include <unordered_map>
+#include "EngineThread.cpp"
+#include "Replay.cpp"
+
+// The history view keeps this many lines; older ones are dropped as new ones arrive
+const int HISTORY_LINES = 1000;
+// The window applies the engine's updates once per frame, about 60 times a second
+const int FRAME_MS = 16;
+// Bot turns a second when autoplaying
+const uint32_t AUTOPLAY_RATE = 10000;
+// Tables with more than MAX_SEATS seats are large tables, drawn as a grid. --players sets
+// the size.
+const size_t MAX_PLAYERS = 1000;
 
 // Forward declaration
 class GameWindow;
 
-// Widget to display player info
+// "1 coin", "3 coins"
+QString coinCount(int amount) {
+    return QString("%1 %2").arg(amount).arg(QString(amount == 1 ? "coin" : "coins"));
+}
+
+// Players' boxes are styled by their "state" property, so a change re-polishes one widget
+// instead of parsing a new style sheet
+const char* const PLAYER_STATES[] = {"waiting", "current", "eliminated"};
+const char* const PLAYER_STYLES =
+    "QGroupBox#player { background-color: white; border: 1px solid gray; }"
+    "QGroupBox#player[state=\"current\"] { background-color: #ccffcc; border: 2px solid green; }"
+    "QGroupBox#player[state=\"eliminated\"] { background-color: #ffcccc; border: 1px solid gray; }";
+
+// Widget to display player info; replays show seats that have no Player, through display()
 class PlayerWidget : public QGroupBox {
 private:
+    enum State { Waiting, Current, Eliminated };
+
     Player* player;
+    std::string name;
     QLabel* roleLabel;
     QLabel* coinsLabel;
     QLabel* statusLabel;
     bool isHighlighted;
+    // What the widget shows now, so display() only touches what changed
+    int shownCoins;
+    bool shownSanctioned;
+    State shownState;
 
 public:
-    PlayerWidget(Player* player, QWidget* parent = nullptr) 
-        : QGroupBox(QString::fromStdString(player->get_name()), parent), player(player), isHighlighted(false) {
+    PlayerWidget(Player* player, QWidget* parent = nullptr)
+        : PlayerWidget(player->get_name(), player->get_role(), parent) {
+        this->player = player;
+        refresh();
+    }
+
+    PlayerWidget(const std::string& name, const std::string& role, QWidget* parent = nullptr)
+        : QGroupBox(QString::fromStdString(name), parent), player(nullptr), name(name), isHighlighted(false),
+          shownCoins(0), shownSanctioned(false), shownState(Waiting) {
+        setObjectName("player");
+        setProperty("state", PLAYER_STATES[Waiting]);
         
         QVBoxLayout* layout = new QVBoxLayout(this);
         
-        roleLabel = new QLabel(QString("Role: %1").arg(QString::fromStdString(player->get_role())));
-        coinsLabel = new QLabel(QString("Coins: %1").arg(player->get_coins()));
+        roleLabel = new QLabel(QString("Role: %1").arg(QString::fromStdString(role)));
+        coinsLabel = new QLabel("Coins: 0");
         
-        std::string statusText = player->is_sanctioned() ? "SANCTIONED" : "";
-        statusLabel = new QLabel(QString::fromStdString(statusText));
+        statusLabel = new QLabel("");
         statusLabel->setStyleSheet("color: red;");
         
         layout->addWidget(roleLabel);
@@ -69,26 +105,33 @@ public:
         setMinimumHeight(100);
     }
 
-    void update() {
-        coinsLabel->setText(QString("Coins: %1").arg(player->get_coins()));
-        std::string statusText = player->is_sanctioned() ? "SANCTIONED" : "";
-        statusLabel->setText(QString::fromStdString(statusText));
-        
-        if (player->is_eliminated()) {
-            setStyleSheet("background-color: #ffcccc; border: 1px solid gray;");
-            setTitle(QString::fromStdString(player->get_name() + " (ELIMINATED)"));
-        } else if (isHighlighted) {
-            setStyleSheet("background-color: #ccffcc; border: 2px solid green;");
-            setTitle(QString::fromStdString(player->get_name() + " (CURRENT)"));
-        } else {
-            setStyleSheet("background-color: white; border: 1px solid gray;");
-            setTitle(QString::fromStdString(player->get_name()));
+    void display(int coins, bool sanctioned, bool eliminated, bool current) {
+        if (coins != shownCoins) {
+            shownCoins = coins;
+            coinsLabel->setText(QString("Coins: %1").arg(shownCoins));
+        }
+        if (sanctioned != shownSanctioned) {
+            shownSanctioned = sanctioned;
+            statusLabel->setText(shownSanctioned ? "SANCTIONED" : "");
         }
+        State state = eliminated ? Eliminated : current ? Current : Waiting;
+        if (state != shownState) {
+            shownState = state;
+            const char* suffix = state == Eliminated ? " (ELIMINATED)" : state == Current ? " (CURRENT)" : "";
+            setTitle(QString::fromStdString(name + suffix));
+            setProperty("state", PLAYER_STATES[state]);
+            style()->unpolish(this);
+            style()->polish(this);
+        }
+    }
+
+    void refresh() {
+        display(player->get_coins(), player->is_sanctioned(), player->is_eliminated(), isHighlighted);
     }
 
     void highlight(bool highlight) {
         isHighlighted = highlight;
-        update();
+        refresh();
     }
 
     Player* getPlayer() const {
@@ -96,11 +139,119 @@ public:
     }
 };
 
+// The seats as a table model. Views ask only for the rows they show, so a grid of a
+// thousand players costs what its visible rows cost; seatsChanged() names the rows
+// they must ask for again.
+class PlayerTableModel : public QAbstractTableModel {
+private:
+    Game* game;
+
+public:
+    enum Column { NameColumn, RoleColumn, CoinsColumn, StatusColumn, ColumnCount };
+
+    PlayerTableModel(Game* game, QObject* parent = nullptr) : QAbstractTableModel(parent), game(game) {}
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : static_cast<int>(game->player_count());
+    }
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : ColumnCount;
+    }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid()) {
+            return QVariant();
+        }
+        const Player* player = game->get_player(static_cast<size_t>(index.row()));
+        bool current = static_cast<size_t>(index.row()) == game->get_current_index();
+        if (role == Qt::DisplayRole) {
+            switch (index.column()) {
+                case NameColumn: return QString::fromStdString(player->get_name());
+                case RoleColumn: return QString::fromStdString(player->get_role());
+                case CoinsColumn: return player->get_coins();
+                case StatusColumn:
+                    return player->is_eliminated() ? "ELIMINATED"
+                           : player->is_sanctioned() ? (current ? "CURRENT, SANCTIONED" : "SANCTIONED")
+                           : current ? "CURRENT" : "";
+            }
+        } else if (role == Qt::BackgroundRole) {
+            if (player->is_eliminated()) {
+                return QColor("#ffcccc");
+            }
+            if (current) {
+                return QColor("#ccffcc");
+            }
+        }
+        return QVariant();
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
+        if (role != Qt::DisplayRole) {
+            return QVariant();
+        }
+        if (orientation == Qt::Vertical) {
+            return section + 1;
+        }
+        const char* const headers[] = {"Player", "Role", "Coins", "Status"};
+        return section < ColumnCount ? headers[section] : "";
+    }
+
+    // Tells the views which seats changed; runs of neighbouring seats go out as one range
+    void seatsChanged(std::vector<size_t>& seats) {
+        std::sort(seats.begin(), seats.end());
+        for (size_t i = 0; i < seats.size();) {
+            size_t last = i;
+            while (last + 1 < seats.size() && seats[last + 1] == seats[last] + 1) {
+                last++;
+            }
+            emit dataChanged(index(static_cast<int>(seats[i]), 0),
+                             index(static_cast<int>(seats[last]), ColumnCount - 1));
+            i = last + 1;
+        }
+    }
+};
+
+// The players the current one may target, narrowed to names containing the search text.
+// Eliminations reach it through the model's dataChanged(); a new turn calls turnChanged().
+class TargetFilter : public QSortFilterProxyModel {
+private:
+    Game* game;
+
+public:
+    TargetFilter(Game* game, PlayerTableModel* seats, QObject* parent = nullptr)
+        : QSortFilterProxyModel(parent), game(game) {
+        setSourceModel(seats);
+        setFilterKeyColumn(PlayerTableModel::NameColumn);
+        setFilterCaseSensitivity(Qt::CaseInsensitive);
+    }
+
+    void turnChanged() { invalidateFilter(); }
+
+    // Seat of the filtered row, or game->player_count() if there is none
+    size_t seatAt(int row) const {
+        if (row < 0 || row >= rowCount()) {
+            return game->player_count();
+        }
+        return static_cast<size_t>(mapToSource(index(row, 0)).row());
+    }
+
+protected:
+    bool filterAcceptsRow(int row, const QModelIndex& parent) const override {
+        size_t seat = static_cast<size_t>(row);
+        if (seat == game->get_current_index() || game->get_player(seat)->is_eliminated()) {
+            return false;
+        }
+        return QSortFilterProxyModel::filterAcceptsRow(row, parent);
+    }
+};
+
 // Widget for game actions
 class ActionPanel : public QGroupBox {
 private:
     Game* game;
-    GameLogger* logger;
+    TargetFilter* targets;
+    QLineEdit* targetSearch;
     QComboBox* playerSelector;
     QRadioButton* gatherAction;
     QRadioButton* taxAction;
@@ -113,25 +264,39 @@ private:
     GameWindow* gameWindow;
 
 public:
-    ActionPanel(Game* game, GameLogger* logger, GameWindow* gameWindow, QWidget* parent = nullptr);
+    ActionPanel(Game* game, PlayerTableModel* seats, GameWindow* gameWindow, QWidget* parent = nullptr);
     void executeAction();
     void updateSpecialActionLabel();
+    void refreshTargets();
 };
 
-// Main game window
-class GameWindow : public QMainWindow {
+// Main game window; as the game's listener it notes which seats changed, and
+// updateGameState() redraws only those
+class GameWindow : public QMainWindow, public GameListener {
 private:
     Game game;
-    GameLogger logger;
+    PlayerTableModel* seats;
     std::vector<PlayerWidget*> playerWidgets;
+    std::unordered_map<const Player*, size_t> seatOf;
+    std::vector<size_t> dirtySeats;
+    std::vector<bool> seatDirty;
+    bool turnChanged;
+    // The engine plays the game on its own thread, at any table size; game above is the
+    // window's copy, brought up to date with the engine's updates once per frame. Events
+    // wait in unshownEvents, with the players they name, until the history draws them.
+    std::unique_ptr<EngineThread> engine;
+    std::vector<PlayerEvent> unshownEvents;
+    QTimer* frameTimer;
+    QPushButton* autoplayButton;
     ActionPanel* actionPanel;
-    QTextEdit* historyDisplay;
+    QPlainTextEdit* historyDisplay;
     QPushButton* nextTurnButton;
     QLabel* currentPlayerLabel;
     QLabel* gameStateLabel;
 
 public:
-    GameWindow(QWidget* parent = nullptr) : QMainWindow(parent) {
+    GameWindow(size_t players = ROLE_COUNT, QWidget* parent = nullptr)
+        : QMainWindow(parent), turnChanged(true) {
         setWindowTitle("Coup Game");
         setMinimumSize(800, 600);
         
@@ -149,31 +314,38 @@ public:
         
         // Players section
         QGroupBox* playersGroup = new QGroupBox("Players");
+        playersGroup->setStyleSheet(PLAYER_STYLES);
         QHBoxLayout* playersLayout = new QHBoxLayout(playersGroup);
         
         // Initialize game and create players first
-        initializeGame(playersLayout);
+        initializeGame(players, playersLayout);
         
         // Action panel
-        actionPanel = new ActionPanel(&game, &logger, this, centralWidget);
+        actionPanel = new ActionPanel(&game, seats, this, centralWidget);
         
         // History display
         QGroupBox* historyGroup = new QGroupBox("Game History");
         QVBoxLayout* historyLayout = new QVBoxLayout(historyGroup);
-        historyDisplay = new QTextEdit();
+        historyDisplay = new QPlainTextEdit();
         historyDisplay->setReadOnly(true);
+        historyDisplay->document()->setUndoRedoEnabled(false);
         historyLayout->addWidget(historyDisplay);
         
-        // Next turn button
+        // Next turn and autoplay buttons
+        QHBoxLayout* turnLayout = new QHBoxLayout();
         nextTurnButton = new QPushButton("Next Turn");
         connect(nextTurnButton, &QPushButton::clicked, this, &GameWindow::nextTurn);
+        autoplayButton = new QPushButton("Autoplay");
+        connect(autoplayButton, &QPushButton::clicked, this, &GameWindow::toggleAutoplay);
+        turnLayout->addWidget(nextTurnButton);
+        turnLayout->addWidget(autoplayButton);
         
         // Add sections to main layout
         mainLayout->addLayout(gameStateLayout);
         mainLayout->addWidget(playersGroup);
         mainLayout->addWidget(actionPanel);
         mainLayout->addWidget(historyGroup);
-        mainLayout->addWidget(nextTurnButton);
+        mainLayout->addLayout(turnLayout);
         
         // Set central widget
         setCentralWidget(centralWidget);
@@ -181,72 +353,138 @@ public:
         // Update UI for start
         updateHistory();
         updateGameState();
+
+        // Start the engine on its copy of the table
+        engine = std::make_unique<EngineThread>(game);
+        frameTimer = new QTimer(this);
+        connect(frameTimer, &QTimer::timeout, this, &GameWindow::nextFrame);
+        frameTimer->start(FRAME_MS);
+    }
+
+    ~GameWindow() {
+        engine->stop();
     }
     
-    void initializeGame(QHBoxLayout* playersLayout) {
-        // Create players
-        Player* alice = new Governor("Alice", &game);
-        Player* bob = new Spy("Bob", &game);
-        Player* charlie = new Baron("Charlie", &game);
-        Player* diana = new General("Diana", &game);
-        Player* ethan = new Judge("Ethan", &game);
-        Player* fiona = new Merchant("Fiona", &game);
-        
-        // Add players to game
-        game.add_player(alice);
-        game.add_player(bob);
-        game.add_player(charlie);
-        game.add_player(diana);
-        game.add_player(ethan);
-        game.add_player(fiona);
-        
-        // Create player widgets
-        playerWidgets.push_back(new PlayerWidget(alice));
-        playerWidgets.push_back(new PlayerWidget(bob));
-        playerWidgets.push_back(new PlayerWidget(charlie));
-        playerWidgets.push_back(new PlayerWidget(diana));
-        playerWidgets.push_back(new PlayerWidget(ethan));
-        playerWidgets.push_back(new PlayerWidget(fiona));
-        
-        // Add widgets directly to layout
-        for (auto widget : playerWidgets) {
-            playersLayout->addWidget(widget);
+    // Seats players players in the standard roles, in turn. Up to MAX_SEATS each gets a
+    // box of its own; a larger table goes in a grid that draws only the rows in view.
+    void initializeGame(size_t players, QHBoxLayout* playersLayout) {
+        for (size_t seat = 0; seat < players; seat++) {
+            game.add_player(make_role_player(ROLE_NAMES[seat % ROLE_COUNT], standard_name(seat), &game));
+        }
+        seats = new PlayerTableModel(&game, this);
+
+        if (isLargeTable()) {
+            QTableView* board = new QTableView();
+            board->setModel(seats);
+            board->setSelectionMode(QAbstractItemView::NoSelection);
+            board->setEditTriggers(QAbstractItemView::NoEditTriggers);
+            board->setWordWrap(false);
+            // Fixed row heights, so the view never measures rows it isn't showing
+            board->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+            board->verticalHeader()->setDefaultSectionSize(22);
+            board->horizontalHeader()->setStretchLastSection(true);
+            board->setMinimumHeight(240);
+            playersLayout->addWidget(board);
+        } else {
+            for (size_t seat = 0; seat < players; seat++) {
+                playerWidgets.push_back(new PlayerWidget(game.get_player(seat)));
+                playersLayout->addWidget(playerWidgets[seat]);
+            }
+        }
+
+        // Every seat starts out needing a draw
+        for (size_t seat = 0; seat < players; seat++) {
+            seatOf[game.get_player(seat)] = seat;
+            markDirty(seat);
         }
+        game.set_listener(this);
         
         // Log game start
-        logger.log("Game started with 6 players");
+        unshownEvents.push_back(PlayerEvent{game_started_event(game), nullptr, nullptr, nullptr});
     }
 
+    bool isLargeTable() const {
+        return game.player_count() > MAX_SEATS;
+    }
+
+    void markDirty(size_t seat) {
+        if (seat >= seatDirty.size()) {
+            seatDirty.resize(seat + 1, false);
+        }
+        if (!seatDirty[seat]) {
+            seatDirty[seat] = true;
+            dirtySeats.push_back(seat);
+        }
+    }
+
+    void player_changed(const Player& player) override {
+        auto seat = seatOf.find(&player);
+        if (seat != seatOf.end()) {
+            markDirty(seat->second);
+        }
+    }
+
+    void turn_changed(size_t previous, size_t current) override {
+        markDirty(previous);
+        markDirty(current);
+        turnChanged = true;
+    }
+
+    // Redraws the seats and labels that changed since the last call
     void updateGameState() {
-        // Update player widgets
-        for (auto widget : playerWidgets) {
-            bool isCurrent = (widget->getPlayer()->get_name() == game.turn());
-            widget->highlight(isCurrent);
-            widget->update();
+        if (dirtySeats.empty() && !turnChanged) {
+            return;
         }
+        for (size_t seat : dirtySeats) {
+            seatDirty[seat] = false;
+            if (!playerWidgets.empty()) {
+                playerWidgets[seat]->highlight(seat == game.get_current_index());
+            }
+        }
+        seats->seatsChanged(dirtySeats);
+        dirtySeats.clear();
         
         // Update current player label
-        currentPlayerLabel->setText(QString("Current Player: %1").arg(QString::fromStdString(game.turn())));
+        if (turnChanged) {
+            turnChanged = false;
+            currentPlayerLabel->setText(
+                QString("Current Player: %1").arg(QString::fromStdString(game.get_current_player()->get_name())));
+        }
         
         // Update game state label
         if (game.is_game_over()) {
             gameStateLabel->setText(QString("Game Over - Winner: %1").arg(QString::fromStdString(game.winner())));
             gameStateLabel->setStyleSheet("font-weight: bold; color: green;");
             nextTurnButton->setEnabled(false);
+            autoplayButton->setEnabled(false);
             actionPanel->setEnabled(false);
-        } else {
-            gameStateLabel->setText("Game Active");
-            gameStateLabel->setStyleSheet("");
         }
     }
 
+    // Appends the events taken in since the last call in one block, so each frame costs the
+    // same however long the game has run, then drops the lines past HISTORY_LINES in one
+    // edit. The view stays scrolled to the bottom unless the user has scrolled up
     void updateHistory() {
-        historyDisplay->clear();
-        for (const auto& entry : logger.get_history()) {
-            historyDisplay->append(QString::fromStdString(entry));
+        size_t from = unshownEvents.size() - std::min<size_t>(unshownEvents.size(), HISTORY_LINES);
+        std::string lines;
+        for (size_t i = from; i < unshownEvents.size(); i++) {
+            lines += format_event(unshownEvents[i]);
+            lines += '\n';
+        }
+        unshownEvents.clear();
+        if (!lines.empty()) {
+            lines.pop_back();
+            historyDisplay->appendPlainText(QString::fromStdString(lines));
+        }
+        // setMaximumBlockCount() would trim too, but at autoplay speed its trimming cost
+        // about three times the append itself
+        QTextDocument* document = historyDisplay->document();
+        if (document->blockCount() > HISTORY_LINES) {
+            QTextCursor oldest(document);
+            oldest.setPosition(document->findBlockByNumber(document->blockCount() - HISTORY_LINES).position(),
+                               QTextCursor::KeepAnchor);
+            oldest.removeSelectedText();
         }
-        // Scroll to bottom
-        historyDisplay->verticalScrollBar()->setValue(historyDisplay->verticalScrollBar()->maximum());
     }
 
     Game* getGame() {
@@ -256,85 +494,207 @@ public:
     std::vector<PlayerWidget*> getPlayerWidgets() {
         return playerWidgets;
     }
-    
+
+    ActionPanel* getActionPanel() {
+        return actionPanel;
+    }
+
+    // Hands an action to the engine; the window catches up with it when its update arrives
+    void submitAction(ActionType type, size_t actor, size_t target, bool endTurn) {
+        engine->submit(SeatAction{type, actor, target}, endTurn);
+    }
+
     void nextTurn() {
-        try {
-            Player* current = game.get_current_player();
-            game.next_turn();
-            logger.log(current->get_name() + "'s turn ended. Now " + game.turn() + "'s turn.");
-            updateHistory();
-            updateGameState();
-
-            // Update the target player selection with the new list of players
-            if (actionPanel) {
-                // Get the combobox from the action panel
-                QComboBox* playerSelector = actionPanel->findChild<QComboBox*>("playerSelector");
-                if (playerSelector) {
-                    playerSelector->clear();
-
-                    // Add all players except the current player
-                    std::vector<std::string> playerNames = game.players_list();
-                    for (const auto& name : playerNames) {
-                        if (name != game.turn()) { // Don't add current player as target
-                            playerSelector->addItem(QString::fromStdString(name));
-                        }
-                    }
-                }
+        submitAction(ActionType::NextTurn, game.get_current_index(), game.player_count(), false);
+    }
 
-                // Update special action label for the new player
-                QRadioButton* specialAction = actionPanel->findChild<QRadioButton*>("Special Ability");
-                if (specialAction && specialAction->isChecked()) {
-                    actionPanel->updateSpecialActionLabel();
-                }
+    void toggleAutoplay() {
+        if (engine->bot_running()) {
+            engine->stop_bot();
+            autoplayButton->setText("Autoplay");
+        } else {
+            engine->start_bot(UINT64_MAX, AUTOPLAY_RATE);
+            autoplayButton->setText("Stop Autoplay");
+        }
+    }
 
-                // Auto-select gather action for the new player
-                QRadioButton* gatherAction = actionPanel->findChild<QRadioButton*>("Gather (1 coin)");
-                if (gatherAction) {
-                    gatherAction->setChecked(true);
-                }
+    // The event of an update with the window's players it names
+    PlayerEvent playerEvent(const EngineUpdate& update) const {
+        const Player* target = update.target < game.player_count() ? game.get_player(update.target) : nullptr;
+        const Player* next = update.event.action == ActionType::NextTurn ? game.get_player(update.current) : nullptr;
+        return PlayerEvent{update.event, game.get_player(update.actor), target, next};
+    }
 
-                // Check if current player has 10+ coins
-                Player* currentPlayer = game.get_current_player();
-                if (currentPlayer && currentPlayer->get_coins() >= 10) {
-                    QMessageBox::warning(this, "Must Coup",
-                        QString("%1 has 10+ coins and must perform a coup!")
-                        .arg(QString::fromStdString(currentPlayer->get_name())));
+    // Runs once per frame: applies every update the engine published since the last frame
+    // to the window's copy of the table, then redraws once from the latest state. Returns
+    // the number of updates applied.
+    size_t nextFrame() {
+        bool interactive = !engine->bot_running();
+        size_t before = game.get_current_index();
+        bool rejected = false;
+        EngineUpdate lastRejected{};
+        PlayerEvent lastView{};
+        size_t count = engine->drain([&](const EngineUpdate& update) {
+            apply_update(game, update);
+            if (update.error) {
+                lastRejected = update;
+                rejected = true;
+            } else if (!update.continued) {
+                unshownEvents.push_back(playerEvent(update));
+                if (update.event.action == ActionType::ViewCoins) {
+                    lastView = unshownEvents.back();
                 }
             }
+        });
+        if (count == 0) {
+            return 0;
+        }
+        bool turnPassed = game.get_current_index() != before;
+        updateHistory();
+        updateGameState();
+        if (turnPassed && !game.is_game_over()) {
+            refreshTurnControls();
+        }
+        if (!interactive && !engine->bot_running()) {
+            autoplayButton->setText("Autoplay");
+        }
 
-        } catch (const std::exception& e) {
-            QMessageBox::warning(this, "Error", e.what());
+        // Dialogs only for moves a person made, and at most one of each per frame
+        if (interactive && lastView.event.action == ActionType::ViewCoins) {
+            QMessageBox::information(this, "Spy Action", QString::fromStdString(format_event(lastView)));
         }
+        if (interactive && rejected) {
+            QMessageBox::warning(this, "Action Error", QString::fromStdString(rejection_message(lastRejected)));
+        }
+        if (interactive && turnPassed && !game.is_game_over() && game.get_current_player()->get_coins() >= STANDARD_RULES.forced_coup) {
+            QMessageBox::warning(this, "Must Coup",
+                QString("%1 has %2+ coins and must perform a coup!")
+                .arg(QString::fromStdString(game.get_current_player()->get_name()))
+                .arg(STANDARD_RULES.forced_coup));
+        }
+        return count;
     }
 
-    void logAction(const std::string& action) {
-        logger.log(action);
-        updateHistory();
-        updateGameState();
+    std::string rejection_message(const EngineUpdate& update) {
+        std::string action = action_name(update.event.action);
+        switch (static_cast<ErrorCode>(update.error)) {
+            case ErrorCode::InsufficientCoins: return "Not enough coins to " + action;
+            case ErrorCode::Sanctioned: return "Player is sanctioned and cannot " + action;
+            case ErrorCode::ConsecutiveArrest: return "Cannot arrest the same player in consecutive turns";
+            case ErrorCode::GameOver: return "Game is already over";
+            case ErrorCode::NotPlayerTurn: return "It is not this player's turn";
+            default: return "Cannot " + action + " now";
+        }
+    }
+
+    // Resets the target list, special action label and default action for the new player
+    void refreshTurnControls() {
+        actionPanel->refreshTargets();
+
+        // Update special action label for the new player
+        QRadioButton* specialAction = actionPanel->findChild<QRadioButton*>("specialAction");
+        if (specialAction && specialAction->isChecked()) {
+            actionPanel->updateSpecialActionLabel();
+        }
+
+        // Auto-select gather action for the new player
+        QRadioButton* gatherAction = actionPanel->findChild<QRadioButton*>("gatherAction");
+        if (gatherAction) {
+            gatherAction->setChecked(true);
+        }
+    }
+
+    // Has the bot play turns turns at AUTOPLAY_RATE a second, without coups so the game
+    // lasts, while frames are drawn at FRAME_MS; reports what a frame cost early and late
+    // in the run
+    void runScript(size_t turns) {
+        frameTimer->stop();
+        engine->start_bot(turns, AUTOPLAY_RATE, false);
+        std::vector<double> costs;
+        std::vector<size_t> counts;
+        size_t applied = 0;
+        QElapsedTimer total;
+        total.start();
+        while (engine->bot_running() || applied < engine->published()) {
+            QElapsedTimer frame;
+            frame.start();
+            size_t done = nextFrame();
+            applied += done;
+            QApplication::processEvents();
+            double cost = static_cast<double>(frame.nsecsElapsed()) / 1000.0;
+            costs.push_back(cost);
+            counts.push_back(done);
+            double wait = FRAME_MS * 1000.0 - cost;
+            if (wait > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(wait)));
+            }
+        }
+        auto mean = [&](size_t from, size_t to) {
+            double sum = 0;
+            for (size_t i = from; i < to; i++) {
+                sum += costs[i];
+            }
+            return to > from ? sum / static_cast<double>(to - from) : 0.0;
+        };
+        // Frame cost per action applied, over the frames that took in the first (or last)
+        // 1000 actions of the session.
+        auto perAction = [&](bool fromEnd) {
+            double sum = 0;
+            size_t taken = 0;
+            for (size_t i = 0; i < costs.size() && taken < 1000; i++) {
+                size_t at = fromEnd ? costs.size() - 1 - i : i;
+                sum += costs[at];
+                taken += counts[at];
+            }
+            return taken > 0 ? sum / static_cast<double>(taken) : 0.0;
+        };
+        std::vector<double> sorted = costs;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double p) {
+            return sorted.empty() ? 0.0 : sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))];
+        };
+        size_t late = static_cast<size_t>(std::count_if(costs.begin(), costs.end(),
+                                                        [](double cost) { return cost > FRAME_MS * 1000.0; }));
+        size_t window = std::min<size_t>(100, costs.size());
+        std::cerr << turns << " turns (" << applied << " updates) in " << static_cast<double>(total.elapsed()) / 1000.0
+                  << "s over " << costs.size() << " frames; first " << window << " frames: " << mean(0, window)
+                  << " us/frame, last " << window << ": " << mean(costs.size() - window, costs.size())
+                  << " us/frame, p50 " << percentile(0.5) << " us, p99 " << percentile(0.99) << " us, slowest "
+                  << *std::max_element(costs.begin(), costs.end()) << " us, " << late << " over "
+                  << FRAME_MS << " ms; first 1000 actions: " << perAction(false) << " us/action, last 1000: " << perAction(true)
+                  << " us/action; history holds " << historyDisplay->document()->blockCount() << " lines" << std::endl;
     }
 };
 
 // ActionPanel implementation - needs to be after GameWindow because it references it
-ActionPanel::ActionPanel(Game* game, GameLogger* logger, GameWindow* gameWindow, QWidget* parent)
-    : QGroupBox("Actions", parent), game(game), logger(logger), gameWindow(gameWindow) {
+ActionPanel::ActionPanel(Game* game, PlayerTableModel* seats, GameWindow* gameWindow, QWidget* parent)
+    : QGroupBox("Actions", parent), game(game), gameWindow(gameWindow) {
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
-    // Target player selection
+    // Target player selection: the seats model, filtered to live opponents whose names
+    // contain the search text. The list pops up as a view over the model, so it builds
+    // rows only as they scroll into sight.
     QHBoxLayout* targetLayout = new QHBoxLayout();
     QLabel* targetLabel = new QLabel("Target Player:");
+    targets = new TargetFilter(game, seats, this);
+    targetSearch = new QLineEdit();
+    targetSearch->setPlaceholderText("Search players");
+    targetSearch->setClearButtonEnabled(true);
     playerSelector = new QComboBox();
     playerSelector->setObjectName("playerSelector"); // Set object name for findChild
-
-    // Populate with players
-    std::vector<std::string> playerNames = game->players_list();
-    for (const auto& name : playerNames) {
-        if (name != game->turn()) { // Don't add current player as target
-            playerSelector->addItem(QString::fromStdString(name));
-        }
+    playerSelector->setModel(targets);
+    playerSelector->setModelColumn(PlayerTableModel::NameColumn);
+    // Size to a fixed width rather than measuring every name in the model
+    playerSelector->setSizeAdjustPolicy(QComboBox::AdjustToMinimumContentsLengthWithIcon);
+    playerSelector->setMinimumContentsLength(16);
+    if (QListView* list = qobject_cast<QListView*>(playerSelector->view())) {
+        list->setUniformItemSizes(true);
     }
+    connect(targetSearch, &QLineEdit::textChanged, targets, &TargetFilter::setFilterFixedString);
 
     targetLayout->addWidget(targetLabel);
+    targetLayout->addWidget(targetSearch);
     targetLayout->addWidget(playerSelector);
     mainLayout->addLayout(targetLayout);
 
@@ -342,16 +702,21 @@ ActionPanel::ActionPanel(Game* game, GameLogger* logger, GameWindow* gameWindow,
     QGroupBox* actionGroup = new QGroupBox("Select Action");
     QVBoxLayout* actionLayout = new QVBoxLayout(actionGroup);
 
-    gatherAction = new QRadioButton("Gather (1 coin)");
-    gatherAction->setObjectName("Gather (1 coin)"); // Set object name for findChild
-
-    taxAction = new QRadioButton("Tax (2 coins)");
-    bribeAction = new QRadioButton("Bribe (pay 4 coins)");
-    arrestAction = new QRadioButton("Arrest (steal 1 coin)");
-    sanctionAction = new QRadioButton("Sanction (pay 3 coins)");
-    coupAction = new QRadioButton("Coup (pay 7 coins)");
+    // Labels quote the rules; the object names stay fixed for findChild
+    gatherAction = new QRadioButton(QString("Gather (%1)").arg(coinCount(STANDARD_RULES.gather)));
+    gatherAction->setObjectName("gatherAction");
+    taxAction = new QRadioButton(QString("Tax (%1)").arg(coinCount(STANDARD_RULES.tax)));
+    taxAction->setObjectName("taxAction");
+    bribeAction = new QRadioButton(QString("Bribe (pay %1)").arg(coinCount(STANDARD_RULES.bribe_cost)));
+    bribeAction->setObjectName("bribeAction");
+    arrestAction = new QRadioButton(QString("Arrest (steal %1)").arg(coinCount(STANDARD_RULES.arrest_steal)));
+    arrestAction->setObjectName("arrestAction");
+    sanctionAction = new QRadioButton(QString("Sanction (pay %1)").arg(coinCount(STANDARD_RULES.sanction_cost)));
+    sanctionAction->setObjectName("sanctionAction");
+    coupAction = new QRadioButton(QString("Coup (pay %1)").arg(coinCount(STANDARD_RULES.coup_cost)));
+    coupAction->setObjectName("coupAction");
     specialAction = new QRadioButton("Special Ability");
-    specialAction->setObjectName("Special Ability"); // Set object name for findChild
+    specialAction->setObjectName("specialAction");
 
     gatherAction->setChecked(true);
 
@@ -377,6 +742,15 @@ ActionPanel::ActionPanel(Game* game, GameLogger* logger, GameWindow* gameWindow,
     updateSpecialActionLabel();
 }
 
+// The filter keeps the target list in step with eliminations; a new turn changes who is
+// excluded, so it is re-run
+void ActionPanel::refreshTargets() {
+    targets->turnChanged();
+    if (playerSelector->currentIndex() < 0 && targets->rowCount() > 0) {
+        playerSelector->setCurrentIndex(0);
+    }
+}
+
 void ActionPanel::updateSpecialActionLabel() {
     if (!specialAction->isChecked()) {
         return;
@@ -391,9 +765,10 @@ void ActionPanel::updateSpecialActionLabel() {
     } else if (role == "Spy") {
         specialAction->setText("Special: View Coins");
     } else if (role == "Baron") {
-        specialAction->setText("Special: Invest 3 coins for 6");
+        specialAction->setText(QString("Special: Invest %1 coins for %2")
+                               .arg(STANDARD_RULES.invest_cost).arg(STANDARD_RULES.invest_return));
     } else if (role == "General") {
-        specialAction->setText("Special: Protect from Coup (5 coins)");
+        specialAction->setText(QString("Special: Protect from Coup (%1 coins)").arg(STANDARD_RULES.protect_cost));
     } else if (role == "Judge") {
         specialAction->setText("Special: Block Bribe");
     } else if (role == "Merchant") {
@@ -407,144 +782,177 @@ void ActionPanel::updateSpecialActionLabel() {
 void ActionPanel::executeAction() {
     try {
         Player* currentPlayer = game->get_current_player();
-        std::string currentPlayerName = currentPlayer->get_name();
 
         // Check if this player has 10+ coins and trying to do something other than coup
-        if (currentPlayer->get_coins() >= 10 && !coupAction->isChecked()) {
-            QMessageBox::warning(gameWindow, "Must Coup", "You have 10 or more coins and must perform a coup!");
+        if (currentPlayer->get_coins() >= STANDARD_RULES.forced_coup && !coupAction->isChecked()) {
+            QMessageBox::warning(gameWindow, "Must Coup",
+                QString("You have %1 or more coins and must perform a coup!").arg(STANDARD_RULES.forced_coup));
             return;
         }
 
-        // Get target player if needed
-        Player* targetPlayer = nullptr;
-        std::string targetName;
-
-        if (playerSelector->count() > 0) {
-            targetName = playerSelector->currentText().toStdString();
-            targetPlayer = game->get_player_by_name(targetName);
-        }
-
-        std::string action;
-        bool performed = false;
-
-        // Execute selected action
+        // Map the selected action onto the engine's action ids
+        ActionType type = ActionType::None;
         if (gatherAction->isChecked()) {
-            currentPlayer->gather();
-            action = currentPlayerName + " gathered 1 coin";
-            performed = true;
-        }
-        else if (taxAction->isChecked()) {
-            currentPlayer->tax();
-            if (currentPlayer->get_role() == "Governor") {
-                action = currentPlayerName + " (Governor) taxed 3 coins";
-            } else {
-                action = currentPlayerName + " taxed 2 coins";
-            }
-            performed = true;
-        }
-        else if (bribeAction->isChecked()) {
-            currentPlayer->bribe();
-            action = currentPlayerName + " paid 4 coins to bribe";
-            performed = true;
-        }
-        else if (arrestAction->isChecked()) {
-            if (!targetPlayer) {
-                throw std::runtime_error("Must select a target player for arrest");
-            }
-            currentPlayer->arrest(*targetPlayer);
-            action = currentPlayerName + " arrested " + targetName + " and stole 1 coin";
-            performed = true;
+            type = ActionType::Gather;
+        } else if (taxAction->isChecked()) {
+            type = ActionType::Tax;
+        } else if (bribeAction->isChecked()) {
+            type = ActionType::Bribe;
+        } else if (arrestAction->isChecked()) {
+            type = ActionType::Arrest;
+        } else if (sanctionAction->isChecked()) {
+            type = ActionType::Sanction;
+        } else if (coupAction->isChecked()) {
+            type = ActionType::Coup;
+        } else if (specialAction->isChecked()) {
+            type = special_action(currentPlayer->get_role());
         }
-        else if (sanctionAction->isChecked()) {
-            if (!targetPlayer) {
-                throw std::runtime_error("Must select a target player for sanction");
-            }
-            currentPlayer->sanction(*targetPlayer);
-            action = currentPlayerName + " sanctioned " + targetName;
-            performed = true;
+
+        // The selected row of the filtered list maps straight back to its seat
+        size_t target = targets->seatAt(playerSelector->currentIndex());
+        if (action_has_target(type) && target >= game->player_count()) {
+            throw std::runtime_error(std::string("Must select a target player for ") + action_name(type));
         }
-        else if (coupAction->isChecked()) {
-            if (!targetPlayer) {
-                throw std::runtime_error("Must select a target player for coup");
-            }
-            currentPlayer->coup(*targetPlayer);
-            action = currentPlayerName + " performed a coup on " + targetName + " and eliminated them";
-            performed = true;
+
+        if (type == ActionType::None) {
+            return;
         }
-        else if (specialAction->isChecked()) {
-            std::string role = currentPlayer->get_role();
+        // The engine performs the action and, if it runs, passes the turn; the window shows
+        // the outcome (or why it was refused) on its next frame
+        gameWindow->submitAction(type, game->get_current_index(), target, true);
 
-            if (role == "Governor") {
-                if (!targetPlayer) {
-                    throw std::runtime_error("Must select a target player for block tax");
-                }
-                dynamic_cast<Governor*>(currentPlayer)->block_tax(*targetPlayer);
-                action = currentPlayerName + " (Governor) blocked " + targetName + "'s tax action";
-                performed = true;
-            }
-            else if (role == "Spy") {
-                if (!targetPlayer) {
-                    throw std::runtime_error("Must select a target player to view coins");
-                }
-                int coins = dynamic_cast<Spy*>(currentPlayer)->view_coins(*targetPlayer);
-                action = currentPlayerName + " (Spy) viewed that " + targetName + " has " + std::to_string(coins) + " coins";
-                performed = true;
+    } catch (const std::exception& e) {
+        QMessageBox::warning(gameWindow, "Action Error", e.what());
+    }
+}
 
-                // Show a message box with the coin count
-                QMessageBox::information(gameWindow, "Spy Action",
-                                        QString("%1 has %2 coins").arg(QString::fromStdString(targetName)).arg(coins));
-            }
-            else if (role == "Baron") {
-                dynamic_cast<Baron*>(currentPlayer)->invest();
-                action = currentPlayerName + " (Baron) invested 3 coins to get 6 coins";
-                performed = true;
-            }
-            else if (role == "General") {
-                if (!targetPlayer) {
-                    throw std::runtime_error("Must select a target player to protect");
-                }
-                dynamic_cast<General*>(currentPlayer)->protect(*targetPlayer);
-                action = currentPlayerName + " (General) protected " + targetName + " from a coup";
-                performed = true;
-            }
-            else if (role == "Judge") {
-                if (!targetPlayer) {
-                    throw std::runtime_error("Must select a target player to block bribe");
-                }
-                dynamic_cast<Judge*>(currentPlayer)->block_bribe(*targetPlayer);
-                action = currentPlayerName + " (Judge) blocked " + targetName + "'s bribe";
-                performed = true;
-            }
-            else if (role == "Merchant") {
-                dynamic_cast<Merchant*>(currentPlayer)->bonus();
-                action = currentPlayerName + " (Merchant) received a bonus coin";
-                performed = true;
-            }
-        }
+// Replay viewer: shows a recorded game at any turn. The timeline moves a ReplayCursor,
+// which rebuilds the board from the nearest checkpoint plus a short tail of events, so
+// dragging the slider costs the same at turn 10,000 as at turn 10.
+class ReplayWindow : public QMainWindow {
+private:
+    ReplayFile file;
+    ReplayCursor cursor;
+    std::vector<PlayerWidget*> playerWidgets;
+    QSlider* timeline;
+    QLabel* turnLabel;
+    QPlainTextEdit* turnEvents;
 
-        if (performed) {
-            // Log action
-            gameWindow->logAction(action);
+public:
+    ReplayWindow(const std::string& path, uint64_t id, QWidget* parent = nullptr)
+        : QMainWindow(parent), file(path), cursor(file.game(id)) {
+        const ReplayGame& replay = cursor.game_replay();
+        setWindowTitle(QString("Coup Replay - %1, game %2").arg(QString::fromStdString(path)).arg(id));
+        setMinimumSize(800, 400);
 
-            // After action, automatically advance to next player's turn
-            gameWindow->nextTurn();
+        QWidget* centralWidget = new QWidget(this);
+        QVBoxLayout* mainLayout = new QVBoxLayout(centralWidget);
 
-            // If the game is over after this action, disable the execute button
-            if (game->is_game_over()) {
-                executeButton->setEnabled(false);
-            }
+        QGroupBox* playersGroup = new QGroupBox("Players");
+        playersGroup->setStyleSheet(PLAYER_STYLES);
+        QHBoxLayout* playersLayout = new QHBoxLayout(playersGroup);
+        for (const auto& seat : replay.roster()) {
+            const char* role = seat.role < ROLE_COUNT ? ROLE_NAMES[seat.role] : "?";
+            playerWidgets.push_back(new PlayerWidget(seat.name, role));
+            playersLayout->addWidget(playerWidgets.back());
         }
 
-    } catch (const std::exception& e) {
-        QMessageBox::warning(gameWindow, "Action Error", e.what());
+        // Timeline: every turn from the start to the end of the game
+        QHBoxLayout* timelineLayout = new QHBoxLayout();
+        QPushButton* previousButton = new QPushButton("<");
+        QPushButton* nextButton = new QPushButton(">");
+        timeline = new QSlider(Qt::Horizontal);
+        timeline->setRange(0, static_cast<int>(replay.turn_count()));
+        timeline->setPageStep(std::max<int>(1, replay.checkpoint_interval()));
+        turnLabel = new QLabel();
+        connect(timeline, &QSlider::valueChanged, this, &ReplayWindow::showTurn);
+        connect(previousButton, &QPushButton::clicked, this, [this] { timeline->setValue(timeline->value() - 1); });
+        connect(nextButton, &QPushButton::clicked, this, [this] { timeline->setValue(timeline->value() + 1); });
+        timelineLayout->addWidget(previousButton);
+        timelineLayout->addWidget(timeline);
+        timelineLayout->addWidget(nextButton);
+        timelineLayout->addWidget(turnLabel);
+
+        QGroupBox* eventsGroup = new QGroupBox("Previous Turn");
+        QVBoxLayout* eventsLayout = new QVBoxLayout(eventsGroup);
+        turnEvents = new QPlainTextEdit();
+        turnEvents->setReadOnly(true);
+        eventsLayout->addWidget(turnEvents);
+
+        mainLayout->addWidget(playersGroup);
+        mainLayout->addLayout(timelineLayout);
+        mainLayout->addWidget(eventsGroup);
+        setCentralWidget(centralWidget);
+
+        showTurn(0);
     }
-}
 
+    // Moves the board to the start of a turn and lists the events of the turn before it
+    void showTurn(int turn) {
+        const ReplayGame& replay = cursor.game_replay();
+        cursor.seek(static_cast<uint32_t>(turn));
+        const Game& board = cursor.board();
+        for (size_t seat = 0; seat < playerWidgets.size(); seat++) {
+            const Player* player = board.get_player(seat);
+            playerWidgets[seat]->display(player->get_coins(), player->is_sanctioned(), player->is_eliminated(),
+                                         seat == board.get_current_index() && !board.is_game_over());
+        }
+        turnLabel->setText(QString("Turn %1 of %2").arg(turn).arg(replay.turn_count()));
+
+        std::string lines;
+        size_t from = turn > 0 ? replay.seek_turn(static_cast<uint32_t>(turn - 1)) : 0;
+        replay.scan(from, cursor.event_position(), [&](size_t, const Event& event) {
+            lines += format_event(event, board);
+            lines += '\n';
+            return true;
+        });
+        if (!lines.empty()) {
+            lines.pop_back();
+        }
+        turnEvents->setPlainText(QString::fromStdString(lines));
+    }
+};
+
+// GuiBench.cpp builds the window without this entry point
+#ifndef SIMPLIFIED_GUI_NO_MAIN
+// ./gui --players N seats N players (up to MAX_PLAYERS);
+// ./gui --script N has the bot play N turns, prints what the frames cost and exits;
+// ./gui --replay FILE [--game ID] opens the replay viewer on a game of an archive
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    int replayArg = args.indexOf("--replay");
+    if (replayArg > 0 && replayArg + 1 < args.size()) {
+        int gameArg = args.indexOf("--game");
+        uint64_t id = gameArg > 0 && gameArg + 1 < args.size() ? args[gameArg + 1].toULongLong() : 0;
+        try {
+            ReplayWindow viewer(args[replayArg + 1].toStdString(), id);
+            viewer.show();
+            return app.exec();
+        } catch (const std::exception& e) {
+            std::cerr << "Cannot open replay: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    size_t players = ROLE_COUNT;
+    int seats = args.indexOf("--players");
+    if (seats > 0 && seats + 1 < args.size()) {
+        players = std::clamp<size_t>(args[seats + 1].toULongLong(), 2, MAX_PLAYERS);
+    }
     
-    GameWindow window;
+    GameWindow window(players);
     window.show();
+
+    int script = args.indexOf("--script");
+    if (script > 0 && script + 1 < args.size()) {
+        // Game::next_turn() announces players who must coup; keep that out of the report
+        std::cout.setstate(std::ios_base::badbit);
+        window.runScript(args[script + 1].toULongLong());
+        return 0;
+    }
     
     return app.exec();
-}
\ No newline at end of file
+}
+#endif
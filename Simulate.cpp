@@ -0,0 +1,287 @@
+#include "Columnar.cpp"
+#include "EventLog.cpp"
+#include "Snapshot.cpp"
+#include "RoleEngine.cpp"
+#include <iostream>
+#include <random>
+
+/*
+ * Simulation runner and columnar export.
+ * Worker threads play bot games and stream every game and every action into one
+ * columnar file (Columnar.cpp) as they go, then one column is scanned back to show
+ * how quickly analyses can read it.
+ *   games:   game | players | turns | winner | winner_role
+ *   actions: game | turn | seat | role | action | target | coins_before | coins_after
+ * Seats, targets and winners use NO_TARGET (255) for none; roles are ROLE_NAMES indices.
+ * Usage: ./simulate [--games N] [--turns N] [--threads N] [--out FILE] [--scan TABLE.COLUMN]
+ *        ./simulate --games 0 --out FILE --scan TABLE.COLUMN   scans an existing file
+ *        ./simulate --sweep house [--games N] ...               compares the house rules below
+ *        ./simulate --sweep RULES [--games N] ...               compares standard rules with RULES,
+ *                                                               e.g. coup_cost=5,tax=3
+ * A sweep plays --games games per variant on the value-typed engine (RoleEngine.cpp) and
+ * reports game length and wins by role. Each house rule is compiled in as StaticRules, and
+ * is also played with the same rules read at run time, to show what the lookups cost.
+ */
+
+const std::vector<std::pair<std::string, std::vector<std::string>>> SIMULATION_SCHEMA = {
+    {"games", {"game", "players", "turns", "winner", "winner_role"}},
+    {"actions", {"game", "turn", "seat", "role", "action", "target", "coins_before", "coins_after"}},
+};
+const size_t GAMES_TABLE = 0;
+const size_t ACTIONS_TABLE = 1;
+
+// Plays game id with the bot, seeded by the id so runs are reproducible
+void simulate_game(ColumnarWriter& writer, ColumnBatch& games, ColumnBatch& actions, uint32_t id, size_t max_turns) {
+    std::mt19937 rng(id);
+    Game game;
+    seat_standard_players(game);
+    int32_t turn = 0;
+    auto act = [&](const Action& action) {
+        const Player* actor = game.get_player(action.actor);
+        int32_t before = actor->get_coins();
+        Event event = perform_event(game, action);
+        writer.append(actions, {static_cast<int32_t>(id), turn, event.actor, role_id(actor->get_role()),
+                                static_cast<int32_t>(event.action), event.target, before, before + event.actor_delta});
+    };
+    for (; static_cast<size_t>(turn) < max_turns && !game.is_game_over(); turn++) {
+        Action action = bot_action(game, false, rng());
+        try {
+            act(action);
+        } catch (const std::exception&) {
+            // Not allowed (e.g. sanctioned); the bot passes instead
+        }
+        if (!game.is_game_over()) {
+            act(bot_action(game, true));
+        }
+    }
+    uint8_t winner = game.is_game_over() ? seat_of(game, game.winner()) : NO_TARGET;
+    writer.append(games, {static_cast<int32_t>(id), static_cast<int32_t>(game.player_count()), turn, winner,
+                          winner == NO_TARGET ? NO_ROLE : role_id(game.get_player(winner)->get_role())});
+}
+
+// House-rule variants for --sweep house; each compiles into an engine of its own
+struct HouseRules {
+    const char* name;
+    RuleSet rules;
+};
+
+constexpr HouseRules HOUSE_RULES[] = {
+    {"standard", STANDARD_RULES},
+    {"cheap coups", [] { RuleSet r; r.coup_cost = 5; r.forced_coup = 8; return r; }()},
+    {"dear coups", [] { RuleSet r; r.coup_cost = 10; r.forced_coup = 13; return r; }()},
+    {"rich taxes", [] { RuleSet r; r.tax = 3; r.governor_tax = 4; return r; }()},
+    {"baron boom", [] { RuleSet r; r.invest_cost = 2; r.invest_return = 6; return r; }()},
+    {"merchant guild", [] { RuleSet r; r.merchant_bonus_at = 1; return r; }()},
+};
+
+struct SweepResult {
+    size_t turns = 0;
+    size_t unfinished = 0;
+    size_t wins[ROLE_COUNT] = {};
+    double seconds = 0;
+};
+
+// The sweep's bot: coups the next live opponent once it can afford to, otherwise gathers,
+// taxes or uses a coin-earning ability (a Baron invests when it can, a Merchant takes its
+// bonus); it only picks moves the rules allow, so no time goes on exceptions
+template <typename Rules>
+Action sweep_move(const BasicVariantGame<Rules>& game, uint32_t roll) {
+    uint8_t seat = static_cast<uint8_t>(game.get_current_index());
+    if (game.state(seat).coins >= game.get_rules().coup_cost) {
+        for (size_t i = 1; i < game.player_count(); i++) {
+            uint8_t target = static_cast<uint8_t>((seat + i) % game.player_count());
+            if (game.state(target).active) {
+                return Action{ActionType::Coup, seat, target};
+            }
+        }
+    }
+    ActionType type = roll % 3 == 0 ? ActionType::Gather : ActionType::Tax;
+    if (roll % 3 == 2 && game.role(seat) == role_id("Baron")) {
+        type = game.state(seat).coins >= game.get_rules().invest_cost ? ActionType::Invest : type;
+    } else if (roll % 3 == 2 && game.role(seat) == role_id("Merchant")) {
+        type = ActionType::Bonus;
+    }
+    return Action{type, seat, NO_TARGET};
+}
+
+template <typename Rules>
+SweepResult sweep_variant(const Rules& rules, size_t games, size_t max_turns, size_t threads) {
+    std::vector<SweepResult> parts(std::max<size_t>(threads, 1));
+    std::atomic<size_t> next(0);
+    auto start = std::chrono::steady_clock::now();
+    parallel_for(parts.size(), parts.size(), [&](size_t part) {
+        SweepResult& result = parts[part];
+        for (size_t id = next++; id < games; id = next++) {
+            // Seeding a Mersenne Twister would cost more than a short game takes to play
+            std::minstd_rand rng(static_cast<uint32_t>(id) + 1);
+            BasicVariantGame<Rules> game(rules);
+            seat_standard_players(game);
+            size_t turn = 0;
+            for (; turn < max_turns && !game.is_game_over(); turn++) {
+                try {
+                    game.perform(sweep_move(game, static_cast<uint32_t>(rng())));
+                } catch (const std::exception&) {
+                    // Not allowed (e.g. sanctioned); the bot passes instead
+                }
+                if (!game.is_game_over()) {
+                    game.next_turn();
+                }
+            }
+            result.turns += turn;
+            if (!game.is_game_over()) {
+                result.unfinished++;
+                continue;
+            }
+            for (size_t seat = 0; seat < game.player_count(); seat++) {
+                if (game.state(seat).active) {
+                    result.wins[game.role(seat)]++;
+                }
+            }
+        }
+    });
+    SweepResult total;
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& part : parts) {
+        total.turns += part.turns;
+        total.unfinished += part.unfinished;
+        for (size_t role = 0; role < ROLE_COUNT; role++) {
+            total.wins[role] += part.wins[role];
+        }
+    }
+    return total;
+}
+
+void report_variant(std::ostream& report, const std::string& name, const SweepResult& result, size_t games,
+                    double runtime_seconds) {
+    report << name << ": " << static_cast<double>(result.turns) / static_cast<double>(games) << " turns a game, "
+           << result.unfinished << " unfinished; wins";
+    for (size_t role = 0; role < ROLE_COUNT; role++) {
+        report << " " << ROLE_NAMES[role] << " " << 100.0 * static_cast<double>(result.wins[role]) /
+                                                        static_cast<double>(games) << "%";
+    }
+    report << "; " << result.seconds * 1e9 / static_cast<double>(result.turns) << " ns/turn";
+    if (runtime_seconds > 0) {
+        report << " (" << runtime_seconds * 1e9 / static_cast<double>(result.turns) << " with runtime rules)";
+    }
+    report << std::endl;
+}
+
+template <size_t... I>
+void sweep_house_rules(std::ostream& report, size_t games, size_t max_turns, size_t threads,
+                       std::index_sequence<I...>) {
+    (report_variant(report, HOUSE_RULES[I].name,
+                    sweep_variant(StaticRules<HOUSE_RULES[I].rules>(), games, max_turns, threads), games,
+                    sweep_variant(RuntimeRules{HOUSE_RULES[I].rules}, games, max_turns, threads).seconds),
+     ...);
+}
+
+int main(int argc, char* argv[]) {
+    size_t games = 200000;
+    size_t turns = 500;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string path = "simulation.cpc";
+    std::string scan = "actions.coins_after";
+    std::string sweep;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string flag = argv[i];
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << flag << std::endl;
+            return 1;
+        }
+        std::string value = argv[i + 1];
+        if (flag == "--games") {
+            games = std::stoul(value);
+        } else if (flag == "--turns") {
+            turns = std::stoul(value);
+        } else if (flag == "--threads") {
+            threads = std::stoul(value);
+        } else if (flag == "--out") {
+            path = value;
+        } else if (flag == "--scan") {
+            scan = value;
+        } else if (flag == "--sweep") {
+            sweep = value;
+        } else {
+            std::cerr << "Unknown option " << flag << std::endl;
+            return 1;
+        }
+    }
+    size_t dot = scan.find('.');
+    if (dot == std::string::npos) {
+        std::cerr << "--scan takes TABLE.COLUMN" << std::endl;
+        return 1;
+    }
+
+    // Game::next_turn() announces players who must coup; keep that off the results
+    std::ostream report(std::cout.rdbuf());
+    std::cout.setstate(std::ios_base::badbit);
+
+    if (!sweep.empty()) {
+        report << games << " games per variant on " << threads << " threads" << std::endl;
+        if (sweep == "house") {
+            sweep_house_rules(report, games, turns, threads, std::make_index_sequence<std::size(HOUSE_RULES)>());
+            return 0;
+        }
+        try {
+            RuleSet rules = parse_rules(sweep);
+            report_variant(report, "standard", sweep_variant(StandardRules(), games, turns, threads), games, 0);
+            report_variant(report, sweep, sweep_variant(RuntimeRules{rules}, games, turns, threads), games, 0);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    try {
+        if (games > 0) {
+            auto start = std::chrono::steady_clock::now();
+            ColumnarWriter writer(path, SIMULATION_SCHEMA);
+            std::atomic<size_t> next(0);
+            parallel_for(threads, threads, [&](size_t) {
+                ColumnBatch game_rows = writer.batch(GAMES_TABLE);
+                ColumnBatch action_rows = writer.batch(ACTIONS_TABLE);
+                for (size_t id = next++; id < games; id = next++) {
+                    simulate_game(writer, game_rows, action_rows, static_cast<uint32_t>(id), turns);
+                }
+                writer.flush(game_rows);
+                writer.flush(action_rows);
+            });
+            writer.close();
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            report << "Simulated " << games << " games on " << threads << " threads in " << elapsed << "s" << std::endl;
+        }
+
+        ColumnarFile file(path);
+        struct stat info;
+        stat(path.c_str(), &info);
+        for (const auto& table : file.tables()) {
+            report << table.name << ": " << table.rows << " rows in " << table.group_rows.size() << " groups"
+                   << std::endl;
+        }
+        report << path << ": " << info.st_size / 1024 << " KiB" << std::endl;
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t rows = 0;
+        int64_t sum = 0;
+        int32_t low = INT32_MAX;
+        int32_t high = INT32_MIN;
+        file.scan(scan.substr(0, dot), scan.substr(dot + 1), [&](const int32_t* values, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                sum += values[i];
+                low = std::min(low, values[i]);
+                high = std::max(high, values[i]);
+            }
+            rows += count;
+        });
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report << "scan " << scan << ": " << rows << " rows, min " << low << ", max " << high << ", mean "
+               << (rows ? static_cast<double>(sum) / static_cast<double>(rows) : 0.0) << " in " << elapsed * 1000
+               << " ms (" << static_cast<double>(rows) / elapsed / 1e6 << "M rows/s)" << std::endl;
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
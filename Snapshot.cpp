@@ -0,0 +1,190 @@
+#pragma once
+#include "Protocol.cpp"
+#include "Journal.cpp"
+#include <atomic>
+#include <cstdio>
+
+/*
+ * Compact snapshots of live tables, used to bound crash-recovery time.
+ * A snapshot file holds one record per table with everything needed to rebuild
+ * its Game plus the last journal sequence number the record covers, so recovery
+ * only replays the journal tail after it:
+ *   header:  magic "CPS1" | count u32
+ *   record:  table u32 | seq u32 | seats u8 | current u8 | last_arrested u8 | reserved u8
+ *            then per seat: role u8 | flags u8 | coins i16
+ *   trailer: crc32 u32 of everything before it
+ * Files are written to a temporary name, fsynced and renamed into place.
+ * Players are restored under their standard seat names.
+ */
+
+const char SNAPSHOT_MAGIC[4] = {'C', 'P', 'S', '1'};
+const size_t SNAPSHOT_RECORD_BASE = 12;
+const size_t SNAPSHOT_SEAT_SIZE = 4;
+
+struct SeatSnapshot {
+    uint8_t role;
+    uint8_t flags;
+    int16_t coins;
+};
+
+struct TableSnapshot {
+    uint32_t table;
+    uint32_t seq;
+    uint8_t seats;
+    uint8_t current;
+    uint8_t last_arrested;
+    SeatSnapshot seat[MAX_SEATS];
+};
+
+TableSnapshot snapshot_game(const Game& game, uint32_t table, uint32_t seq) {
+    TableState state = capture_state(game);
+    TableSnapshot snapshot{};
+    snapshot.table = table;
+    snapshot.seq = seq;
+    snapshot.seats = state.seats;
+    snapshot.current = state.current;
+    snapshot.last_arrested = NO_TARGET;
+    for (uint8_t i = 0; i < state.seats; i++) {
+        const Player* player = game.get_player(i);
+        snapshot.seat[i] = SeatSnapshot{role_id(player->get_role()), state.seat[i].flags, state.seat[i].coins};
+        if (game.get_last_arrested() == player) {
+            snapshot.last_arrested = i;
+        }
+    }
+    return snapshot;
+}
+
+// Seats the snapshot's players into an empty game
+void restore_game(Game& game, const TableSnapshot& snapshot) {
+    if (game.player_count() != 0) {
+        throw std::logic_error("Can only restore into an empty game");
+    }
+    for (uint8_t i = 0; i < snapshot.seats; i++) {
+        const SeatSnapshot& seat = snapshot.seat[i];
+        if (seat.role >= ROLE_COUNT) {
+            throw std::invalid_argument("Snapshot has an unknown role");
+        }
+        Player* player = make_role_player(ROLE_NAMES[seat.role], standard_name(i), &game);
+        game.add_player(player);
+        player->add_coins(seat.coins);
+        player->set_sanctioned(seat.flags & SEAT_SANCTIONED);
+        if (seat.flags & SEAT_ELIMINATED) {
+            player->eliminate();
+        }
+    }
+    game.set_current_index(snapshot.current);
+    game.set_last_arrested(snapshot.last_arrested < snapshot.seats ? game.get_player(snapshot.last_arrested) : nullptr);
+}
+
+size_t encode_snapshot(uint8_t* out, const TableSnapshot& snapshot) {
+    put_u32(out, snapshot.table);
+    put_u32(out + 4, snapshot.seq);
+    out[8] = snapshot.seats;
+    out[9] = snapshot.current;
+    out[10] = snapshot.last_arrested;
+    out[11] = 0;
+    uint8_t* seat = out + SNAPSHOT_RECORD_BASE;
+    for (uint8_t i = 0; i < snapshot.seats; i++, seat += SNAPSHOT_SEAT_SIZE) {
+        seat[0] = snapshot.seat[i].role;
+        seat[1] = snapshot.seat[i].flags;
+        put_u16(seat + 2, static_cast<uint16_t>(snapshot.seat[i].coins));
+    }
+    return SNAPSHOT_RECORD_BASE + SNAPSHOT_SEAT_SIZE * snapshot.seats;
+}
+
+void write_snapshot_file(const std::string& path, const std::vector<TableSnapshot>& tables) {
+    std::vector<uint8_t> data(8 + tables.size() * (SNAPSHOT_RECORD_BASE + SNAPSHOT_SEAT_SIZE * MAX_SEATS) + 4);
+    std::memcpy(data.data(), SNAPSHOT_MAGIC, 4);
+    put_u32(data.data() + 4, static_cast<uint32_t>(tables.size()));
+    size_t size = 8;
+    for (const auto& table : tables) {
+        size += encode_snapshot(data.data() + size, table);
+    }
+    put_u32(data.data() + size, crc32(data.data(), size));
+    size += 4;
+
+    std::string temp = path + ".tmp";
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw JournalException("Cannot write snapshot " + temp);
+    }
+    bool ok = write(fd, data.data(), size) == static_cast<ssize_t>(size) && fsync(fd) == 0;
+    close(fd);
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        throw JournalException("Cannot write snapshot " + path);
+    }
+}
+
+std::vector<TableSnapshot> read_snapshot_file(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw JournalException("Cannot open snapshot " + path);
+    }
+    struct stat info;
+    fstat(fd, &info);
+    std::vector<uint8_t> data(static_cast<size_t>(info.st_size));
+    bool ok = read(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+    close(fd);
+    if (!ok || data.size() < 12 || std::memcmp(data.data(), SNAPSHOT_MAGIC, 4) != 0 ||
+        get_u32(data.data() + data.size() - 4) != crc32(data.data(), data.size() - 4)) {
+        throw JournalException(path + " is not a valid snapshot");
+    }
+
+    std::vector<TableSnapshot> tables(get_u32(data.data() + 4));
+    size_t offset = 8;
+    size_t end = data.size() - 4;
+    for (auto& table : tables) {
+        if (offset + SNAPSHOT_RECORD_BASE > end) {
+            throw JournalException(path + " is truncated");
+        }
+        const uint8_t* in = data.data() + offset;
+        table.table = get_u32(in);
+        table.seq = get_u32(in + 4);
+        table.seats = in[8];
+        table.current = in[9];
+        table.last_arrested = in[10];
+        if (table.seats > MAX_SEATS || offset + SNAPSHOT_RECORD_BASE + SNAPSHOT_SEAT_SIZE * table.seats > end) {
+            throw JournalException(path + " has a malformed record");
+        }
+        const uint8_t* seat = in + SNAPSHOT_RECORD_BASE;
+        for (uint8_t i = 0; i < table.seats; i++, seat += SNAPSHOT_SEAT_SIZE) {
+            table.seat[i] = SeatSnapshot{seat[0], seat[1], static_cast<int16_t>(get_u16(seat + 2))};
+        }
+        offset += SNAPSHOT_RECORD_BASE + SNAPSHOT_SEAT_SIZE * table.seats;
+    }
+    return tables;
+}
+
+// Runs task(i) for every i in [0, count) on up to threads threads
+template <typename Task>
+void parallel_for(size_t count, size_t threads, Task task) {
+    std::atomic<size_t> next(0);
+    auto work = [&] {
+        for (size_t i = next++; i < count; i = next++) {
+            task(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < std::max<size_t>(1, threads); t++) {
+        pool.emplace_back(work);
+    }
+    work();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+// Journal events grouped by table, keeping only those newer than each table's snapshot
+std::vector<std::vector<JournalRecord>> journal_tails(const std::string& journal_path, size_t table_count,
+                                                      const std::vector<uint32_t>& snapshot_seq) {
+    std::vector<std::vector<JournalRecord>> tails(table_count);
+    replay_journal(journal_path, [&](const JournalRecord& record) {
+        if (record.table >= table_count) {
+            throw JournalException("Journal references unknown table " + std::to_string(record.table));
+        }
+        if (record.seq > snapshot_seq[record.table]) {
+            tails[record.table].push_back(record);
+        }
+    });
+    return tails;
+}
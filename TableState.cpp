@@ -0,0 +1,85 @@
+#pragma once
+#include "Action.cpp"
+
+/*
+ * Compact, trivially copyable view of a table's public state.
+ * Used wherever state has to be compared, shipped or stored without touching
+ * the Player objects themselves.
+ */
+
+const size_t MAX_SEATS = 8;
+
+const uint8_t SEAT_SANCTIONED = 0x01;
+const uint8_t SEAT_ELIMINATED = 0x02;
+
+struct SeatState {
+    int16_t coins;
+    uint8_t flags;
+
+    bool operator==(const SeatState& other) const { return coins == other.coins && flags == other.flags; }
+    bool operator!=(const SeatState& other) const { return !(*this == other); }
+};
+
+struct TableState {
+    uint8_t seats;
+    uint8_t current;
+    SeatState seat[MAX_SEATS];
+
+    bool operator==(const TableState& other) const {
+        if (seats != other.seats || current != other.current) {
+            return false;
+        }
+        for (uint8_t i = 0; i < seats; i++) {
+            if (seat[i] != other.seat[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const TableState& other) const { return !(*this == other); }
+};
+
+SeatState seat_state(const Player& player) {
+    return SeatState{static_cast<int16_t>(player.get_coins()),
+                     static_cast<uint8_t>((player.is_sanctioned() ? SEAT_SANCTIONED : 0) |
+                                          (player.is_eliminated() ? SEAT_ELIMINATED : 0))};
+}
+
+TableState capture_state(const Game& game) {
+    if (game.player_count() > MAX_SEATS) {
+        throw std::length_error("Table has more than " + std::to_string(MAX_SEATS) + " seats");
+    }
+    TableState state{};
+    state.seats = static_cast<uint8_t>(game.player_count());
+    state.current = static_cast<uint8_t>(game.get_current_index());
+    for (size_t i = 0; i < game.player_count(); i++) {
+        state.seat[i] = seat_state(*game.get_player(i));
+    }
+    return state;
+}
+
+// Brings one player of a copy of the table up to seat; players cannot come back once eliminated
+void apply_seat_state(Player& player, const SeatState& seat) {
+    if (seat.coins > player.get_coins()) {
+        player.add_coins(seat.coins - player.get_coins());
+    } else if (seat.coins < player.get_coins()) {
+        player.remove_coins(player.get_coins() - seat.coins);
+    }
+    player.set_sanctioned(seat.flags & SEAT_SANCTIONED);
+    if (seat.flags & SEAT_ELIMINATED) {
+        player.eliminate();
+    } else if (player.is_eliminated()) {
+        throw std::logic_error("Table state brings back an eliminated player");
+    }
+}
+
+// Brings a copy of the table (e.g. a UI's) up to state
+void apply_table_state(Game& game, const TableState& state) {
+    if (state.seats != game.player_count()) {
+        throw std::invalid_argument("Table state is for a different number of seats");
+    }
+    for (uint8_t i = 0; i < state.seats; i++) {
+        apply_seat_state(*game.get_player(i), state.seat[i]);
+    }
+    game.set_current_index(state.current);
+}
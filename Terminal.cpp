@@ -0,0 +1,158 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/*
+ * Console I/O: a double-buffered terminal renderer, and a buffered reader for scripted
+ * input (CommandReader, below).
+ * A UI draws each frame into the back buffer a line at a time. present() compares it with
+ * the lines already on screen and rewrites only the lines that differ: each is reached
+ * with a cursor-position escape and ended with erase-to-end-of-line, so nothing is
+ * cleared first and nothing flickers. It then erases whatever lies below the frame (the
+ * rest of a taller frame, or input echoed after the prompt) and leaves the cursor at the
+ * end of the last line, where the prompt goes. A frame is built in one string and goes
+ * out in one write and one flush.
+ * Frames taller than the terminal would scroll it and throw the line positions off, so
+ * those are drawn whole after clearing the screen. Without ANSI (output that is not a
+ * terminal) every frame is written as plain lines.
+ */
+
+class TerminalRenderer {
+private:
+    std::ostream& out;
+    bool ansi;
+    size_t rows;
+    std::vector<std::string> front; // lines on screen
+    std::vector<std::string> back;  // frame being drawn
+    std::string bytes;
+    bool drawn; // a frame has been presented
+
+    void move_to(size_t row, size_t column) {
+        bytes += "\x1b[";
+        bytes += std::to_string(row + 1);
+        bytes += ';';
+        bytes += std::to_string(column + 1);
+        bytes += 'H';
+    }
+
+public:
+    TerminalRenderer(std::ostream& stream, bool use_ansi) : out(stream), ansi(use_ansi), rows(0), drawn(false) {}
+
+    // Terminal height in rows, or 0 if unknown
+    void set_rows(size_t terminal_rows) { rows = terminal_rows; }
+
+    // Starts a frame; line() adds its lines in order, the last one being the prompt
+    void begin() { back.clear(); }
+    void line(const std::string& text) { back.push_back(text); }
+    std::string& line() {
+        back.emplace_back();
+        return back.back();
+    }
+
+    // Input typed after the prompt echoed on the prompt line; it is drawn again next frame
+    void input_taken() {
+        if (!front.empty()) {
+            front.pop_back();
+        }
+    }
+
+    // Draws the frame; returns the number of lines written
+    size_t present() {
+        bytes.clear();
+        size_t written = 0;
+        if (!ansi) {
+            // Plain frames follow one another, each starting on a line of its own
+            if (drawn) {
+                bytes += '\n';
+            }
+            for (size_t i = 0; i < back.size(); i++) {
+                bytes += back[i];
+                if (i + 1 < back.size()) {
+                    bytes += '\n';
+                }
+            }
+            written = back.size();
+        } else {
+            if (!drawn || (rows > 0 && back.size() >= rows)) {
+                bytes += "\x1b[H\x1b[2J";
+                front.clear();
+            }
+            for (size_t i = 0; i < back.size(); i++) {
+                if (i >= front.size() || front[i] != back[i]) {
+                    move_to(i, 0);
+                    bytes += back[i];
+                    bytes += "\x1b[K";
+                    written++;
+                }
+            }
+            move_to(back.size(), 0);
+            bytes += "\x1b[J";
+            if (!back.empty()) {
+                move_to(back.size() - 1, back.back().size());
+            }
+        }
+        out << bytes << std::flush;
+        drawn = true;
+        front.swap(back);
+        return written;
+    }
+};
+
+// Buffered reader of whitespace-separated numbers, for scripted console input. It reads
+// the stream 64 KiB at a time and parses digits in place, rather than a formatted read
+// per prompt. '#' starts a comment that runs to the end of the line; anything else that
+// is not a digit separates numbers.
+class CommandReader {
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t at;
+    size_t size;
+
+    // Next character, or -1 at the end of the stream
+    int get() {
+        if (at == size) {
+            ssize_t got;
+            do {
+                got = read(fd, buffer.data(), buffer.size());
+            } while (got < 0 && errno == EINTR);
+            if (got <= 0) {
+                return -1;
+            }
+            at = 0;
+            size = static_cast<size_t>(got);
+        }
+        return static_cast<unsigned char>(buffer[at++]);
+    }
+
+public:
+    explicit CommandReader(int descriptor, size_t capacity = 65536)
+        : fd(descriptor), buffer(capacity), at(0), size(0) {}
+
+    // Reads the next number; false at the end of the stream
+    bool next(int& value) {
+        int c = get();
+        while (c != -1 && (c < '0' || c > '9')) {
+            if (c == '#') {
+                while (c != -1 && c != '\n') {
+                    c = get();
+                }
+            } else {
+                c = get();
+            }
+        }
+        if (c == -1) {
+            return false;
+        }
+        long long number = 0;
+        for (; c >= '0' && c <= '9'; c = get()) {
+            number = std::min<long long>(number * 10 + (c - '0'), 1000000000);
+        }
+        value = static_cast<int>(number);
+        return true;
+    }
+};
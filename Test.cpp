@@ -1,6 +1,19 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "Game.cpp"
+#include "GameServer.cpp"
+#include "TurnFlow.cpp"
+#include "EventLog.cpp"
+#include "Replay.cpp"
+#include "Columnar.cpp"
+#include "SaveGame.cpp"
+#include "EngineThread.cpp"
+#include "Terminal.cpp"
+#include "Scenario.cpp"
+#include "RoleEngine.cpp"
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/wait.h>
 
 TEST_CASE("Player basic operations") {
     Game game;
@@ -256,4 +269,1819 @@ TEST_CASE("Player with 10+ coins") {
     player1->coup(*player2);
     CHECK_EQ(player1->get_coins(), 3); // 10 - 7 = 3
     CHECK(player2->is_eliminated());
-}
\ No newline at end of file
+}
+
+TEST_CASE("Seat-addressed actions") {
+    Game game;
+    seat_standard_players(game);
+    
+    // Only the current player may act
+    CHECK_THROWS_AS(perform(game, Action{ActionType::Gather, 1, NO_TARGET}), NotPlayerTurnException);
+    perform(game, Action{ActionType::Tax, 0, NO_TARGET});
+    CHECK_EQ(game.get_player(0)->get_coins(), 3); // Alice is the Governor
+    
+    // Role abilities require the matching role
+    CHECK_THROWS_AS(perform(game, Action{ActionType::Invest, 0, NO_TARGET}), InvalidActionException);
+    CHECK_THROWS_AS(perform(game, Action{ActionType::ViewCoins, 0, 1}), InvalidActionException);
+    CHECK_THROWS_AS(perform(game, Action{ActionType::Arrest, 0, 0}), InvalidActionException);
+    
+    perform(game, Action{ActionType::NextTurn, 0, NO_TARGET});
+    CHECK_EQ(game.get_current_index(), 1);
+    CHECK_EQ(perform(game, Action{ActionType::ViewCoins, 1, 0}), 3);
+    CHECK_EQ(action_from_name("block_bribe"), ActionType::BlockBribe);
+}
+
+TEST_CASE("Player-addressed actions reach seats past a seat byte") {
+    Game game;
+    for (size_t seat = 0; seat < 300; seat++) {
+        game.add_player(make_role_player(ROLE_NAMES[seat % ROLE_COUNT], standard_name(seat), &game));
+    }
+    game.set_current_index(289);
+    Player& actor = *game.get_player(289);
+    Player& target = *game.get_player(256);
+    actor.add_coins(1);
+    target.add_coins(2);
+
+    CHECK_THROWS_AS(perform(game, ActionType::Gather, target, nullptr), NotPlayerTurnException);
+    CHECK_THROWS_AS(perform(game, ActionType::Arrest, actor, nullptr), InvalidActionException);
+    CHECK_THROWS_AS(perform(game, ActionType::Arrest, actor, &actor), InvalidActionException);
+
+    // Seat 289 is a Spy; arresting moves a coin, viewing reports the target's count
+    PlayerEvent arrest = perform_event(game, ActionType::Arrest, actor, &target);
+    CHECK_EQ(arrest.event.actor_delta, 1);
+    CHECK_EQ(arrest.event.target_delta, -1);
+    CHECK_EQ(arrest.event.actor, NO_TARGET);
+    CHECK_EQ(format_event(arrest), "Player290 arrested Player257 and stole 1 coin");
+    CHECK_EQ(perform_event(game, ActionType::ViewCoins, actor, &target).event.value, 1);
+
+    // The event names whose turn it passed to, past the seat byte too
+    PlayerEvent passed = perform_event(game, ActionType::NextTurn, actor, nullptr);
+    CHECK_EQ(game.get_current_index(), 290);
+    CHECK_EQ(passed.event.next, NO_TARGET);
+    CHECK_EQ(format_event(passed), "Player290's turn ended. Now Player291's turn.");
+
+    // Seats that fit the seat byte are recorded, so the event also formats from the game
+    game.set_current_index(3);
+    PlayerEvent low = perform_event(game, ActionType::NextTurn, *game.get_player(3), nullptr);
+    CHECK_EQ(low.event.actor, 3);
+    CHECK_EQ(low.event.next, 4);
+    CHECK_EQ(format_event(low.event, game), "Diana's turn ended. Now Ethan's turn.");
+}
+
+TEST_CASE("Server table execution") {
+    Scheduler scheduler(1, false);
+    Table table(scheduler, 1);
+    uint8_t request[MAX_FRAME_SIZE];
+    uint8_t reply[MAX_FRAME_SIZE];
+    Frame frame;
+    
+    // A gather reply carries only the actor's seat
+    encode_action(request, 1, Action{ActionType::Gather, 0, NO_TARGET});
+    REQUIRE_EQ(decode_frame(request, ACTION_FRAME_SIZE, frame), DecodeStatus::Ok);
+    REQUIRE_EQ(decode_frame(reply, table.execute(frame, reply), frame), DecodeStatus::Ok);
+    CHECK_EQ(frame.kind, FrameKind::State);
+    CHECK_EQ(frame.count, 1);
+    CHECK_EQ(state_entry(frame, 0).seat, 0);
+    CHECK_EQ(state_entry(frame, 0).state.coins, 1);
+    
+    // Acting out of turn is answered with an error frame
+    encode_action(request, 1, Action{ActionType::Gather, 2, NO_TARGET});
+    decode_frame(request, ACTION_FRAME_SIZE, frame);
+    REQUIRE_EQ(decode_frame(reply, table.execute(frame, reply), frame), DecodeStatus::Ok);
+    CHECK_EQ(frame.kind, FrameKind::Error);
+    CHECK_EQ(frame.error, ErrorCode::NotPlayerTurn);
+}
+
+// Counts messages and checks that no two workers ever run the same actor at once
+class CountingActor : public Actor<int> {
+public:
+    std::atomic<bool> busy{false};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> received{0};
+    int last = -1;
+    bool ordered = true;
+    
+    CountingActor(Scheduler& scheduler, size_t home) : Actor<int>(scheduler, home) {}
+    
+protected:
+    void receive(int& message) override {
+        if (busy.exchange(true)) {
+            overlaps++;
+        }
+        // Messages from the single producer below must arrive in order
+        if (message < 1000000) {
+            ordered = ordered && message > last;
+            last = message;
+        }
+        busy.store(false);
+        received++;
+    }
+};
+
+TEST_CASE("Actor mailboxes and scheduling") {
+    Scheduler scheduler(3, false);
+    std::vector<std::unique_ptr<CountingActor>> actors;
+    for (size_t i = 0; i < 16; i++) {
+        actors.push_back(std::make_unique<CountingActor>(scheduler, i));
+    }
+    
+    const int per_producer = 20000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; p++) {
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; i++) {
+                // Producer 0 sends increasing values; the others send tagged values
+                actors[i % actors.size()]->post(p == 0 ? i : 1000000 + i);
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    
+    int total = 0;
+    for (int spins = 0; spins < 5000 && total != 3 * per_producer; spins++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        total = 0;
+        for (auto& actor : actors) {
+            total += actor->received.load();
+        }
+    }
+    scheduler.stop();
+    
+    CHECK_EQ(total, 3 * per_producer);
+    for (auto& actor : actors) {
+        CHECK_EQ(actor->overlaps.load(), 0);
+        CHECK(actor->ordered);
+    }
+}
+
+TEST_CASE("Protocol state deltas") {
+    Game game;
+    seat_standard_players(game);
+    TableState client{};
+    uint8_t buffer[MAX_FRAME_SIZE];
+    Frame frame;
+    
+    TableState before = capture_state(game);
+    REQUIRE_EQ(decode_frame(buffer, encode_keyframe(buffer, 3, before), frame), DecodeStatus::Ok);
+    apply_state(client, frame);
+    
+    // Play a few turns and keep the client copy in sync through deltas only
+    size_t turn_bytes = 0;
+    for (int i = 0; i < 12; i++) {
+        Action action{i % 2 == 0 ? ActionType::Gather : ActionType::NextTurn,
+                      static_cast<uint8_t>(game.get_current_index()), NO_TARGET};
+        turn_bytes += encode_action(buffer, 3, action);
+        perform(game, action);
+        TableState after = capture_state(game);
+        size_t size = encode_state(buffer, 3, before, after, false);
+        turn_bytes += size;
+        REQUIRE_EQ(decode_frame(buffer, size, frame), DecodeStatus::Ok);
+        apply_state(client, frame);
+        before = after;
+    }
+    CHECK(client == before);
+    
+    // The same turn as JSON: request plus a full state reply for each of the two actions
+    std::string json_request = "{\"table\":3,\"actor\":0,\"action\":\"gather\",\"target\":null}";
+    std::string json_reply = "{\"table\":3,\"current\":0,\"players\":[";
+    for (int i = 0; i < 6; i++) {
+        json_reply += std::string(i ? "," : "") + "{\"coins\":1,\"sanctioned\":false,\"eliminated\":false}";
+    }
+    json_reply += "]}";
+    size_t json_turn_bytes = 2 * (json_request.size() + json_reply.size());
+    CHECK_LE(turn_bytes / 6 * 10, json_turn_bytes);
+}
+
+TEST_CASE("Protocol decoder rejects malformed frames") {
+    uint8_t frame_bytes[MAX_FRAME_SIZE];
+    Frame frame;
+    
+    size_t size = encode_action(frame_bytes, 1, Action{ActionType::Coup, 0, 2});
+    CHECK_EQ(decode_frame(frame_bytes, size - 1, frame), DecodeStatus::Incomplete);
+    frame_bytes[0] = 9;
+    CHECK_EQ(decode_frame(frame_bytes, size, frame), DecodeStatus::BadVersion);
+    frame_bytes[0] = PROTOCOL_VERSION;
+    frame_bytes[8] = static_cast<uint8_t>(ActionType::Count);
+    CHECK_EQ(decode_frame(frame_bytes, size, frame), DecodeStatus::BadField);
+    
+    // Fuzz: random mutations of valid frames must decode to self-consistent frames or be rejected
+    TableState state{};
+    state.seats = 6;
+    uint32_t seed = 12345;
+    auto next_random = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return seed >> 8;
+    };
+    for (int i = 0; i < 200000; i++) {
+        size_t length = (i % 2) ? encode_keyframe(frame_bytes, i, state)
+                                : encode_action(frame_bytes, i, Action{ActionType::Arrest, 1, 2});
+        int flips = 1 + next_random() % 4;
+        for (int f = 0; f < flips; f++) {
+            frame_bytes[next_random() % length] ^= static_cast<uint8_t>(1u << (next_random() % 8));
+        }
+        size_t available = next_random() % (MAX_FRAME_SIZE + 1);
+        if (decode_frame(frame_bytes, available, frame) == DecodeStatus::Ok) {
+            REQUIRE_LE(frame.length, available);
+            if (frame.kind == FrameKind::State) {
+                TableState decoded{};
+                apply_state(decoded, frame);
+                REQUIRE_LE(decoded.seats, MAX_SEATS);
+            }
+        }
+    }
+}
+
+TEST_CASE("Coroutine turn flow") {
+    Game game;
+    seat_standard_players(game);
+    DecisionPoint decisions;
+    GameFlow flow = play_game(game, decisions);
+    
+    // The game starts suspended on Alice's decision
+    REQUIRE(decisions.is_waiting());
+    CHECK_EQ(decisions.waiting_for(), 0);
+    CHECK_THROWS_AS(decisions.submit(Action{ActionType::Gather, 1, NO_TARGET}), NotPlayerTurnException);
+    
+    // One action ends the turn
+    decisions.submit(Action{ActionType::Tax, 0, NO_TARGET});
+    CHECK_EQ(decisions.waiting_for(), 1);
+    CHECK_EQ(game.get_player(0)->get_coins(), 3);
+    
+    // Engine errors surface to the submitter and the same player decides again
+    CHECK_THROWS_AS(decisions.submit(Action{ActionType::Bribe, 1, NO_TARGET}), InsufficientCoinsException);
+    CHECK_EQ(decisions.waiting_for(), 1);
+    
+    // A timeout forfeits the turn
+    decisions.expire();
+    CHECK_EQ(decisions.waiting_for(), 2);
+    
+    // A bribe buys a second action in the same turn
+    game.get_player(2)->add_coins(4);
+    decisions.submit(Action{ActionType::Bribe, 2, NO_TARGET});
+    CHECK_EQ(decisions.waiting_for(), 2);
+    decisions.submit(Action{ActionType::Gather, 2, NO_TARGET});
+    CHECK_EQ(decisions.waiting_for(), 3);
+    CHECK_EQ(game.get_player(2)->get_coins(), 1);
+    CHECK_FALSE(flow.done());
+}
+
+TEST_CASE("Many suspended games") {
+    // Thousands of games interleaved on one thread, each suspended between decisions
+    const size_t table_count = 2000;
+    std::vector<std::unique_ptr<Game>> games;
+    std::vector<std::unique_ptr<DecisionPoint>> points;
+    std::vector<GameFlow> flows;
+    for (size_t i = 0; i < table_count; i++) {
+        games.push_back(std::make_unique<Game>());
+        seat_standard_players(*games.back());
+        points.push_back(std::make_unique<DecisionPoint>());
+        flows.push_back(play_game(*games.back(), *points.back()));
+    }
+    
+    size_t finished = 0;
+    while (finished < table_count) {
+        finished = 0;
+        for (size_t i = 0; i < table_count; i++) {
+            if (flows[i].done()) {
+                finished++;
+                continue;
+            }
+            Game& game = *games[i];
+            uint8_t seat = points[i]->waiting_for();
+            Action action{ActionType::Gather, seat, NO_TARGET};
+            if (game.get_player(seat)->get_coins() >= 7) {
+                uint8_t target = static_cast<uint8_t>((seat + 1) % game.player_count());
+                while (game.get_player(target)->is_eliminated()) {
+                    target = static_cast<uint8_t>((target + 1) % game.player_count());
+                }
+                action = Action{ActionType::Coup, seat, target};
+            }
+            points[i]->submit(action);
+        }
+    }
+    for (size_t i = 0; i < table_count; i++) {
+        flows[i].check();
+        CHECK(games[i]->is_game_over());
+    }
+}
+
+// Journal file in the working directory, removed when the test ends
+struct TempJournal {
+    std::string path;
+    explicit TempJournal(const std::string& name) : path(name) { unlink(path.c_str()); }
+    ~TempJournal() { unlink(path.c_str()); }
+};
+
+std::vector<JournalRecord> read_journal(const std::string& path) {
+    std::vector<JournalRecord> records;
+    replay_journal(path, [&](const JournalRecord& record) { records.push_back(record); });
+    return records;
+}
+
+TEST_CASE("Journal round trip and per-table sequences") {
+    TempJournal file("test_journal.wal");
+    JournalConfig config;
+    config.path = file.path;
+    config.durability_window = std::chrono::microseconds(200);
+    {
+        Journal journal(config);
+        for (uint32_t i = 0; i < 300; i++) {
+            journal.append(i % 3, Action{ActionType::Gather, static_cast<uint8_t>(i % 6), NO_TARGET});
+        }
+        uint64_t lsn = journal.append_reset(1);
+        journal.wait_durable(lsn);
+        CHECK_EQ(journal.durable_lsn(), 301);
+        CHECK_EQ(journal.last_seq(1), 101);
+    }
+    
+    std::vector<JournalRecord> records = read_journal(file.path);
+    REQUIRE_EQ(records.size(), 301);
+    CHECK_EQ(records[0].seq, 1);
+    CHECK_EQ(records[299].table, 2);
+    CHECK_EQ(records[299].seq, 100);
+    CHECK_EQ(records[300].action, JOURNAL_RESET);
+    
+    // Reopening continues the sequences
+    Journal reopened(config);
+    CHECK_EQ(reopened.last_seq(0), 100);
+    CHECK_EQ(reopened.last_seq(1), 101);
+}
+
+TEST_CASE("Journal recovers from a torn tail") {
+    TempJournal file("test_torn.wal");
+    JournalConfig config;
+    config.path = file.path;
+    {
+        Journal journal(config);
+        for (int i = 0; i < 10; i++) {
+            journal.append(5, Action{ActionType::Tax, 0, NO_TARGET});
+        }
+    }
+    
+    // Crash in the middle of a record, after a corrupted one
+    int fd = open(file.path.c_str(), O_WRONLY | O_APPEND);
+    uint8_t partial[JOURNAL_RECORD_SIZE];
+    encode_record(partial, JournalRecord{5, 11, 1, 0, NO_TARGET});
+    partial[3] ^= 0x40;
+    CHECK_EQ(write(fd, partial, JOURNAL_RECORD_SIZE), static_cast<ssize_t>(JOURNAL_RECORD_SIZE));
+    CHECK_EQ(write(fd, partial, 7), 7);
+    close(fd);
+    CHECK_EQ(read_journal(file.path).size(), 10);
+    
+    // Opening for append cuts the bad tail off and carries on
+    {
+        Journal journal(config);
+        CHECK_EQ(journal.last_seq(5), 10);
+        journal.append(5, Action{ActionType::Gather, 1, NO_TARGET});
+    }
+    std::vector<JournalRecord> records = read_journal(file.path);
+    REQUIRE_EQ(records.size(), 11);
+    CHECK_EQ(records.back().seq, 11);
+    CHECK_EQ(records.back().action, static_cast<uint8_t>(ActionType::Gather));
+}
+
+TEST_CASE("Journal keeps durable events across a process crash") {
+    TempJournal file("test_crash.wal");
+    pid_t child = fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        JournalConfig config;
+        config.path = file.path;
+        Journal journal(config);
+        uint64_t lsn = 0;
+        for (int i = 0; i < 1000; i++) {
+            lsn = journal.append(i % 8, Action{ActionType::Gather, 0, NO_TARGET});
+        }
+        journal.wait_durable(lsn);
+        for (int i = 0; i < 1000; i++) {
+            journal.append(i % 8, Action{ActionType::Tax, 0, NO_TARGET});
+        }
+        _exit(0); // no destructor: whatever was not yet committed is lost
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    
+    std::vector<JournalRecord> records = read_journal(file.path);
+    REQUIRE_GE(records.size(), 1000);
+    for (size_t i = 0; i < records.size(); i++) {
+        CHECK_EQ(records[i].seq, i / 8 + 1);
+    }
+}
+
+TEST_CASE("Journal reports storage errors instead of counting them durable") {
+    TempJournal file("test_full.wal");
+    JournalConfig config;
+    config.path = file.path;
+    Journal journal(config);
+    uint64_t lsn = journal.append_reset(0);
+    journal.wait_durable(lsn);
+
+    // Let the file grow by two more records only: the next write fails with EFBIG
+    struct rlimit saved;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    struct rlimit limit = saved;
+    limit.rlim_cur = JOURNAL_HEADER_SIZE + 3 * JOURNAL_RECORD_SIZE;
+    auto previous = signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &limit);
+    for (int i = 0; i < 10; i++) {
+        lsn = journal.append(0, Action{ActionType::Gather, 0, NO_TARGET});
+    }
+    CHECK_THROWS_AS(journal.wait_durable(lsn), JournalException);
+    setrlimit(RLIMIT_FSIZE, &saved);
+    signal(SIGXFSZ, previous);
+
+    CHECK_EQ(journal.durable_lsn(), 1);
+    CHECK_THROWS_AS(journal.append(0, Action{ActionType::Tax, 0, NO_TARGET}), JournalException);
+    CHECK_THROWS_AS(journal.wait_durable(lsn), JournalException);
+
+    // A table whose journal has failed refuses the action and keeps its state
+    Scheduler scheduler(1, false);
+    Table table(scheduler, 0, &journal);
+    uint8_t request[MAX_FRAME_SIZE];
+    uint8_t reply[MAX_FRAME_SIZE];
+    Frame frame;
+    encode_action(request, 0, Action{ActionType::Tax, 0, NO_TARGET});
+    REQUIRE_EQ(decode_frame(request, ACTION_FRAME_SIZE, frame), DecodeStatus::Ok);
+    REQUIRE_EQ(decode_frame(reply, table.execute(frame, reply), frame), DecodeStatus::Ok);
+    CHECK_EQ(frame.kind, FrameKind::Error);
+    CHECK_EQ(table.get_game().get_player(0)->get_coins(), 0);
+    CHECK_EQ(table.get_game().get_current_index(), 0);
+    CHECK_EQ(table.view().seat[0].coins, 0);
+    CHECK_EQ(table.get_seq(), 0);
+}
+
+TEST_CASE("Server tables recover from the journal") {
+    TempJournal file("test_server.wal");
+    Scheduler scheduler(1, false);
+    JournalConfig config;
+    config.path = file.path;
+    TableState expected;
+    {
+        Journal journal(config);
+        TableRegistry registry(scheduler, 4, &journal);
+        uint8_t buffer[MAX_FRAME_SIZE];
+        Frame frame;
+        Table& table = *registry.find(2);
+        encode_action(buffer, 2, Action{ActionType::Tax, 0, NO_TARGET});
+        decode_frame(buffer, ACTION_FRAME_SIZE, frame);
+        table.execute(frame, buffer);
+        encode_action(buffer, 2, Action{ActionType::NextTurn, 0, NO_TARGET});
+        decode_frame(buffer, ACTION_FRAME_SIZE, frame);
+        table.execute(frame, buffer);
+        expected = capture_state(table.get_game());
+    }
+    
+    TableRegistry restored(scheduler, 4);
+    CHECK_EQ(restored.recover("", file.path, 1), 2);
+    CHECK(capture_state(restored.find(2)->get_game()) == expected);
+}
+
+TEST_CASE("Snapshot plus journal tail recovery") {
+    TempJournal journal_file("test_snapshot.wal");
+    TempJournal snapshot_file("test_snapshot.snap");
+    Scheduler scheduler(1, false);
+    JournalConfig config;
+    config.path = journal_file.path;
+    std::vector<TableState> expected;
+    {
+        Journal journal(config);
+        TableRegistry registry(scheduler, 8, &journal);
+        uint8_t buffer[MAX_FRAME_SIZE];
+        Frame frame;
+        auto run = [&](uint32_t id, Action action) {
+            encode_action(buffer, id, action);
+            decode_frame(buffer, ACTION_FRAME_SIZE, frame);
+            registry.find(id)->execute(frame, buffer);
+        };
+        for (uint32_t id = 0; id < 8; id++) {
+            run(id, Action{ActionType::Tax, 0, NO_TARGET});
+            run(id, Action{ActionType::NextTurn, 0, NO_TARGET});
+            run(id, Action{ActionType::Gather, 1, NO_TARGET});
+            run(id, Action{ActionType::Arrest, 1, 0});
+        }
+
+        std::vector<TableSnapshot> snapshots;
+        for (uint32_t id = 0; id < 8; id++) {
+            snapshots.push_back(registry.find(id)->snapshot());
+        }
+        write_snapshot_file(snapshot_file.path, snapshots);
+
+        // The tail after the snapshot
+        for (uint32_t id = 0; id < 8; id += 2) {
+            run(id, Action{ActionType::NextTurn, 1, NO_TARGET});
+            run(id, Action{ActionType::Sanction, 2, 1});
+        }
+        for (uint32_t id = 0; id < 8; id++) {
+            expected.push_back(capture_state(registry.find(id)->get_game()));
+        }
+        CHECK_EQ(registry.find(0)->get_game().get_last_arrested(), registry.find(0)->get_game().get_player(0));
+    }
+
+    std::vector<TableSnapshot> loaded = read_snapshot_file(snapshot_file.path);
+    REQUIRE_EQ(loaded.size(), 8);
+    CHECK_EQ(loaded[3].seq, 4);
+    CHECK_EQ(loaded[3].last_arrested, 0);
+
+    TableRegistry restored(scheduler, 8);
+    CHECK_EQ(restored.recover(snapshot_file.path, journal_file.path, 3), 4);
+    for (uint32_t id = 0; id < 8; id++) {
+        CHECK(capture_state(restored.find(id)->get_game()) == expected[id]);
+    }
+    // last_arrested survives the snapshot
+    const Game& game = restored.find(1)->get_game();
+    CHECK_EQ(game.get_last_arrested(), game.get_player(0));
+}
+
+TEST_CASE("Snapshots never run ahead of the journal") {
+    TempJournal journal_file("test_ahead.wal");
+    TempJournal snapshot_file("test_ahead.snap");
+    Scheduler scheduler(1, false);
+    JournalConfig config;
+    config.path = journal_file.path;
+    config.durability_window = std::chrono::microseconds(100000);
+    uint8_t buffer[MAX_FRAME_SIZE];
+    Frame frame;
+    auto run = [&](TableRegistry& registry, Action action) {
+        encode_action(buffer, 0, action);
+        decode_frame(buffer, ACTION_FRAME_SIZE, frame);
+        registry.find(0)->execute(frame, buffer);
+    };
+    {
+        Journal journal(config);
+        TableRegistry registry(scheduler, 2, &journal);
+        run(registry, Action{ActionType::Tax, 0, NO_TARGET});
+        run(registry, Action{ActionType::NextTurn, 0, NO_TARGET});
+        registry.snapshot(snapshot_file.path);
+        // The snapshot waited for the events it includes to be committed
+        CHECK_EQ(journal.durable_lsn(), 2);
+    }
+    CHECK_EQ(read_snapshot_file(snapshot_file.path)[0].seq, 2);
+
+    // Lose the journal's events; the snapshot still has them
+    REQUIRE_EQ(truncate(journal_file.path.c_str(), JOURNAL_HEADER_SIZE), 0);
+    TableState expected;
+    {
+        Journal journal(config);
+        TableRegistry registry(scheduler, 2, &journal);
+        CHECK_EQ(registry.recover(snapshot_file.path, journal_file.path, 1), 0);
+        CHECK_EQ(journal.last_seq(0), 2);
+        run(registry, Action{ActionType::Gather, 1, NO_TARGET});
+        run(registry, Action{ActionType::NextTurn, 1, NO_TARGET});
+        expected = capture_state(registry.find(0)->get_game());
+    }
+    std::vector<JournalRecord> records = read_journal(journal_file.path);
+    REQUIRE_EQ(records.size(), 2);
+    CHECK_EQ(records[0].seq, 3);
+
+    // The events after the snapshot are replayed, not skipped
+    TableRegistry restored(scheduler, 2);
+    CHECK_EQ(restored.recover(snapshot_file.path, journal_file.path, 1), 2);
+    CHECK(capture_state(restored.find(0)->get_game()) == expected);
+}
+
+// Records what a table sends to one I/O loop
+class RecordingSink : public ReplySink {
+public:
+    size_t replies = 0;
+    std::vector<SharedFramePtr> broadcasts;
+
+    void deliver(uint64_t, const uint8_t*, size_t) override { replies++; }
+    void broadcast(const SharedFramePtr& frame) override { broadcasts.push_back(frame); }
+};
+
+TEST_CASE("Tables publish each change once to every spectating sink") {
+    Scheduler scheduler(1, false);
+    Table table(scheduler, 3);
+    RecordingSink first, second;
+    uint8_t request[MAX_FRAME_SIZE];
+    uint8_t reply[MAX_FRAME_SIZE];
+    Frame frame;
+    auto run = [&](Action action) {
+        encode_action(request, 3, action);
+        decode_frame(request, ACTION_FRAME_SIZE, frame);
+        return table.execute(frame, reply);
+    };
+
+    table.subscribe(&first);
+    table.subscribe(&first);
+    table.subscribe(&second);
+    size_t size = run(Action{ActionType::Gather, 0, NO_TARGET});
+    REQUIRE_EQ(first.broadcasts.size(), 1);
+    REQUIRE_EQ(second.broadcasts.size(), 1);
+    // One buffer, shared by both sinks, holding exactly the reply's bytes
+    CHECK_EQ(first.broadcasts[0].get(), second.broadcasts[0].get());
+    CHECK_EQ(first.broadcasts[0]->table, 3);
+    REQUIRE_EQ(first.broadcasts[0]->size, size);
+    CHECK(std::memcmp(first.broadcasts[0]->data, reply, size) == 0);
+
+    // Rejected actions change nothing and are not published
+    run(Action{ActionType::Gather, 4, NO_TARGET});
+    CHECK_EQ(first.broadcasts.size(), 1);
+
+    // The sink keeps receiving until its last spectator leaves
+    table.unsubscribe(&first);
+    run(Action{ActionType::NextTurn, 0, NO_TARGET});
+    CHECK_EQ(first.broadcasts.size(), 2);
+    table.unsubscribe(&first);
+    run(Action{ActionType::Gather, 1, NO_TARGET});
+    CHECK_EQ(first.broadcasts.size(), 2);
+    CHECK_EQ(second.broadcasts.size(), 3);
+}
+
+TEST_CASE("Lagging spectators catch up from a keyframe") {
+    std::string path = "/tmp/coup_spectator_test.sock";
+    ServerConfig config;
+    config.port = 0;
+    config.unix_path = path;
+    config.tables = 64;
+    GameServer server(config);
+    server.start();
+
+    auto connect_unix = [&]() {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        REQUIRE_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+        return fd;
+    };
+    // Reads frames until done() holds, handing each to on_frame
+    auto read_until = [](int fd, std::string& in, auto on_frame, auto done) {
+        char buffer[65536];
+        Frame frame;
+        while (!done()) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            REQUIRE_GT(n, 0);
+            in.append(buffer, static_cast<size_t>(n));
+            size_t start = 0;
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(in.data());
+            while (decode_frame(data + start, in.size() - start, frame) == DecodeStatus::Ok) {
+                on_frame(frame);
+                start += frame.length;
+            }
+            in.erase(0, start);
+        }
+    };
+
+    int spectator = connect_unix();
+    int player = connect_unix();
+    std::vector<TableState> watched(config.tables);
+    std::vector<TableState> played(config.tables);
+    std::string spectator_in, player_in, out;
+    uint8_t bytes[MAX_FRAME_SIZE];
+
+    size_t keyframes = 0;
+    auto watch = [&](const Frame& frame) {
+        REQUIRE_EQ(frame.kind, FrameKind::State);
+        keyframes += (frame.flags & STATE_KEYFRAME) ? 1 : 0;
+        apply_state(watched.at(frame.table), frame);
+    };
+    for (uint32_t table = 0; table < config.tables; table++) {
+        out.append(reinterpret_cast<char*>(bytes), encode_subscribe(bytes, table));
+    }
+    REQUIRE_EQ(send(spectator, out.data(), out.size(), 0), static_cast<ssize_t>(out.size()));
+    read_until(spectator, spectator_in, watch, [&] { return keyframes == config.tables; });
+
+    // Play every table hard while the spectator reads nothing
+    size_t actions = 0;
+    for (int round = 0; round < 600; round++) {
+        out.clear();
+        for (uint32_t table = 0; table < config.tables; table++) {
+            const TableState& state = played[table];
+            Action action{round % 2 ? ActionType::NextTurn : ActionType::Gather, state.current, NO_TARGET};
+            if (round % 2 == 0 && state.seats > 0 && state.seat[state.current].coins >= 7) {
+                for (uint8_t seat = 0; seat < state.seats; seat++) {
+                    if (seat != state.current && !(state.seat[seat].flags & SEAT_ELIMINATED)) {
+                        action = Action{ActionType::Coup, state.current, seat};
+                        break;
+                    }
+                }
+            }
+            out.append(reinterpret_cast<char*>(bytes), encode_action(bytes, table, action));
+        }
+        REQUIRE_EQ(send(player, out.data(), out.size(), 0), static_cast<ssize_t>(out.size()));
+        size_t replies = 0;
+        read_until(player, player_in, [&](const Frame& frame) {
+            REQUIRE_EQ(frame.kind, FrameKind::State);
+            apply_state(played.at(frame.table), frame);
+            replies++;
+        }, [&] { return replies == config.tables; });
+        actions += replies;
+    }
+
+    // The spectator is sent keyframes instead of the backlog and still converges
+    size_t frames = 0;
+    read_until(spectator, spectator_in, [&](const Frame& frame) {
+        watch(frame);
+        frames++;
+    }, [&] {
+        for (uint32_t table = 0; table < config.tables; table++) {
+            if (watched[table] != played[table]) {
+                return false;
+            }
+        }
+        return true;
+    });
+    CHECK_LT(frames, actions);
+    CHECK_GT(keyframes, config.tables);
+
+    // A peek is answered by the I/O loop from the table's published state
+    out.assign(reinterpret_cast<char*>(bytes), encode_peek(bytes, 5));
+    REQUIRE_EQ(send(player, out.data(), out.size(), 0), static_cast<ssize_t>(out.size()));
+    TableState peeked{};
+    bool answered = false;
+    read_until(player, player_in, [&](const Frame& frame) {
+        CHECK_EQ(frame.table, 5);
+        CHECK_EQ(frame.flags, STATE_KEYFRAME);
+        apply_state(peeked, frame);
+        answered = true;
+    }, [&] { return answered; });
+    CHECK(peeked == played[5]);
+    CHECK(server.table_view(5) == played[5]);
+    close(player);
+    close(spectator);
+    server.stop();
+}
+
+TEST_CASE("Seqlock readers see only complete states") {
+    // Readers start before the first publish below, so they must find a whole state already there
+    TableState state{};
+    state.seats = MAX_SEATS;
+    Seqlock<TableState> lock(state);
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+    std::atomic<int> reads(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&] {
+            uint32_t last_version = 0;
+            while (!done.load()) {
+                uint32_t version = lock.version();
+                TableState state = lock.read();
+                // Every publish below keeps all seats equal and current in step with them
+                for (uint8_t i = 1; i < MAX_SEATS; i++) {
+                    if (state.seat[i] != state.seat[0]) {
+                        torn++;
+                    }
+                }
+                if (state.seats != MAX_SEATS || state.current != state.seat[0].coins % MAX_SEATS ||
+                    version < last_version) {
+                    torn++;
+                }
+                last_version = version;
+                reads++;
+            }
+        });
+    }
+    for (int16_t i = 0; i < 20000; i++) {
+        state.current = static_cast<uint8_t>(i % MAX_SEATS);
+        for (auto& seat : state.seat) {
+            seat = SeatState{i, static_cast<uint8_t>(i & 3)};
+        }
+        lock.publish(state);
+        if (i % 64 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK_EQ(torn.load(), 0);
+    CHECK_GT(reads.load(), 0);
+    CHECK_EQ(lock.version(), 20001);
+    CHECK(lock.read() == state);
+}
+
+TEST_CASE("Tables publish their state after every change") {
+    Scheduler scheduler(1, false);
+    Table table(scheduler, 2);
+    CHECK(table.view() == capture_state(table.get_game()));
+    uint8_t request[MAX_FRAME_SIZE];
+    uint8_t reply[MAX_FRAME_SIZE];
+    Frame frame;
+    encode_action(request, 2, Action{ActionType::Tax, 0, NO_TARGET});
+    decode_frame(request, ACTION_FRAME_SIZE, frame);
+    table.execute(frame, reply);
+    TableState view = table.view();
+    CHECK(view == capture_state(table.get_game()));
+    CHECK_EQ(view.seat[0].coins, 3);
+}
+
+TEST_CASE("Terminal frames rewrite only the lines that changed") {
+    std::ostringstream out;
+    TerminalRenderer screen(out, true);
+    auto draw = [&](std::vector<std::string> lines) {
+        out.str("");
+        screen.begin();
+        for (const auto& line : lines) {
+            screen.line(line);
+        }
+        return screen.present();
+    };
+
+    // The first frame clears the screen and draws everything
+    CHECK_EQ(draw({"Alice - 0 coins", "Bob - 0 coins", "Choice: "}), 3);
+    CHECK_EQ(out.str().rfind("\x1b[H\x1b[2J", 0), 0);
+
+    CHECK_EQ(draw({"Alice - 1 coin", "Bob - 0 coins", "Choice: "}), 1);
+    CHECK_EQ(out.str(), "\x1b[1;1HAlice - 1 coin\x1b[K\x1b[4;1H\x1b[J\x1b[3;9H");
+
+    // Typed input is wiped by redrawing the prompt; a shorter frame erases what was below it
+    screen.input_taken();
+    CHECK_EQ(draw({"Alice - 1 coin", "Bob - 0 coins", "Choice: "}), 1);
+    CHECK_EQ(draw({"Alice - 1 coin", "Choice: "}), 1);
+    CHECK_NE(out.str().find("\x1b[3;1H\x1b[J"), std::string::npos);
+
+    // Frames taller than the terminal are redrawn whole
+    screen.set_rows(2);
+    CHECK_EQ(draw({"Alice - 1 coin", "Choice: "}), 2);
+
+    std::ostringstream plain;
+    TerminalRenderer text(plain, false);
+    text.begin();
+    text.line("a");
+    text.line("b: ");
+    text.present();
+    text.begin();
+    text.line("c: ");
+    text.present();
+    CHECK_EQ(plain.str(), "a\nb: \nc: ");
+}
+
+TEST_CASE("Command reader parses numbers across buffer refills") {
+    int fds[2];
+    REQUIRE_EQ(pipe(fds), 0);
+    std::string script = "1 8\n# pass and coup\n6 12\r\n\n  x7 123456789012 3";
+    REQUIRE_EQ(write(fds[1], script.data(), script.size()), static_cast<ssize_t>(script.size()));
+    close(fds[1]);
+
+    // A tiny buffer makes numbers and comments straddle reads
+    CommandReader commands(fds[0], 3);
+    std::vector<int> values;
+    int value;
+    while (commands.next(value)) {
+        values.push_back(value);
+    }
+    close(fds[0]);
+    CHECK_EQ(values, std::vector<int>{1, 8, 6, 12, 7, 1000000000, 3});
+    CHECK_FALSE(commands.next(value));
+}
+
+TEST_CASE("Scenarios compile to bytecode and report the failing line") {
+    ScenarioProgram program = compile_scenarios(
+        "# two scenarios\n"
+        "scenario Sanctions block taxes\n"
+        "player Gov Governor\n"
+        "player Baron Baron\n"
+        "give Baron 3\n"
+        "Baron sanction Gov\n"
+        "Gov tax fails sanctioned\n"
+        "next\n"
+        "expect turn Baron\n"
+        "expect Gov free\n"
+        "\n"
+        "scenario Wrong count\n"
+        "player Spy Spy\n"
+        "Spy tax\n"
+        "expect Spy 3\n",
+        "test.scn");
+    REQUIRE_EQ(program.size(), 2);
+    CHECK_EQ(program.name(0), "Sanctions block taxes");
+    CHECK_EQ(program.code[program.entries[0] + 1].op, ScenarioOp::Seat);
+
+    CHECK(run_scenario(program, 0).passed);
+    ScenarioResult result = run_scenario(program, 1);
+    CHECK_FALSE(result.passed);
+    CHECK_EQ(result.line, 15);
+    CHECK_EQ(result.message, "expected Spy to have 3 coins, has 2");
+
+    // An action that was expected to fail, or failed the wrong way, fails the scenario
+    CHECK_FALSE(run_scenario(compile_scenarios("scenario a\nplayer A Baron\nA gather fails\n"), 0).passed);
+    CHECK_FALSE(run_scenario(compile_scenarios("scenario a\nplayer A Baron\nA invest fails sanctioned\n"), 0).passed);
+
+    // Mistakes are caught when compiling, with the line they are on
+    auto error = [](const std::string& text) {
+        try {
+            compile_scenarios(text, "bad.scn");
+        } catch (const ScenarioException& e) {
+            return std::string(e.what());
+        }
+        return std::string();
+    };
+    CHECK_EQ(error("player A Spy\n"), "bad.scn:1: expected 'scenario' first");
+    CHECK_EQ(error("scenario a\nplayer A Jester\n"), "bad.scn:2: unknown role 'Jester'");
+    CHECK_EQ(error("scenario a\nplayer A Spy\nA coup B\n"), "bad.scn:3: unknown player 'B'");
+    CHECK_EQ(error("scenario a\nplayer A Spy\nA coup\n"), "bad.scn:3: 'coup' needs a target");
+    CHECK_EQ(error("scenario a\nplayer A Spy\nA tax fails broke\n"), "bad.scn:3: unknown error 'broke'");
+    CHECK_EQ(error("scenario a\nplayer A Spy\ngive A x\n"), "bad.scn:3: expected a number, got 'x'");
+    CHECK_EQ(error("scenario a\nnext\n"), "bad.scn:2: 'next' needs a seated player");
+}
+
+TEST_CASE("Variant role engine follows the virtual hierarchy") {
+    // Some role abilities print; keep them out of the test output
+    std::cout.setstate(std::ios_base::badbit);
+    std::mt19937 rng(7);
+    size_t performed = 0;
+    size_t refused = 0;
+    for (int round = 0; round < 300; round++) {
+        Game game;
+        seat_standard_players(game);
+        VariantGame variant;
+        seat_standard_players(variant);
+        for (int step = 0; step < 300 && !game.is_game_over(); step++) {
+            // Mostly the current player, with any action and any target, valid or not
+            uint8_t actor = rng() % 8 ? static_cast<uint8_t>(game.get_current_index()) : rng() % ROLE_COUNT;
+            ActionType type = static_cast<ActionType>(1 + rng() % (static_cast<uint8_t>(ActionType::Count) - 1));
+            uint8_t target = static_cast<uint8_t>(rng() % (ROLE_COUNT + 1));
+            // Extra coins now and then, so the costly actions come up too
+            if (rng() % 3 == 0) {
+                int coins = static_cast<int>(rng() % 4);
+                game.get_player(game.get_current_index())->add_coins(coins);
+                variant.add_coins(variant.get_current_index(), coins);
+            }
+            Action action{type, actor, target};
+
+            int seen = -1;
+            int variant_seen = -1;
+            int error = 0;
+            int variant_error = 0;
+            try {
+                seen = perform(game, action);
+            } catch (const std::exception& e) {
+                error = static_cast<int>(error_code_for(e));
+            }
+            try {
+                variant_seen = variant.perform(action);
+            } catch (const std::exception& e) {
+                variant_error = static_cast<int>(error_code_for(e));
+            }
+            REQUIRE_EQ(error, variant_error);
+            REQUIRE_EQ(seen, variant_seen);
+            (error ? refused : performed)++;
+
+            REQUIRE_EQ(game.get_current_index(), variant.get_current_index());
+            REQUIRE_EQ(game.is_game_over(), variant.is_game_over());
+            for (size_t seat = 0; seat < game.player_count(); seat++) {
+                const Player* player = game.get_player(seat);
+                const RoleState& state = variant.state(seat);
+                REQUIRE_EQ(player->get_coins(), state.coins);
+                REQUIRE_EQ(player->is_sanctioned(), state.sanctioned);
+                REQUIRE_EQ(player->is_eliminated(), !state.active);
+                REQUIRE_EQ(player->get_role(), ROLE_NAMES[variant.role(seat)]);
+            }
+        }
+        if (game.is_game_over()) {
+            CHECK_EQ(game.winner(), variant.winner());
+        }
+    }
+    std::cout.clear();
+    CHECK_GT(performed, 10000);
+    CHECK_GT(refused, 10000);
+}
+
+TEST_CASE("Rule sets change costs alike at compile time and at run time") {
+    constexpr RuleSet cheap = [] { RuleSet r; r.coup_cost = 5; r.tax = 3; return r; }();
+    static_assert(StaticRules<cheap>::get().coup_cost == 5);
+    CHECK_EQ(parse_rules("coup_cost=5,tax=3"), cheap);
+    CHECK_EQ(parse_rules(""), STANDARD_RULES);
+    CHECK_THROWS_AS(parse_rules("coup=5"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_rules("coup_cost=five"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_rules("coup_cost=-1"), std::invalid_argument);
+
+    BasicVariantGame<StaticRules<cheap>> fixed;
+    BasicVariantGame<RuntimeRules> configured(RuntimeRules{parse_rules("coup_cost=5,tax=3")});
+    BasicVariantGame<RuntimeRules> standard(RuntimeRules{STANDARD_RULES});
+    seat_standard_players(fixed);
+    seat_standard_players(configured);
+    seat_standard_players(standard);
+    CHECK_EQ(configured.get_rules(), cheap);
+
+    // The Governor taxes 3 under both; the Spy's tax pays 3 only under the house rule
+    auto play = [](auto& game, const Action& action) {
+        try {
+            game.perform(action);
+            return true;
+        } catch (const InvalidActionException&) {
+            return false;
+        }
+    };
+    auto tax_round = [&](auto& game) {
+        CHECK(play(game, Action{ActionType::Tax, 0, NO_TARGET}));
+        CHECK(play(game, Action{ActionType::NextTurn, 0, NO_TARGET}));
+        CHECK(play(game, Action{ActionType::Tax, 1, NO_TARGET}));
+        CHECK_EQ(game.state(0).coins, 3);
+    };
+    tax_round(fixed);
+    tax_round(configured);
+    tax_round(standard);
+    CHECK_EQ(fixed.state(1).coins, 3);
+    CHECK_EQ(configured.state(1).coins, 3);
+    CHECK_EQ(standard.state(1).coins, 2);
+
+    // Five coins buy a coup under the house rule only
+    fixed.add_coins(1, 2);
+    configured.add_coins(1, 2);
+    standard.add_coins(1, 3);
+    CHECK(play(fixed, Action{ActionType::Coup, 1, 2}));
+    CHECK(play(configured, Action{ActionType::Coup, 1, 2}));
+    CHECK_FALSE(play(standard, Action{ActionType::Coup, 1, 2}));
+    CHECK_EQ(fixed.state(1).coins, 0);
+    CHECK_FALSE(fixed.state(2).active);
+    CHECK_FALSE(configured.state(2).active);
+    CHECK(standard.state(2).active);
+
+    CHECK_FALSE(standard.must_coup());
+    standard.add_coins(1, STANDARD_RULES.forced_coup);
+    CHECK(standard.must_coup());
+
+    // Arrests take up to arrest_steal; the Merchant's bonus is a rule too
+    BasicVariantGame<RuntimeRules> generous(RuntimeRules{parse_rules("arrest_steal=3,merchant_bonus=2")});
+    seat_standard_players(generous);
+    generous.add_coins(0, 5);
+    generous.add_coins(1, 1);
+    generous.add_coins(5, 3);
+    CHECK(play(generous, Action{ActionType::Arrest, 0, 1}));
+    CHECK_EQ(generous.state(0).coins, 6);
+    CHECK_EQ(generous.state(1).coins, 0);
+    for (uint8_t seat = 0; seat < 5; seat++) {
+        CHECK(play(generous, Action{ActionType::NextTurn, seat, NO_TARGET}));
+    }
+    CHECK(play(generous, Action{ActionType::NextTurn, 5, NO_TARGET}));
+    CHECK_EQ(generous.state(5).coins, 5);
+}
+
+TEST_CASE("A merchant's arrest needs the coins it pays, in both engines") {
+    Game game;
+    seat_standard_players(game);
+    game.set_current_index(5);
+    game.get_player(1)->add_coins(1);
+    game.get_player(5)->add_coins(STANDARD_RULES.merchant_arrest_cost - 1);
+    CHECK_THROWS_WITH_AS(perform(game, Action{ActionType::Arrest, 5, 1}), "Not enough coins to arrest",
+                         InsufficientCoinsException);
+    CHECK_EQ(game.get_player(5)->get_coins(), STANDARD_RULES.merchant_arrest_cost - 1);
+    CHECK(game.get_last_arrested() == nullptr);
+    game.get_player(5)->add_coins(1);
+    perform(game, Action{ActionType::Arrest, 5, 1});
+    CHECK_EQ(game.get_player(5)->get_coins(), 0);
+
+    VariantGame variant;
+    seat_standard_players(variant);
+    for (uint8_t seat = 0; seat < 5; seat++) {
+        variant.perform(Action{ActionType::NextTurn, seat, NO_TARGET});
+    }
+    variant.add_coins(1, 1);
+    variant.add_coins(5, STANDARD_RULES.merchant_arrest_cost - 1);
+    CHECK_THROWS_WITH_AS(variant.perform(Action{ActionType::Arrest, 5, 1}), "Not enough coins to arrest",
+                         InsufficientCoinsException);
+    CHECK_EQ(variant.state(5).coins, STANDARD_RULES.merchant_arrest_cost - 1);
+    variant.add_coins(5, 1);
+    variant.perform(Action{ActionType::Arrest, 5, 1});
+    CHECK_EQ(variant.state(5).coins, 0);
+}
+
+TEST_CASE("Event log ring buffer") {
+    EventLog log(10);
+    CHECK_EQ(log.capacity(), 16);
+    CHECK(log.empty());
+    for (int16_t i = 0; i < 40; i++) {
+        log.append(Event{ActionType::Gather, 0, NO_TARGET, NO_TARGET, i, 0, 0});
+    }
+    // Only the newest capacity() events are kept
+    CHECK_EQ(log.size(), 16);
+    CHECK_EQ(log.first(), 24);
+    CHECK_EQ(log.end(), 40);
+    CHECK_EQ(log.at(24).actor_delta, 24);
+    CHECK_EQ(log.at(39).actor_delta, 39);
+    CHECK_THROWS_AS(log.at(23), std::out_of_range);
+    CHECK_THROWS_AS(log.at(40), std::out_of_range);
+    log.clear();
+    CHECK_EQ(log.size(), 0);
+    CHECK_EQ(sizeof(Event), 10);
+}
+
+TEST_CASE("Events record coin deltas and format lazily") {
+    Game game;
+    seat_standard_players(game);
+    EventLog log;
+    log.append(game_started_event(game));
+    log.append(perform_event(game, Action{ActionType::Tax, 0, NO_TARGET}));
+    log.append(perform_event(game, Action{ActionType::NextTurn, 0, NO_TARGET}));
+    perform(game, Action{ActionType::Gather, 1, NO_TARGET});
+    log.append(perform_event(game, Action{ActionType::Arrest, 1, 0}));
+
+    const Event& arrest = log.at(3);
+    CHECK_EQ(arrest.actor, 1);
+    CHECK_EQ(arrest.target, 0);
+    CHECK_EQ(arrest.actor_delta, 1);
+    CHECK_EQ(arrest.target_delta, -1);
+    CHECK_EQ(log.at(2).next, 1);
+
+    CHECK_EQ(format_event(log.at(0), game), "Game started with 6 players");
+    CHECK_EQ(format_event(log.at(1), game), "Alice (Governor) taxed 3 coins");
+    CHECK_EQ(format_event(log.at(2), game), "Alice's turn ended. Now Bob's turn.");
+    CHECK_EQ(format_event(arrest, game), "Bob arrested Alice and stole 1 coin");
+
+    // A rejected action throws before anything is logged
+    CHECK_THROWS_AS(perform_event(game, Action{ActionType::Gather, 3, NO_TARGET}), NotPlayerTurnException);
+    CHECK_EQ(log.size(), 4);
+
+    game.next_turn();
+    log.append(perform_event(game, Action{ActionType::Gather, 2, NO_TARGET}));
+    game.next_turn();
+    log.append(perform_event(game, Action{ActionType::Gather, 3, NO_TARGET}));
+    game.next_turn();
+    game.next_turn();
+    game.next_turn();
+    game.next_turn();
+    log.append(perform_event(game, Action{ActionType::ViewCoins, 1, 2}));
+    CHECK_EQ(format_event(log.at(6), game), "Bob (Spy) viewed that Charlie has 1 coin");
+
+    // Merchant events say what actually moved
+    for (int i = 0; i < 4; i++) {
+        game.next_turn();
+    }
+    game.get_player(5)->add_coins(4);
+    log.append(perform_event(game, Action{ActionType::Arrest, 5, 1}));
+    log.append(perform_event(game, Action{ActionType::Bonus, 5, NO_TARGET}));
+    game.get_player(5)->add_coins(1);
+    log.append(perform_event(game, Action{ActionType::Bonus, 5, NO_TARGET}));
+    CHECK_EQ(format_event(log.at(7), game), "Fiona arrested Bob and paid 2 coins to the bank");
+    CHECK_EQ(format_event(log.at(8), game), "Fiona (Merchant) got no bonus");
+    CHECK_EQ(format_event(log.at(9), game), "Fiona (Merchant) received a bonus of 1 coin");
+}
+
+// Plays turns of gathering (with a coup whenever the bot can afford one) and records them
+std::vector<Event> record_turns(Game& game, size_t turns) {
+    std::vector<Event> events{game_started_event(game)};
+    for (size_t i = 0; i < turns && !game.is_game_over(); i++) {
+        events.push_back(perform_event(game, bot_action(game, false)));
+        if (!game.is_game_over()) {
+            events.push_back(perform_event(game, bot_action(game, true)));
+        }
+    }
+    return events;
+}
+
+TEST_CASE("Replay files map games and seek to turns") {
+    TempJournal file("test_replay.cpr");
+    Game first;
+    seat_standard_players(first);
+    std::vector<Event> first_events = record_turns(first, 50);
+    Game second;
+    second.add_player(new Governor("Gina", &second));
+    second.add_player(new Spy("Sam", &second));
+    std::vector<Event> second_events = record_turns(second, 3);
+    {
+        ReplayOptions options;
+        options.index_stride = 4;
+        ReplayWriter writer(file.path, options);
+        CHECK_EQ(writer.add_game(first, first_events.data(), first_events.size()), 0);
+        CHECK_EQ(writer.add_game(second, second_events.data(), second_events.size()), 1);
+    }
+
+    ReplayFile replay(file.path);
+    REQUIRE_EQ(replay.game_count(), 2);
+    CHECK(replay.verify(0));
+    CHECK(replay.verify(1));
+
+    ReplayGame game = replay.game(0);
+    REQUIRE_EQ(game.event_count(), first_events.size());
+    CHECK_EQ(game.turn_count(), 51);
+    CHECK_EQ(game.index_size(), 13);
+    CHECK(std::equal(game.begin(), game.end(), first_events.begin()));
+    // Events are read in place from the mapping
+    CHECK_EQ(reinterpret_cast<uintptr_t>(game.begin()) % 4, 0);
+    CHECK_EQ(static_cast<const void*>(&game[0]), static_cast<const void*>(game.begin()));
+
+    // Each seek lands on the first event of the turn
+    size_t expected = 0;
+    for (uint32_t turn = 0; turn < game.turn_count(); turn++) {
+        CHECK_EQ(game.seek_turn(turn), expected);
+        while (expected < game.event_count() && game[expected++].action != ActionType::NextTurn) {
+        }
+    }
+    CHECK_EQ(game.seek_turn(game.turn_count()), game.event_count());
+    CHECK_THROWS_AS(game.seek_turn(game.turn_count() + 1), ReplayException);
+    CHECK_THROWS_AS(replay.game(2), ReplayException);
+
+    std::vector<RosterEntry> roster = replay.game(1).roster();
+    REQUIRE_EQ(roster.size(), 2);
+    CHECK_EQ(roster[1].name, "Sam");
+    CHECK_EQ(ROLE_NAMES[roster[1].role], "Spy");
+
+    // Re-playing a game through the engine reproduces its final state
+    Game rebuilt;
+    check_replay(game, rebuilt);
+    CHECK(capture_state(rebuilt) == capture_state(first));
+}
+
+TEST_CASE("Replay validation catches corruption and extraction copies games") {
+    TempJournal file("test_replay_corrupt.cpr");
+    TempJournal extracted("test_replay_extract.cpr");
+    Game game;
+    seat_standard_players(game);
+    std::vector<Event> events = record_turns(game, 20);
+    {
+        ReplayWriter writer(file.path);
+        writer.add_game(game, events.data(), events.size());
+        // A recorded outcome the engine does not agree with
+        events[1].actor_delta = 5;
+        writer.add_game(game, events.data(), events.size());
+    }
+    {
+        ReplayFile replay(file.path);
+        Game good;
+        CHECK_NOTHROW(check_replay(replay.game(0), good));
+        Game bad;
+        CHECK_THROWS_AS(check_replay(replay.game(1), bad), ReplayException);
+
+        ReplayWriter writer(extracted.path);
+        writer.add_game(replay.game(1));
+    }
+    ReplayFile copy(extracted.path);
+    REQUIRE_EQ(copy.game_count(), 1);
+    CHECK(copy.verify(0));
+    CHECK_EQ(copy.game(0)[1].actor_delta, 5);
+
+    // Flip a byte inside the first game
+    int fd = open(file.path.c_str(), O_RDWR);
+    uint8_t byte;
+    REQUIRE_EQ(pread(fd, &byte, 1, 60), 1);
+    byte ^= 0xFF;
+    REQUIRE_EQ(pwrite(fd, &byte, 1, 60), 1);
+    close(fd);
+    ReplayFile damaged(file.path);
+    CHECK_FALSE(damaged.verify(0));
+
+    std::vector<uint8_t> garbage(64, 0xAB);
+    fd = open(extracted.path.c_str(), O_WRONLY | O_TRUNC);
+    REQUIRE_EQ(write(fd, garbage.data(), garbage.size()), 64);
+    close(fd);
+    CHECK_THROWS_AS(ReplayFile(extracted.path), ReplayException);
+}
+
+TEST_CASE("Replay checkpoints rebuild the board at any turn") {
+    TempJournal file("test_replay_checkpoints.cpr");
+    Game game;
+    seat_standard_players(game);
+    std::vector<Event> events{game_started_event(game)};
+    std::vector<TableState> states{capture_state(game)};
+    std::vector<const Player*> arrested{nullptr};
+    const ActionType script[] = {ActionType::Tax, ActionType::Sanction, ActionType::Arrest, ActionType::Gather};
+    for (size_t turn = 0; turn < 40; turn++) {
+        uint8_t seat = static_cast<uint8_t>(game.get_current_index());
+        uint8_t target = static_cast<uint8_t>((seat + 1 + turn % 3) % game.player_count());
+        try {
+            events.push_back(perform_event(game, Action{script[turn % 4], seat, target}));
+        } catch (const std::exception&) {
+            // Not allowed (e.g. too poor or sanctioned); pass the turn instead
+        }
+        events.push_back(perform_event(game, Action{ActionType::NextTurn, seat, NO_TARGET}));
+        states.push_back(capture_state(game));
+        arrested.push_back(game.get_last_arrested());
+    }
+    CHECK(std::any_of(arrested.begin(), arrested.end(), [](const Player* player) { return player != nullptr; }));
+    CHECK(std::any_of(states.begin(), states.end(), [](const TableState& state) {
+        return std::any_of(state.seat, state.seat + state.seats,
+                           [](const SeatState& seat) { return seat.flags & SEAT_SANCTIONED; });
+    }));
+    {
+        ReplayOptions options;
+        options.index_stride = 4;
+        options.checkpoint_every = 3;
+        ReplayWriter writer(file.path, options);
+        writer.add_game(game, events.data(), events.size());
+    }
+
+    ReplayFile replay(file.path);
+    ReplayGame recorded = replay.game(0);
+    CHECK_EQ(recorded.checkpoint_interval(), 3);
+    CHECK_EQ(recorded.checkpoint_count(), 13);
+    for (uint32_t turn = 0; turn < recorded.turn_count(); turn++) {
+        Game rebuilt;
+        restore_turn(recorded, turn, rebuilt);
+        CHECK(capture_state(rebuilt) == states[turn]);
+        const Player* last = rebuilt.get_last_arrested();
+        CHECK_EQ(last ? last->get_name() : "", arrested[turn] ? arrested[turn]->get_name() : "");
+    }
+    Game finished;
+    restore_turn(recorded, recorded.turn_count(), finished);
+    CHECK(capture_state(finished) == capture_state(game));
+
+    // A cursor steps forward from where it is and restores from a checkpoint otherwise
+    ReplayCursor cursor(recorded);
+    for (uint32_t turn : {1u, 2u, 7u, 8u, 8u, 5u, 30u, 31u, 0u, 39u, 12u}) {
+        cursor.seek(turn);
+        CHECK_EQ(cursor.turn(), turn);
+        CHECK_EQ(cursor.event_position(), recorded.seek_turn(turn));
+        CHECK(capture_state(cursor.board()) == states[turn]);
+    }
+    cursor.seek(recorded.turn_count());
+    CHECK(capture_state(cursor.board()) == capture_state(game));
+    CHECK_THROWS_AS(cursor.seek(recorded.turn_count() + 1), ReplayException);
+}
+
+TEST_CASE("Event codec round-trips blocks on both decode paths") {
+    Game game;
+    seat_standard_players(game);
+    std::vector<Event> events = record_turns(game, 30);
+    // Seats past a nibble, large and negative coin amounts
+    events.push_back(Event{ActionType::Coup, 200, 17, NO_TARGET, -7, -1, 0});
+    events.push_back(Event{ActionType::NextTurn, 3, NO_TARGET, 40, 0, 0, 0});
+    events.push_back(Event{ActionType::Tax, 2, NO_TARGET, NO_TARGET, 30000, -30000, INT16_MIN});
+    std::vector<uint8_t> coded;
+    size_t size = encode_events(events.data(), events.size(), coded);
+    CHECK_EQ(size, coded.size());
+    CHECK_LT(size, events.size() * sizeof(Event) / 2);
+    for (bool simd : {true, false}) {
+        std::vector<Event> decoded(events.size());
+        CHECK_EQ(decode_events(coded.data(), coded.size(), decoded.data(), decoded.size(), simd), size);
+        CHECK(decoded == events);
+    }
+
+    // A gather is a header, a seat byte and one varint
+    std::vector<uint8_t> gather;
+    Event gathered{ActionType::Gather, 1, NO_TARGET, NO_TARGET, 1, 0, 0};
+    CHECK_EQ(encode_events(&gathered, 1, gather), 3);
+    for (size_t cut = 0; cut < coded.size(); cut += 7) {
+        std::vector<Event> decoded(events.size());
+        CHECK_THROWS_AS(decode_events(coded.data(), cut, decoded.data(), decoded.size()), CodecException);
+    }
+
+    // An action nibble past the last action is refused on both paths
+    std::vector<uint8_t> corrupt(coded);
+    corrupt[3] |= 0x0F;
+    for (bool simd : {true, false}) {
+        std::vector<Event> decoded(events.size());
+        CHECK_THROWS_WITH_AS(decode_events(corrupt.data(), corrupt.size(), decoded.data(), decoded.size(), simd),
+                             "Event has an unknown action", CodecException);
+    }
+}
+
+TEST_CASE("Packed replays read like raw ones") {
+    TempJournal raw_file("test_replay_raw.cpr");
+    TempJournal packed_file("test_replay_packed.cpr");
+    Game game;
+    seat_standard_players(game);
+    std::vector<Event> events = record_turns(game, 60);
+    ReplayOptions options;
+    options.index_stride = 4;
+    options.checkpoint_every = 5;
+    {
+        ReplayWriter writer(raw_file.path, options);
+        writer.add_game(game, events.data(), events.size());
+        options.packed = true;
+        ReplayWriter packed_writer(packed_file.path, options);
+        packed_writer.add_game(game, events.data(), events.size());
+    }
+    ReplayFile raw(raw_file.path);
+    ReplayFile packed(packed_file.path);
+    ReplayGame plain = raw.game(0);
+    ReplayGame coded = packed.game(0);
+    CHECK_FALSE(plain.packed());
+    CHECK(coded.packed());
+    CHECK_EQ(coded.begin(), nullptr);
+    CHECK_LT(coded.size(), plain.size());
+    CHECK(coded.all_events() == events);
+    CHECK_EQ(coded.event(33), events[33]);
+    for (uint32_t turn = 0; turn <= coded.turn_count(); turn++) {
+        CHECK_EQ(coded.seek_turn(turn), plain.seek_turn(turn));
+        Game from_raw;
+        Game from_packed;
+        restore_turn(plain, turn, from_raw);
+        restore_turn(coded, turn, from_packed);
+        CHECK(capture_state(from_packed) == capture_state(from_raw));
+    }
+    Game rebuilt;
+    check_replay(coded, rebuilt);
+    CHECK(capture_state(rebuilt) == capture_state(game));
+}
+
+std::vector<int32_t> round_trip_chunk(const std::vector<int32_t>& values, ColumnEncoding& encoding) {
+    std::vector<uint8_t> chunk;
+    encode_chunk(values.data(), values.size(), chunk);
+    encoding = static_cast<ColumnEncoding>(chunk[0]);
+    std::vector<int32_t> decoded(values.size());
+    decode_chunk(chunk.data(), chunk.size(), values.size(), decoded.data());
+    return decoded;
+}
+
+TEST_CASE("Column chunks pick the smallest encoding") {
+    ColumnEncoding encoding;
+    std::vector<int32_t> runs(5000, 7);
+    std::fill(runs.begin() + 2500, runs.end(), -3);
+    CHECK(round_trip_chunk(runs, encoding) == runs);
+    CHECK_EQ(encoding, ColumnEncoding::RunLength);
+
+    std::vector<int32_t> few;
+    for (int32_t i = 0; i < 5000; i++) {
+        few.push_back((i * 7919) % 5 - 2);
+    }
+    CHECK(round_trip_chunk(few, encoding) == few);
+    CHECK_EQ(encoding, ColumnEncoding::Dictionary);
+
+    std::vector<int32_t> distinct;
+    for (int32_t i = 0; i < 10000; i++) {
+        distinct.push_back(i % 2 ? i * 1000 : -i);
+    }
+    distinct.push_back(INT32_MIN);
+    distinct.push_back(INT32_MAX);
+    CHECK(round_trip_chunk(distinct, encoding) == distinct);
+    CHECK_EQ(encoding, ColumnEncoding::Plain);
+
+    std::vector<int32_t> single{42};
+    CHECK(round_trip_chunk(single, encoding) == single);
+
+    // Corrupt chunks are rejected rather than read past their end
+    std::vector<uint8_t> chunk;
+    encode_chunk(runs.data(), runs.size(), chunk);
+    std::vector<int32_t> decoded(runs.size() + 1);
+    CHECK_THROWS_AS(decode_chunk(chunk.data(), chunk.size(), runs.size() + 1, decoded.data()), ColumnarException);
+    chunk[0] = 9;
+    CHECK_THROWS_AS(decode_chunk(chunk.data(), chunk.size(), runs.size(), decoded.data()), ColumnarException);
+}
+
+TEST_CASE("Columnar files stream from several writers and scan by column") {
+    TempJournal file("test_columnar.cpc");
+    const size_t PRODUCERS = 4;
+    const int32_t ROWS = 100000;
+    {
+        ColumnarWriter writer(file.path, {{"numbers", {"id", "square", "parity"}}, {"empty", {"x"}}});
+        std::vector<std::thread> producers;
+        for (size_t p = 0; p < PRODUCERS; p++) {
+            producers.emplace_back([&, p] {
+                ColumnBatch batch = writer.batch(0);
+                for (int32_t i = static_cast<int32_t>(p); i < ROWS; i += PRODUCERS) {
+                    writer.append(batch, {i, (i % 1000) * (i % 1000) % 1000, i % 2});
+                }
+                writer.flush(batch);
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+    }
+
+    ColumnarFile columns(file.path);
+    REQUIRE_EQ(columns.tables().size(), 2);
+    CHECK_EQ(columns.table("numbers").rows, ROWS);
+    CHECK_EQ(columns.table("empty").rows, 0);
+
+    std::vector<int32_t> ids;
+    columns.scan("numbers", "id", [&](const int32_t* values, size_t count) { ids.insert(ids.end(), values, values + count); });
+    std::vector<int32_t> squares;
+    columns.scan("numbers", "square", [&](const int32_t* values, size_t count) {
+        squares.insert(squares.end(), values, values + count);
+    });
+    REQUIRE_EQ(ids.size(), ROWS);
+    REQUIRE_EQ(squares.size(), ROWS);
+    bool rows_intact = true;
+    for (size_t i = 0; i < ids.size(); i++) {
+        rows_intact = rows_intact && squares[i] == (ids[i] % 1000) * (ids[i] % 1000) % 1000;
+    }
+    CHECK(rows_intact);
+    std::sort(ids.begin(), ids.end());
+    CHECK_EQ(ids.front(), 0);
+    CHECK_EQ(ids.back(), ROWS - 1);
+    CHECK(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+    CHECK_THROWS_AS(columns.scan("numbers", "cube", [](const int32_t*, size_t) {}), ColumnarException);
+}
+
+TEST_CASE("Columnar files with a corrupt footer are refused") {
+    TempJournal file("test_corrupt.cpc");
+    // A footer whose checksum holds but whose first varint never ends
+    uint8_t bytes[COLUMNAR_HEADER_SIZE + 1 + COLUMNAR_TRAILER_SIZE] = {};
+    std::memcpy(bytes, COLUMNAR_MAGIC, 4);
+    put_u16(bytes + 4, COLUMNAR_VERSION);
+    uint8_t* footer = bytes + COLUMNAR_HEADER_SIZE;
+    footer[0] = 0x80;
+    uint8_t* trailer = footer + 1;
+    put_u64(trailer, COLUMNAR_HEADER_SIZE);
+    put_u32(trailer + 8, crc32(footer, 1));
+    std::memcpy(trailer + 12, COLUMNAR_MAGIC, 4);
+    std::ofstream(file.path, std::ios::binary).write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    CHECK_THROWS_AS(ColumnarFile{file.path}, ColumnarException);
+}
+
+TEST_CASE("Saved games round-trip the whole table and read in place") {
+    Game game;
+    seat_standard_players(game);
+    game.add_player(new Player("A very long player name that will not fit inline", "Jester", &game));
+    Player* alice = game.get_player(0);
+    Player* bob = game.get_player(1);
+    Player* diana = game.get_player(3);
+    alice->add_coins(9);
+    bob->add_coins(70000);
+    bob->set_sanctioned(true);
+    diana->eliminate();
+    alice->set_last_arrested(bob);
+    game.set_last_arrested(game.get_player(2));
+    game.set_current_index(4);
+
+    std::vector<uint8_t> buffer{0xAA};
+    size_t size = save_game(game, buffer);
+    CHECK_EQ(size, saved_size(game));
+    REQUIRE_EQ(buffer.size(), 1 + size);
+
+    SavedGame saved(buffer.data() + 1, size);
+    CHECK_EQ(saved.version(), SAVE_VERSION);
+    CHECK_EQ(saved.seat_count(), 7);
+    CHECK_EQ(saved.current(), 4);
+    CHECK_EQ(saved.last_arrested(), 2);
+    CHECK_EQ(saved.seat(1).coins(), 70000);
+    CHECK(saved.seat(1).sanctioned());
+    CHECK(saved.seat(3).eliminated());
+    CHECK_EQ(saved.seat(6).role(), "Jester");
+    // Names are views into the buffer, not copies
+    std::string_view name = saved.seat(6).name();
+    CHECK_EQ(name, "A very long player name that will not fit inline");
+    CHECK(reinterpret_cast<const uint8_t*>(name.data()) > buffer.data());
+    CHECK(reinterpret_cast<const uint8_t*>(name.data()) < buffer.data() + buffer.size());
+    CHECK_THROWS_AS(saved.seat(7), std::out_of_range);
+
+    Game loaded;
+    load_game(saved, loaded);
+    CHECK(capture_state(loaded) == capture_state(game));
+    REQUIRE_EQ(loaded.player_count(), 7);
+    for (size_t i = 0; i < game.player_count(); i++) {
+        CHECK_EQ(loaded.get_player(i)->get_name(), game.get_player(i)->get_name());
+        CHECK_EQ(loaded.get_player(i)->get_role(), game.get_player(i)->get_role());
+        CHECK_EQ(loaded.get_player(i)->get_coins(), game.get_player(i)->get_coins());
+    }
+    CHECK(dynamic_cast<Spy*>(loaded.get_player(1)) != nullptr);
+    CHECK_EQ(loaded.get_player(0)->get_last_arrested(), loaded.get_player(1));
+    CHECK_EQ(loaded.get_player(1)->get_last_arrested(), nullptr);
+    CHECK_EQ(loaded.get_last_arrested(), loaded.get_player(2));
+    CHECK_EQ(loaded.turn(), "Ethan");
+    // Saving the loaded game gives the same bytes
+    std::vector<uint8_t> again;
+    save_game(loaded, again);
+    CHECK(std::equal(again.begin(), again.end(), buffer.begin() + 1));
+    // The restored arrest still blocks a repeat
+    loaded.get_player(4)->add_coins(1);
+    CHECK_THROWS_AS(perform(loaded, Action{ActionType::Arrest, 4, 2}), ConsecutiveArrestException);
+
+    Game empty;
+    std::vector<uint8_t> none;
+    save_game(empty, none);
+    Game empty_loaded;
+    load_game(SavedGame(none.data(), none.size()), empty_loaded);
+    CHECK_EQ(empty_loaded.player_count(), 0);
+}
+
+TEST_CASE("Saved games reject damage and accept wider seats") {
+    Game game;
+    seat_standard_players(game);
+    game.get_player(2)->add_coins(5);
+    std::vector<uint8_t> buffer;
+    save_game(game, buffer);
+    uint8_t small[8];
+    CHECK_THROWS_AS(save_game(game, small, sizeof(small)), std::length_error);
+
+    for (size_t cut = 0; cut < buffer.size(); cut++) {
+        CHECK_THROWS_AS(SavedGame(buffer.data(), cut), SaveException);
+    }
+    auto damaged = [&](size_t offset, uint8_t value) {
+        std::vector<uint8_t> copy = buffer;
+        copy[offset] = value;
+        return copy;
+    };
+    std::vector<uint8_t> bad = damaged(0, 'X');
+    CHECK_THROWS_AS(SavedGame(bad.data(), bad.size()), SaveException);
+    bad = damaged(4, SAVE_VERSION + 1);
+    CHECK_THROWS_AS(SavedGame(bad.data(), bad.size()), SaveException);
+    bad = damaged(14, 6);
+    CHECK_THROWS_AS(SavedGame(bad.data(), bad.size()), SaveException);
+    bad = damaged(SAVE_HEADER_SIZE + 6, 9);
+    CHECK_THROWS_AS(SavedGame(bad.data(), bad.size()), SaveException);
+    bad = damaged(SAVE_HEADER_SIZE + 15, 0x10);
+    CHECK_THROWS_AS(SavedGame(bad.data(), bad.size()), SaveException);
+
+    // A later version's wider seats, with an extra field this build does not know
+    const size_t WIDE_SEAT = SAVE_SEAT_SIZE + 4;
+    size_t seats = game.player_count();
+    size_t grown = 4 * seats;
+    std::vector<uint8_t> wide(buffer.size() + grown, 0);
+    std::memcpy(wide.data(), buffer.data(), SAVE_HEADER_SIZE);
+    put_u16(wide.data() + 6, WIDE_SEAT);
+    put_u32(wide.data() + 8, static_cast<uint32_t>(wide.size()));
+    for (size_t i = 0; i < seats; i++) {
+        uint8_t* seat = wide.data() + SAVE_HEADER_SIZE + WIDE_SEAT * i;
+        std::memcpy(seat, buffer.data() + SAVE_HEADER_SIZE + SAVE_SEAT_SIZE * i, SAVE_SEAT_SIZE);
+        put_u32(seat + 12, get_u32(seat + 12) + static_cast<uint32_t>(grown));
+        put_u32(seat + SAVE_SEAT_SIZE, 0xDEADBEEF);
+    }
+    size_t strings = SAVE_HEADER_SIZE + SAVE_SEAT_SIZE * seats;
+    std::memcpy(wide.data() + strings + grown, buffer.data() + strings, buffer.size() - strings);
+    Game loaded;
+    load_game(SavedGame(wide.data(), wide.size()), loaded);
+    CHECK(capture_state(loaded) == capture_state(game));
+    CHECK_EQ(loaded.get_player(5)->get_name(), "Fiona");
+}
+
+struct RecordingListener : GameListener {
+    std::vector<std::string> changes;
+    void player_changed(const Player& player) override { changes.push_back(player.get_name()); }
+    void turn_changed(size_t previous, size_t current) override {
+        changes.push_back("turn " + std::to_string(previous) + ">" + std::to_string(current));
+    }
+};
+
+TEST_CASE("Games report each player change to their listener") {
+    Game game;
+    seat_standard_players(game);
+    game.get_player(1)->add_coins(3);
+    RecordingListener listener;
+    game.set_listener(&listener);
+
+    perform(game, Action{ActionType::Gather, 0, NO_TARGET});
+    CHECK_EQ(listener.changes, std::vector<std::string>{"Alice"});
+    listener.changes.clear();
+    perform(game, Action{ActionType::Arrest, 0, 1});
+    CHECK_EQ(listener.changes, std::vector<std::string>{"Bob", "Alice"});
+    listener.changes.clear();
+    perform(game, Action{ActionType::NextTurn, 0, NO_TARGET});
+    CHECK_EQ(listener.changes, std::vector<std::string>{"turn 0>1"});
+
+    // Nothing is reported when nothing changes
+    listener.changes.clear();
+    game.get_player(2)->set_sanctioned(false);
+    game.get_player(2)->add_coins(0);
+    game.set_current_index(1);
+    CHECK(listener.changes.empty());
+    game.get_player(2)->set_sanctioned(true);
+    game.get_player(2)->eliminate();
+    game.get_player(2)->eliminate();
+    CHECK_EQ(listener.changes, std::vector<std::string>{"Charlie", "Charlie"});
+
+    // Copies start without a listener
+    listener.changes.clear();
+    Game copy(game);
+    CHECK_EQ(copy.get_listener(), nullptr);
+    copy.get_player(0)->add_coins(1);
+    CHECK(listener.changes.empty());
+}
+
+TEST_CASE("Copies of a game in progress keep its state") {
+    Game game;
+    seat_standard_players(game);
+    game.get_player(0)->add_coins(8);
+    game.get_player(2)->add_coins(2);
+    perform(game, Action{ActionType::Arrest, 0, 2});
+    perform(game, Action{ActionType::Sanction, 0, 1});
+    perform(game, Action{ActionType::NextTurn, 0, NO_TARGET});
+    game.get_player(4)->eliminate();
+    game.get_player(3)->set_last_arrested(game.get_player(5));
+
+    Game copy(game);
+    CHECK(capture_state(copy) == capture_state(game));
+    CHECK_EQ(copy.get_last_arrested(), copy.get_player(2));
+    CHECK_EQ(copy.get_player(3)->get_last_arrested(), copy.get_player(5));
+    CHECK(dynamic_cast<Baron*>(copy.get_player(2)) != nullptr);
+    CHECK_EQ(copy.get_player(1)->get_game(), &copy);
+
+    Game assigned;
+    seat_standard_players(assigned);
+    assigned = game;
+    CHECK(capture_state(assigned) == capture_state(game));
+    CHECK_EQ(assigned.get_last_arrested(), assigned.get_player(2));
+}
+
+TEST_CASE("SPSC queue hands values across threads in order") {
+    SpscQueue<uint32_t, 8> queue;
+    uint32_t value = 0;
+    CHECK_FALSE(queue.try_pop(value));
+    for (uint32_t i = 0; i < 8; i++) {
+        CHECK(queue.try_push(i));
+    }
+    CHECK_FALSE(queue.try_push(8));
+    CHECK(queue.try_pop(value));
+    CHECK_EQ(value, 0);
+
+    SpscQueue<uint32_t, 64> ring;
+    const uint32_t COUNT = 200000;
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < COUNT; i++) {
+            while (!ring.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    bool ordered = true;
+    for (uint32_t expected = 0; expected < COUNT;) {
+        if (ring.try_pop(value)) {
+            ordered = ordered && value == expected;
+            expected++;
+        }
+    }
+    producer.join();
+    CHECK(ordered);
+}
+
+TEST_CASE("Engine thread publishes updates a UI can replay onto its copy") {
+    Game game;
+    seat_standard_players(game);
+    Game mirror(game);
+    TableState shown = capture_state(mirror);
+    std::vector<EngineUpdate> received;
+    auto drain_all = [&](EngineThread& engine, size_t expected) {
+        while (received.size() < expected) {
+            engine.drain([&](const EngineUpdate& update) {
+                received.push_back(update);
+                apply_update(shown, update);
+            });
+        }
+    };
+
+    EngineThread engine(game);
+    engine.submit(Action{ActionType::Tax, 0, NO_TARGET}, true);
+    engine.submit(Action{ActionType::Gather, 1, NO_TARGET});
+    engine.submit(Action{ActionType::Coup, 1, 0});
+    drain_all(engine, 4);
+    CHECK_EQ(received[0].error, 0);
+    CHECK_EQ(received[0].event.actor_delta, 3);
+    REQUIRE_EQ(received[0].count, 1);
+    CHECK_EQ(received[0].changed[0].seat, 0);
+    CHECK_EQ(received[1].event.action, ActionType::NextTurn);
+    CHECK_EQ(received[1].current, 1);
+    REQUIRE_EQ(received[2].count, 1);
+    CHECK_EQ(received[2].changed[0].seat, 1);
+    CHECK_EQ(received[2].changed[0].state.coins, 1);
+    CHECK_EQ(received[3].error, static_cast<uint8_t>(ErrorCode::InsufficientCoins));
+    CHECK_EQ(received[3].count, 0);
+
+    // Bot turns without coups never end the game; the copy keeps up
+    engine.start_bot(3000, 0, false);
+    while (engine.bot_running()) {
+        engine.drain([&](const EngineUpdate& update) { apply_update(shown, update); });
+    }
+
+    // Stopping the bot in the middle of one of its turns still stops it
+    for (int i = 0; i < 200; i++) {
+        engine.start_bot(1000000, 0, false);
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        engine.stop_bot();
+        engine.drain([&](const EngineUpdate& update) { apply_update(shown, update); });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    CHECK_FALSE(engine.bot_running());
+    engine.stop();
+    engine.drain([&](const EngineUpdate& update) { apply_update(shown, update); });
+    CHECK_FALSE(engine.stopped_game().is_game_over());
+    CHECK(shown == capture_state(engine.stopped_game()));
+    apply_table_state(mirror, shown);
+    CHECK(capture_state(mirror) == shown);
+}
+
+TEST_CASE("Engine thread plays tables past the seat byte and addresses updates by player") {
+    Game game;
+    for (size_t seat = 0; seat < 1000; seat++) {
+        game.add_player(make_role_player(ROLE_NAMES[seat % ROLE_COUNT], standard_name(seat), &game));
+    }
+    game.set_current_index(700);
+    game.get_player(700)->add_coins(STANDARD_RULES.coup_cost);
+    Game mirror(game);
+    std::vector<EngineUpdate> received;
+
+    EngineThread engine(game);
+    engine.submit(SeatAction{ActionType::Coup, 700, 999}, true);
+    engine.submit(SeatAction{ActionType::Arrest, 701, 999});
+    while (received.size() < 3) {
+        engine.drain([&](const EngineUpdate& update) {
+            received.push_back(update);
+            apply_update(mirror, update);
+        });
+    }
+    CHECK_EQ(received[0].error, 0);
+    CHECK_EQ(received[0].actor, 700);
+    CHECK_EQ(received[0].target, 999);
+    CHECK_EQ(received[0].event.actor, NO_TARGET);
+    REQUIRE_EQ(received[0].count, 2);
+    CHECK_EQ(received[0].changed[0].seat, 700);
+    CHECK_EQ(received[0].changed[0].state.coins, 0);
+    CHECK_EQ(received[0].changed[1].seat, 999);
+    CHECK_NE(received[0].changed[1].state.flags & SEAT_ELIMINATED, 0);
+    CHECK_EQ(received[1].event.action, ActionType::NextTurn);
+    CHECK_EQ(received[1].current, 701);
+    CHECK_EQ(received[2].error, static_cast<uint8_t>(ErrorCode::InvalidAction));
+    CHECK(mirror.get_player(999)->is_eliminated());
+    CHECK_EQ(mirror.get_current_index(), 701);
+
+    // The bot plays the large table too, and the copy keeps up from the updates alone
+    engine.start_bot(5000, 0, true);
+    while (engine.bot_running()) {
+        engine.drain([&](const EngineUpdate& update) { apply_update(mirror, update); });
+    }
+    engine.stop();
+    engine.drain([&](const EngineUpdate& update) { apply_update(mirror, update); });
+    const Game& played = engine.stopped_game();
+    CHECK_EQ(mirror.get_current_index(), played.get_current_index());
+    bool same = true;
+    for (size_t seat = 0; seat < played.player_count(); seat++) {
+        same = same && seat_state(*mirror.get_player(seat)) == seat_state(*played.get_player(seat));
+    }
+    CHECK(same);
+}
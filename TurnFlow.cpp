@@ -0,0 +1,168 @@
+#pragma once
+#include "Action.cpp"
+#include <coroutine>
+#include <exception>
+
+/*
+ * Coroutine-based turn flow.
+ * play_game() runs the turn loop of one game as a C++20 coroutine that suspends on
+ * co_await whenever it needs the current player's decision. Whoever has the decision
+ * (a UI, a network client, a bot thread, a timeout) hands it in with
+ * DecisionPoint::submit(), which resumes the game inline until it needs the next one.
+ * A suspended game costs only its coroutine frame; no thread is parked on it.
+ *
+ * Turn rules applied by the flow: each turn is one action followed by next_turn(),
+ * a bribe grants the same player one extra action, and a rejected action lets the
+ * player decide again.
+ */
+
+class DecisionPoint {
+private:
+    std::coroutine_handle<> waiting;
+    uint8_t waiting_seat;
+    Action decision;
+    std::exception_ptr rejection;
+
+public:
+    DecisionPoint() : waiting(nullptr), waiting_seat(NO_TARGET), decision{ActionType::None, 0, NO_TARGET} {}
+    DecisionPoint(const DecisionPoint&) = delete;
+    DecisionPoint& operator=(const DecisionPoint&) = delete;
+
+    struct Awaiter {
+        DecisionPoint& point;
+        uint8_t seat;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            point.waiting = handle;
+            point.waiting_seat = seat;
+        }
+        Action await_resume() noexcept {
+            point.waiting = nullptr;
+            point.waiting_seat = NO_TARGET;
+            return point.decision;
+        }
+    };
+
+    // Suspends the game until seat's decision is submitted
+    Awaiter decide(uint8_t seat) { return Awaiter{*this, seat}; }
+
+    bool is_waiting() const { return static_cast<bool>(waiting); }
+    uint8_t waiting_for() const { return waiting_seat; }
+
+    // Called by the game when the decision it was given failed
+    void reject(std::exception_ptr error) { rejection = error; }
+
+    // Resumes the game with a decision. Engine errors raised by the action are
+    // rethrown here, and the game goes back to waiting for the same player.
+    void submit(const Action& action) {
+        if (!waiting) {
+            throw InvalidActionException("No decision is pending");
+        }
+        if (action.actor != waiting_seat) {
+            throw NotPlayerTurnException("It is not this player's turn");
+        }
+        decision = action;
+        rejection = nullptr;
+        waiting.resume();
+        if (rejection) {
+            std::exception_ptr error = rejection;
+            rejection = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    // Timeout path: the waiting player forfeits the rest of the turn
+    void expire() {
+        submit(Action{ActionType::NextTurn, waiting_seat, NO_TARGET});
+    }
+};
+
+// Owning handle for a game coroutine; the frame is destroyed with the handle
+class GameFlow {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+
+        GameFlow get_return_object() {
+            return GameFlow(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit GameFlow(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+public:
+    GameFlow(GameFlow&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    GameFlow& operator=(GameFlow&& other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+    GameFlow(const GameFlow&) = delete;
+    GameFlow& operator=(const GameFlow&) = delete;
+
+    ~GameFlow() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    bool done() const { return !handle || handle.done(); }
+
+    // Rethrows anything that escaped the turn loop
+    void check() const {
+        if (handle && handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+};
+
+// Runs the game until a winner remains, awaiting each decision from decisions
+GameFlow play_game(Game& game, DecisionPoint& decisions) {
+    while (!game.is_game_over()) {
+        uint8_t seat = static_cast<uint8_t>(game.get_current_index());
+        Action action = co_await decisions.decide(seat);
+        try {
+            perform(game, action);
+        } catch (const std::exception&) {
+            decisions.reject(std::current_exception());
+            continue;
+        }
+        if (action.type == ActionType::NextTurn || game.is_game_over()) {
+            continue;
+        }
+        if (action.type == ActionType::Bribe) {
+            // The bribe buys one more action before the turn ends
+            Action extra = co_await decisions.decide(seat);
+            while (extra.type != ActionType::NextTurn) {
+                bool accepted = true;
+                try {
+                    perform(game, extra);
+                } catch (const std::exception&) {
+                    decisions.reject(std::current_exception());
+                    accepted = false;
+                }
+                if (accepted) {
+                    break;
+                }
+                extra = co_await decisions.decide(seat);
+            }
+            if (game.is_game_over()) {
+                continue;
+            }
+        }
+        game.next_turn();
+    }
+}